@@ -0,0 +1,36 @@
+#ifndef BmpHeader_h
+#define BmpHeader_h
+
+#include <stdint.h>
+
+// Bytes to read from the start of a bitmap to get the file header, the
+// largest (V5) info header and a 1bpp palette right behind it in one go
+const uint16_t BMP_HEADER_READ = 14 + 124 + 8;
+
+const uint8_t BMP_OK = 0;
+const uint8_t BMP_NOT_A_BITMAP = 1;
+const uint8_t BMP_UNSUPPORTED = 2;
+
+struct BmpHeader {
+  uint32_t fileSize = 0;
+  uint32_t imageOffset = 0; // start of the pixel array
+  uint32_t headerSize = 0;  // 40 BITMAPINFOHEADER, 108 V4, 124 V5
+  uint32_t width = 0;
+  uint32_t height = 0;
+  bool flip = true; // rows are stored bottom to top
+  uint16_t planes = 0;
+  uint16_t depth = 0;  // bits per pixel
+  uint32_t format = 0; // 0 uncompressed, 3 bitfields (16 bit 565)
+  uint32_t rowSize = 0;       // bytes, padded to 4
+  uint32_t paletteOffset = 0; // 0 without palette
+  uint16_t paletteSize = 0;   // bytes, 4 per entry
+};
+
+// Parses and validates the headers at the start of a bitmap, data holds the
+// first length bytes of the file (BMP_HEADER_READ is always enough).
+// Returns BMP_OK, BMP_NOT_A_BITMAP or BMP_UNSUPPORTED for formats, sizes and
+// offsets that can't be drawn.
+uint8_t parseBmpHeader(const uint8_t* data, uint16_t length,
+                       BmpHeader& header);
+
+#endif
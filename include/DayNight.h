@@ -0,0 +1,22 @@
+#ifndef DayNight_h
+#define DayNight_h
+
+#include <stdint.h>
+
+const uint8_t MAX_DAYLIGHT_INTERVALS = 8;
+
+// Sunrise to sunset intervals in local time, sorted by sunrise. Built once
+// after parsing so every icon asks the same question the same way.
+struct DayNightTable {
+  uint8_t count = 0;
+  uint32_t sunrise[MAX_DAYLIGHT_INTERVALS] = {0};
+  uint32_t sunset[MAX_DAYLIGHT_INTERVALS] = {0};
+};
+
+// sunrise and sunset are UTC as sent by the API, offset converts to local
+void buildDayNightTable(DayNightTable& table, const uint32_t* sunrise,
+                        const uint32_t* sunset, uint8_t days, int32_t offset);
+// t is local time, it is night when t is outside every daylight interval
+bool isNight(const DayNightTable& table, uint32_t t);
+
+#endif
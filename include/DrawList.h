@@ -0,0 +1,70 @@
+#ifndef DrawList_h
+#define DrawList_h
+
+#include <Print.h>
+#include <gfxfont.h>
+#include <stdint.h>
+
+// The weather screen records up to 129 ops, when the temperatures change
+// color as often as they can, see test/test_weather_screen. The other
+// screens take fewer.
+const uint8_t MAX_DRAW_OPS = 144;
+const uint16_t DRAW_TEXT_SIZE = 512;
+
+enum DrawOpType : uint8_t {
+  DRAW_FONT,
+  DRAW_COLOR,
+  DRAW_CURSOR,
+  DRAW_TEXT,
+  DRAW_ICON
+};
+
+// Each op only uses the fields of its type, which share their memory, so an
+// op takes 8 bytes on the ESP32
+struct DrawOp {
+  DrawOpType type;
+  uint8_t icon; // IconAsset of include/IconAtlas.h
+  uint16_t h;   // icon height once drawn, 0 until then
+  union {
+    const GFXfont* font;
+    uint16_t color; // text color
+    struct {        // cursor and icon position
+      int16_t x;
+      int16_t y;
+    };
+    struct {
+      uint16_t text; // offset of the characters in DrawList::text
+      uint16_t length;
+    };
+  };
+};
+
+// A screen recorded as the display calls that draw it, so it can be replayed
+// once per page when GxEPD2 draws the frame in pages with firstPage() and
+// nextPage(). Printed text goes through the same Print code as the display,
+// so replaying gives exactly the pixels drawing directly would have. Fonts
+// are kept by pointer and have to outlive the list, icons by their index.
+// Whatever doesn't fit is dropped and overflow is set. The text color starts
+// at 0 (GxEPD_BLACK) and is only recorded when it changes.
+class DrawList : public Print {
+public:
+  void clear();
+  void setFont(const GFXfont* font);
+  void setTextColor(uint16_t color);
+  void setCursor(int16_t x, int16_t y);
+  void drawIcon(uint8_t icon, int16_t x, int16_t y);
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+  DrawOp ops[MAX_DRAW_OPS];
+  uint8_t count = 0;
+  char text[DRAW_TEXT_SIZE];
+  uint16_t textUsed = 0;
+  uint16_t textColor = 0;
+  bool overflow = false;
+
+private:
+  DrawOp* add(DrawOpType type);
+};
+
+#endif
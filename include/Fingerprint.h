@@ -0,0 +1,18 @@
+#ifndef Fingerprint_h
+#define Fingerprint_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Incremental 32-bit FNV-1a over the values a screen is drawn from, equal
+// fingerprints mean the same values went in the same order
+struct Fingerprint {
+  uint32_t hash = 2166136261u;
+};
+
+void addBytes(Fingerprint& fingerprint, const void* data, size_t length);
+// Includes the terminator so "ab" + "c" differs from "a" + "bc"
+void addString(Fingerprint& fingerprint, const char* text);
+void addInt(Fingerprint& fingerprint, int32_t value);
+
+#endif
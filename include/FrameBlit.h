@@ -0,0 +1,35 @@
+#ifndef FrameBlit_h
+#define FrameBlit_h
+
+#include <stdint.h>
+
+// A 1bpp panel buffer in the GxEPD2_BW layout, or one plane of GxEPD2_3C:
+// width / 8 bytes per row, the MSB is the leftmost pixel and a cleared bit is
+// black (colored). width and height are the unrotated panel size, rotation
+// is the Adafruit_GFX one (0 to 3). The buffer holds the panel rows from top
+// on, rows of them, which is less than height for a page of a paged display.
+struct FrameTarget {
+  uint8_t* buffer;
+  uint16_t width;
+  uint16_t height;
+  uint8_t rotation;
+  uint16_t top;
+  uint16_t rows;
+};
+
+// drawPixel() of GxEPD2_BW: turns the pixel at x, y in rotated coordinates
+// white or black, nothing outside the panel or the rows in the buffer
+void setFramePixel(const FrameTarget& target, int16_t x, int16_t y,
+                   bool white);
+// Draws the set bits of a drawBitmap() style bitmap (rows of (w + 7) / 8
+// bytes) in black at x, y in rotated coordinates, clipped to the panel.
+// Gives exactly the same pixels as drawBitmap(x, y, bits, w, h, GxEPD_BLACK)
+// through setFramePixel(), but works on whole bytes for rotations 0 and 2.
+void blitBitmap(const FrameTarget& target, int16_t x, int16_t y,
+                const uint8_t* bits, uint16_t w, uint16_t h);
+// Same as blitBitmap() but turns the pixels of the set bits white, for the
+// other plane of a three color panel where a pixel is black or colored
+void eraseBitmap(const FrameTarget& target, int16_t x, int16_t y,
+                 const uint8_t* bits, uint16_t w, uint16_t h);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef FrameCodec_h
+#define FrameCodec_h
+
+#include <stdint.h>
+
+// Run length coding of 1bpp GxEPD2 frame buffers, which are mostly white
+// (0xFF) with text and icons whose strokes repeat from row to row. Every
+// byte is XORed with the byte above it, the first row with white, so both
+// turn into runs of zeros. Every run starts with a control byte: 1nnnnnnn is
+// n + 1 zero bytes and 0nnnnnnn is followed by n + 1 literal bytes. Zero
+// runs shorter than FRAME_MIN_ZERO_RUN are kept in literals, where they cost
+// less than ending the literal.
+const uint8_t FRAME_RUN_ZERO = 0x80;
+const uint8_t FRAME_MAX_RUN = 128;
+const uint8_t FRAME_MIN_ZERO_RUN = 3;
+
+// Largest encoding of a length byte frame, all literals
+uint32_t maxEncodedFrameSize(uint32_t length);
+// Encodes a frame of rowBytes wide rows. Returns the encoded size, or 0 when
+// it doesn't fit in capacity bytes.
+uint32_t encodeFrame(const uint8_t* frame, uint32_t length, uint16_t rowBytes,
+                     uint8_t* out, uint32_t capacity);
+// False when the data is corrupt or doesn't decode to exactly length bytes
+bool decodeFrame(const uint8_t* in, uint32_t size, uint8_t* frame,
+                 uint32_t length, uint16_t rowBytes);
+
+#endif
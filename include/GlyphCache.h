@@ -0,0 +1,30 @@
+#ifndef GlyphCache_h
+#define GlyphCache_h
+
+#include <gfxfont.h>
+#include <stdint.h>
+
+const uint8_t GLYPH_CACHE_FONTS = 4;
+const uint8_t GLYPH_CACHE_CHARS = 95; // 0x20 to 0x7E of the 7 bit fonts
+const uint16_t GLYPH_CACHE_SIZE = 4096; // bytes
+
+// Glyphs of GFXfonts unpacked from their continuous bit stream into rows of
+// (width + 7) / 8 bytes, the drawBitmap() layout, so text can be blitted a
+// byte at a time. Glyphs are added on first use and kept until cleared.
+struct GlyphCache {
+  const GFXfont* fonts[GLYPH_CACHE_FONTS] = {};
+  // Offset + 1 of each glyph's rows, 0 when it isn't cached yet
+  uint16_t offsets[GLYPH_CACHE_FONTS][GLYPH_CACHE_CHARS] = {};
+  uint8_t rows[GLYPH_CACHE_SIZE];
+  uint16_t used = 0;                  // bytes
+  uint16_t budget = GLYPH_CACHE_SIZE; // bytes, 0 prints through drawChar()
+  uint32_t hits = 0;
+  uint32_t misses = 0;
+};
+
+// Returns the rows of character c in font, unpacking it on a miss, or
+// nullptr when c has no bitmap or the cache is out of fonts or room
+const uint8_t* glyphRows(GlyphCache& cache, const GFXfont* font, uint8_t c);
+void clearGlyphCache(GlyphCache& cache);
+
+#endif
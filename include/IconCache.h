@@ -0,0 +1,45 @@
+#ifndef IconCache_h
+#define IconCache_h
+
+#include <stdint.h>
+
+const uint8_t ICON_CACHE_SLOTS = 8;
+const uint8_t ICON_CACHE_KEY_LENGTH = 40;
+
+// A decoded 1bpp icon in the drawBitmap() layout, rows of (width + 7) / 8
+// bytes with a set bit for every pixel drawn in black
+struct IconCacheEntry {
+  char key[ICON_CACHE_KEY_LENGTH];
+  uint16_t width = 0;
+  uint16_t height = 0;
+  uint8_t* bits = nullptr;
+  uint32_t size = 0;
+  uint32_t lastUse = 0;
+};
+
+// Least recently used cache of decoded icons. Bitmaps live on the heap and
+// their total size never exceeds budget bytes, entries are evicted to make
+// room and anything bigger than the whole budget is not cached at all.
+struct IconCache {
+  IconCacheEntry entries[ICON_CACHE_SLOTS];
+  uint32_t budget = 0; // bytes, 0 disables the cache
+  uint32_t used = 0;   // bytes
+  uint32_t clock = 0;
+  uint32_t hits = 0;
+  uint32_t misses = 0;
+  uint32_t evictions = 0;
+};
+
+// Returns the cached icon for key and marks it as recently used, or
+// nullptr on a miss
+const IconCacheEntry* findIcon(IconCache& cache, const char* key);
+// Makes room for a width x height icon under key and returns the entry whose
+// bits to decode it into, or nullptr when it can't be cached. Entries are
+// only valid until the next insert.
+IconCacheEntry* insertIcon(IconCache& cache, const char* key, uint16_t width,
+                           uint16_t height);
+// Drops an entry whose decode failed after insertIcon()
+void removeIcon(IconCache& cache, const char* key);
+void clearIconCache(IconCache& cache);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef IconPack_h
+#define IconPack_h
+
+#include <stdint.h>
+
+// Single file icon pack made by tools/pack_icons.py. A header and an index
+// sorted by path hash are followed by the icon payloads, each a drawBitmap()
+// style bitmap (rows of (width + 7) / 8 bytes, set bit = drawn in black)
+// that is either stored as is or PackBits run length encoded. All fields are
+// little-endian.
+const uint32_t ICON_PACK_MAGIC = 0x4B504349; // "ICPK"
+const uint8_t ICON_PACK_VERSION = 1;
+
+const uint8_t ICON_PACK_RAW = 0;
+const uint8_t ICON_PACK_RLE = 1;
+
+struct IconPackHeader {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t reserved;
+  uint16_t count; // index entries
+};
+
+struct IconPackEntry {
+  uint32_t hash; // iconPackHash() of the SPIFFS path, like "/icon50/fog.bmp"
+  uint16_t width;
+  uint16_t height;
+  uint32_t offset; // payload position from the start of the file
+  uint32_t size;   // stored payload bytes
+  uint8_t encoding;
+  uint8_t reserved[3];
+};
+
+static_assert(sizeof(IconPackHeader) == 8, "pack header layout");
+static_assert(sizeof(IconPackEntry) == 20, "pack index layout");
+
+// 32-bit FNV-1a
+uint32_t iconPackHash(const char* path);
+// Binary search of an index sorted by hash, nullptr when it isn't in there
+const IconPackEntry* findPackEntry(const IconPackEntry* index, uint16_t count,
+                                   uint32_t hash);
+// Returns false unless in decodes to exactly outSize bytes
+bool unpackRle(const uint8_t* in, uint32_t inSize, uint8_t* out,
+               uint32_t outSize);
+
+#endif
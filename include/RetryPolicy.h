@@ -0,0 +1,29 @@
+#ifndef RetryPolicy_h
+#define RetryPolicy_h
+
+#include <stdint.h>
+
+// Failure bookkeeping kept in RTC memory so backoff grows across deep sleeps
+struct RetryState {
+  uint16_t consecutiveFailures = 0;
+  uint32_t totalFailures = 0;
+  uint32_t totalAttempts = 0;
+  uint32_t lastBackoff = 0; // seconds
+  uint8_t lastFailStage = 0;
+};
+
+// Backoff doubles from baseDelay with every consecutive failure up to
+// maxDelay (both in seconds). The sleep is then picked uniformly from the
+// upper half of that window so a fleet woken by the same outage spreads out.
+struct RetryPolicy {
+  uint32_t baseDelay;
+  uint32_t maxDelay;
+};
+
+void recordAttempt(RetryState& state);
+void recordSuccess(RetryState& state);
+// Returns the backoff in seconds, randomValue is any 32-bit random number
+uint32_t recordFailure(RetryState& state, const RetryPolicy& policy,
+                       uint8_t failStage, uint32_t randomValue);
+
+#endif
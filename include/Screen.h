@@ -0,0 +1,122 @@
+#ifndef Screen_h
+#define Screen_h
+
+#include <Adafruit_GFX.h>
+#include <DrawList.h>
+#include <FrameBlit.h>
+#include <GlyphCache.h>
+#include <GxEPD2.h>
+#include <IconAtlas.h>
+#include <IconCache.h>
+
+// Draw the weather icons from the flash atlas generated by
+// tools/gen_icon_atlas.py. Build with -D USE_SPIFFS_ICONS to load them from
+// SPIFFS instead, through the icon pack and the icon cache, which only exist
+// in that build. test_spiffs_icons runs it on the host.
+#ifndef USE_SPIFFS_ICONS
+#define USE_ICON_ATLAS
+#endif
+// Blit text from a cache of unpacked glyph rows instead of plotting it with
+// drawChar(). The cache takes GLYPH_CACHE_SIZE and its index, about 4.9 KB of
+// static RAM. BENCHMARK_TEXT in main.cpp times both, test_glyph_cache checks
+// the frames against drawChar() ones on the host. Uncomment or build with
+// -D USE_GLYPH_CACHE.
+// #define USE_GLYPH_CACHE
+
+// Three color panels draw alerts, extreme temperatures and the colored
+// pixels of bitmaps in their red or yellow, black and white panels in black
+const uint16_t ACCENT_COLOR = GxEPD_RED;
+
+#ifndef USE_ICON_ATLAS
+// Heap budget for decoded icons loaded from SPIFFS, a forecast usually repeats
+// the same few icons so each file is only decoded once per render
+const uint32_t ICON_CACHE_BUDGET = 8 * 1024; // bytes, 0 disables the cache
+// All icons in one file written by tools/pack_icons.py before the build,
+// opened on the first icon drawn from SPIFFS and decoded into the icon cache.
+// Without it every icon is read from its own BMP.
+const char* const ICON_PACK_PATH = "/icons.pack";
+#endif
+
+// The frame the screen is drawn into, in the layout of GxEPD2_BW or of the
+// two planes of GxEPD2_3C and with their pixel rules, so bitmaps can be
+// blitted into it a byte at a time instead of going through drawPixel() for
+// each pixel. The planes belong to whoever calls begin(): main.cpp sizes
+// them for its GxEPD2 panel and sends them with the driver's writeImage(),
+// the host tests keep them in memory. With pages they hold pageHeight panel
+// rows from top on.
+class FrameCanvas : public Adafruit_GFX {
+public:
+  FrameCanvas() : Adafruit_GFX(0, 0) {}
+
+  // width and height are the unrotated panel size, each plane holds
+  // pageHeight rows of width / 8 bytes. color is nullptr on black and white
+  // panels.
+  void begin(uint16_t width, uint16_t height, uint16_t pageHeight,
+             uint8_t* black, uint8_t* color);
+  // The black plane, or the color one of a three color panel
+  FrameTarget target(bool colorPlane) const;
+  // GxEPD2_BW draws every color but black in white, with GxEPD2_3C a pixel
+  // is black, colored or white
+  void drawPixel(int16_t x, int16_t y, uint16_t c) override;
+  void fillScreen(uint16_t c) override;
+  uint32_t planeSize() const { return (uint32_t)WIDTH / 8 * pageHeight; }
+
+  uint8_t* black = nullptr;
+  uint8_t* color = nullptr;
+  uint16_t pageHeight = 0;
+  uint16_t top = 0; // always 0 with a full frame buffer
+
+private:
+  bool isColored(uint16_t c) const {
+    return color != nullptr && (c == GxEPD_RED || c == GxEPD_YELLOW);
+  }
+};
+
+extern FrameCanvas canvas;
+// Everything on the screen, replayed for each page of the canvas
+extern DrawList screen;
+#ifdef USE_GLYPH_CACHE
+extern GlyphCache glyphCache;
+#endif
+#ifndef USE_ICON_ATLAS
+extern IconCache iconCache;
+#endif
+
+// The FreeMono fonts of the screens. Their headers define the fonts in every
+// file that includes them, so only src/Screen.cpp does and everything else
+// uses these. The font metrics and the glyph cache know fonts by address.
+extern const GFXfont* const FONT_9PT;
+extern const GFXfont* const FONT_12PT;
+extern const GFXfont* const FONT_18PT;
+extern const GFXfont* const FONT_24PT;
+
+// Records the font and selects it on the canvas, which text is measured with
+void setFont(const GFXfont* font);
+// Text size of the canvas font, from the generated font metrics when they
+// cover the text and else from getTextBounds()
+uint16_t getWidthOfText(const char* text);
+uint16_t getHeightOfText(const char* text);
+
+// The color drawn for color on this panel, black and white panels draw
+// everything that isn't white in black
+uint16_t panelColor(uint16_t color);
+// Same as canvas.drawBitmap(x, y, bits, w, h, color) for black or the
+// panel's color
+void drawBits(int16_t x, int16_t y, const uint8_t* bits, uint16_t w,
+              uint16_t h, uint16_t color = GxEPD_BLACK);
+// Draws a BMP from SPIFFS at x, y, colored pixels in the panel's color when
+// with_color is set
+void drawBitmapFromSpiffs(const char* filename, int16_t x, int16_t y,
+                          bool with_color);
+void drawBitmapFromSpiffs(const char* filename, int16_t x, int16_t y);
+// Draws an icon, from the flash atlas when it is built in.
+// Returns the height drawn, 0 when it was read straight from SPIFFS.
+uint16_t drawIcon(IconAsset asset, int16_t x, int16_t y);
+// Same as canvas.write() of the characters. With USE_GLYPH_CACHE glyphs come
+// from the glyph cache and are blitted a row at a time instead of drawChar()
+// plotting them pixel by pixel.
+void drawText(const uint8_t* text, uint16_t length);
+// Draws the recorded screen into the current page on a white background
+void replayScreen();
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef ScreenGrab_h
+#define ScreenGrab_h
+
+#include <stdint.h>
+
+// Frame sent over the serial port in reply to a SCREEN_GRAB_COMMAND line and
+// read by tools/screen_grab.py. The header is followed by each plane, the
+// black one and then the color one of three color panels, as a
+// ScreenGrabPlane and size bytes coded with encodeFrame(). A plane is rows
+// of width / 8 bytes of the unrotated panel where a cleared bit is black
+// (colored). All fields are little-endian. Version 1 grabs only had the
+// black plane, with its size and hash in the header.
+const char* const SCREEN_GRAB_COMMAND = "grab";
+const uint32_t SCREEN_GRAB_MAGIC = 0x42475045; // "EPGB"
+const uint8_t SCREEN_GRAB_VERSION = 2;
+
+struct ScreenGrabHeader {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t rotation; // display.getRotation()
+  uint16_t width;
+  uint16_t height;
+  uint8_t planes;
+  uint8_t reserved;
+};
+
+struct ScreenGrabPlane {
+  uint32_t size; // encoded bytes
+  uint32_t hash; // 32-bit FNV-1a of the decoded plane
+};
+
+static_assert(sizeof(ScreenGrabHeader) == 12, "screen grab header layout");
+static_assert(sizeof(ScreenGrabPlane) == 8, "screen grab plane layout");
+
+#endif
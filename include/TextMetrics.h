@@ -0,0 +1,117 @@
+#ifndef TextMetrics_h
+#define TextMetrics_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Glyph metrics of a GFXfont kept out of PROGMEM as constexpr tables, made by
+// tools/gen_font_metrics.py into FontMetrics.h
+struct GlyphMetrics {
+  uint8_t width;
+  uint8_t height;
+  uint8_t xAdvance;
+  int8_t xOffset;
+  int8_t yOffset;
+};
+
+struct FontMetrics {
+  uint8_t first;
+  uint8_t last;
+  uint8_t yAdvance;
+  // Nonzero when every glyph has this xAdvance and stays inside its cell,
+  // then a run's width only depends on its length and end glyphs
+  uint8_t advance;
+  const GlyphMetrics* glyphs;
+};
+
+// Same bounds as Adafruit_GFX::getTextBounds() at text size 1 for a single
+// line that doesn't wrap, characters outside the font are skipped like it
+// does. Everything is constexpr so constant strings are measured at compile
+// time.
+
+constexpr bool inFont(const FontMetrics& font, char c) {
+  return static_cast<uint8_t>(c) >= font.first &&
+         static_cast<uint8_t>(c) <= font.last;
+}
+
+constexpr const GlyphMetrics& glyphOf(const FontMetrics& font, char c) {
+  return font.glyphs[static_cast<uint8_t>(c) - font.first];
+}
+
+constexpr int16_t minOf(int16_t a, int16_t b) { return a < b ? a : b; }
+constexpr int16_t maxOf(int16_t a, int16_t b) { return a > b ? a : b; }
+
+constexpr size_t textLength(const char* text, size_t length = 0) {
+  return text[length] == '\0' ? length : textLength(text, length + 1);
+}
+
+constexpr bool allInFont(const FontMetrics& font, const char* text) {
+  return *text == '\0' ||
+         (inFont(font, *text) && allInFont(font, text + 1));
+}
+
+// Leftmost and rightmost pixel columns of the glyph boxes with the cursor at
+// x, INT16_MAX and -1 when nothing is drawn
+constexpr int16_t textLeft(const FontMetrics& font, const char* text,
+                           int16_t x = 0, int16_t left = INT16_MAX) {
+  return *text == '\0' ? left
+         : !inFont(font, *text)
+             ? textLeft(font, text + 1, x, left)
+             : textLeft(font, text + 1, x + glyphOf(font, *text).xAdvance,
+                        minOf(left, x + glyphOf(font, *text).xOffset));
+}
+
+constexpr int16_t textRight(const FontMetrics& font, const char* text,
+                            int16_t x = 0, int16_t right = -1) {
+  return *text == '\0' ? right
+         : !inFont(font, *text)
+             ? textRight(font, text + 1, x, right)
+             : textRight(font, text + 1, x + glyphOf(font, *text).xAdvance,
+                         maxOf(right, x + glyphOf(font, *text).xOffset +
+                                          glyphOf(font, *text).width - 1));
+}
+
+constexpr int16_t textTop(const FontMetrics& font, const char* text,
+                          int16_t top = INT16_MAX) {
+  return *text == '\0' ? top
+         : !inFont(font, *text)
+             ? textTop(font, text + 1, top)
+             : textTop(font, text + 1,
+                       minOf(top, glyphOf(font, *text).yOffset));
+}
+
+constexpr int16_t textBottom(const FontMetrics& font, const char* text,
+                             int16_t bottom = -1) {
+  return *text == '\0' ? bottom
+         : !inFont(font, *text)
+             ? textBottom(font, text + 1, bottom)
+             : textBottom(font, text + 1,
+                          maxOf(bottom, glyphOf(font, *text).yOffset +
+                                            glyphOf(font, *text).height - 1));
+}
+
+constexpr uint16_t extent(int16_t low, int16_t high) {
+  return high >= low ? high - low + 1 : 0;
+}
+
+// A run of n glyphs in a monospaced font starts at the first glyph's offset
+// and ends with the last glyph, which no earlier glyph reaches past
+constexpr int16_t monospacedWidth(const FontMetrics& font, const char* text,
+                                  size_t length) {
+  return static_cast<int16_t>(length - 1) * font.advance +
+         glyphOf(font, text[length - 1]).xOffset +
+         glyphOf(font, text[length - 1]).width - glyphOf(font, *text).xOffset;
+}
+
+constexpr uint16_t textWidth(const FontMetrics& font, const char* text) {
+  return *text == '\0' ? 0
+         : font.advance != 0 && allInFont(font, text)
+             ? maxOf(monospacedWidth(font, text, textLength(text)), 0)
+             : extent(textLeft(font, text), textRight(font, text));
+}
+
+constexpr uint16_t textHeight(const FontMetrics& font, const char* text) {
+  return extent(textTop(font, text), textBottom(font, text));
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef TileDiff_h
+#define TileDiff_h
+
+#include <stdint.h>
+
+// The frame buffer is split into TILE_WIDTH x TILE_HEIGHT tiles of the
+// unrotated panel, TILE_WIDTH is a multiple of 8 so tiles line up with the
+// controller's byte addressing
+const uint16_t TILE_WIDTH = 40;  // pixels
+const uint16_t TILE_HEIGHT = 30; // pixels
+const uint16_t MAX_TILES = 128;
+const uint8_t MAX_REFRESH_RECTS = 4;
+
+// Hashes of the last frame shown, kept in RTC memory between wakes
+struct TileState {
+  bool valid = false;
+  uint8_t columns = 0;
+  uint8_t rows = 0;
+  uint8_t partialRefreshes = 0; // since the last full refresh
+  uint32_t hashes[MAX_TILES];
+};
+
+// Tiles of a panel, diffTiles() only compares panels of up to MAX_TILES
+constexpr uint16_t tileCount(uint16_t width, uint16_t height) {
+  return (uint16_t)((width + TILE_WIDTH - 1) / TILE_WIDTH) *
+         ((height + TILE_HEIGHT - 1) / TILE_HEIGHT);
+}
+
+struct TileRect {
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+};
+
+// Hashes every tile of a GxEPD2 layout frame buffer of the unrotated panel
+// size and compares them with the last frame in state, which is then
+// replaced. The changed tiles are merged into at most MAX_REFRESH_RECTS
+// rectangles in panel coordinates, the count is returned and area is set to
+// the pixels they cover, counting overlaps once. Without a valid last frame
+// the whole panel changed, and so it does on panels of more than MAX_TILES
+// tiles, which are never compared.
+uint8_t diffTiles(TileState& state, const uint8_t* buffer, uint16_t width,
+                  uint16_t height, TileRect* rects, uint32_t& area);
+
+#endif
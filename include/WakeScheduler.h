@@ -0,0 +1,28 @@
+#ifndef WakeScheduler_h
+#define WakeScheduler_h
+
+#include <stdint.h>
+
+// Wake bookkeeping kept in RTC memory. The RTC slow clock drifts, so every
+// timer wake compares when it actually woke with when it was meant to and
+// folds the error into driftPpm, which shortens or stretches the next sleep.
+struct WakeState {
+  uint32_t sleepStart = 0;   // UTC seconds, when the last sleep was computed
+  uint32_t expectedWake = 0; // UTC seconds, 0 if the last sleep wasn't aligned
+  int32_t driftPpm = 0;      // positive if the RTC wakes late
+  uint32_t bootLatency = 0;  // ms from wake until the display is refreshed
+};
+
+// Fold the error of this wake into the drift estimate, actualWake is the UTC
+// time the chip woke up
+void recordWake(WakeState& state, uint32_t actualWake);
+// Smooth in the time it took from wake to a refreshed display
+void recordBootLatency(WakeState& state, uint32_t latency);
+// Returns the sleep in microseconds that refreshes the display on the next
+// interval boundary (in local time) at least minSleep seconds from now
+uint64_t nextSleep(WakeState& state, uint32_t now, int32_t tzOffset,
+                   uint32_t interval, uint32_t minSleep);
+// Forget the expected wake, for sleeps that aren't aligned (e.g. backoff)
+void skipAlignment(WakeState& state);
+
+#endif
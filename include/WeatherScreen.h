@@ -0,0 +1,72 @@
+#ifndef WeatherScreen_h
+#define WeatherScreen_h
+
+#include <IconAtlas.h>
+#include <stdint.h>
+
+const uint8_t BATTERY_DISCHARGING = 0;
+const uint8_t BATTERY_CHARGING = 1;
+const uint8_t BATTERY_LOW = 2;
+
+// Temperatures outside of FREEZING_TEMP to HOT_TEMP, weather alerts and
+// BATTERY_LOW are drawn in ACCENT_COLOR of include/Screen.h
+const float FREEZING_TEMP = 0; // degrees Celsius
+const float HOT_TEMP = 32;     // degrees Celsius
+
+// Columns of the hourly and daily forecast, MAX_HOURS and MAX_DAYS - 1 of
+// lib/OpenWeather/User_Setup.h. Today is on top, the days start tomorrow.
+const uint8_t WEATHER_HOURS = 5;
+const uint8_t WEATHER_DAYS = 5;
+
+extern const char* daysOfTheWeek[8];
+
+struct WeatherHour {
+  uint8_t hour; // local time
+  uint8_t minute;
+  float temp;
+  IconAsset icon;
+};
+
+struct WeatherDay {
+  uint8_t weekday; // 1 is Sunday, like weekday() of TimeLib
+  float tempMin;
+  float tempMax;
+  IconAsset icon;
+};
+
+// Everything the weather screen shows, filled from the OW_* structures by
+// main.cpp and from fixtures by the host renderer in test/test_weather_screen.
+// Icons are of the 100 pixel set and already picked for day or night.
+struct WeatherView {
+  const char* name;
+  const char* state;
+  const char* country;
+  bool imperial;
+  const char* main; // current conditions, like "Clouds"
+  IconAsset icon;
+  float temp;
+  float tempMin; // today
+  float tempMax;
+  uint8_t humidity;  // %
+  uint8_t battery;   // BATTERY_DISCHARGING, BATTERY_CHARGING or BATTERY_LOW
+  const char* alert; // event of the weather alert, "" without one
+  WeatherHour hours[WEATHER_HOURS];
+  WeatherDay days[WEATHER_DAYS];
+};
+
+// The icon of the 100 pixel set for a weather condition id, the one of the
+// 50 pixel set is ICON_FOLDER_SIZE further on
+IconAsset getMeteoconIcon(uint16_t id, bool nightVersion = false);
+// ACCENT_COLOR for temperatures at or past FREEZING_TEMP or HOT_TEMP
+uint16_t temperatureColor(float t, bool imperial);
+// Prints a temperature and its unit at x, y and returns the width taken
+uint16_t printTemperature(float t, bool imperial, uint16_t x, uint16_t y);
+// Hashes everything drawWeather() draws, rounded and formatted the same way
+// it is printed, so an unchanged fingerprint means an identical frame.
+// Anything added to the screen has to be added here too.
+uint32_t weatherFingerprint(const WeatherView& view);
+// Records the weather screen into screen of include/Screen.h, which
+// replayScreen() draws
+void drawWeather(const WeatherView& view);
+
+#endif
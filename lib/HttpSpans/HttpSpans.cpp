@@ -0,0 +1,46 @@
+#include "HttpSpans.h"
+
+#include <string.h>
+
+static void endLine(HttpReader& reader, const char* line, size_t length,
+                    const HttpSink& sink) {
+  if (length > 0 && line[length - 1] == '\r') {
+    length--;
+  }
+  // The empty line ends the header
+  if (length == 0) {
+    reader.headerEnd = true;
+    return;
+  }
+  sink.headerLine(sink.context, line, length);
+}
+
+bool feedSpan(HttpReader& reader, const uint8_t* data, size_t length,
+              const HttpSink& sink) {
+  size_t i = 0;
+  while (!reader.headerEnd && i < length) {
+    const uint8_t* end =
+        static_cast<const uint8_t*>(memchr(data + i, '\n', length - i));
+    const size_t run = (end != nullptr ? end - data : length) - i;
+    if (end != nullptr && reader.lineLength == 0) {
+      endLine(reader, reinterpret_cast<const char*>(data + i), run, sink);
+    } else {
+      // The line started in an earlier span or goes on in the next one
+      const size_t room = HTTP_LINE_SIZE - reader.lineLength;
+      const size_t kept = run < room ? run : room;
+      memcpy(reader.line + reader.lineLength, data + i, kept);
+      reader.lineLength += kept;
+      reader.copied += kept;
+      if (end == nullptr) {
+        return false;
+      }
+      endLine(reader, reader.line, reader.lineLength, sink);
+      reader.lineLength = 0;
+    }
+    i += run + 1;
+  }
+  if (reader.headerEnd && i < length) {
+    sink.body(sink.context, data + i, length - i);
+  }
+  return reader.headerEnd;
+}
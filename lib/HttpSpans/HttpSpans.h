@@ -0,0 +1,33 @@
+#ifndef HttpSpans_h
+#define HttpSpans_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+const uint8_t HTTP_LINE_SIZE = 96; // longer split header lines are cut
+
+// Where feedSpan() hands the response to. Lines come without their line end
+// and, like body bytes, point into the span they arrived in unless they were
+// split across spans.
+struct HttpSink {
+  void (*headerLine)(void* context, const char* line, size_t length);
+  void (*body)(void* context, const uint8_t* data, size_t length);
+  void* context;
+};
+
+// Splits an HTTP response that arrives in spans of any size, e.g. one client
+// read or one received segment each, into header lines and body runs. Only a
+// header line split across two spans is copied, into line, to put it back
+// together; the body is never copied.
+struct HttpReader {
+  bool headerEnd = false;
+  uint8_t lineLength = 0;
+  char line[HTTP_LINE_SIZE];
+  uint32_t copied = 0; // bytes copied into line
+};
+
+// Feeds the next span of the response, returns whether the header has ended
+bool feedSpan(HttpReader& reader, const uint8_t* data, size_t length,
+              const HttpSink& sink);
+
+#endif
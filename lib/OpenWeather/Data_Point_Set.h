@@ -41,6 +41,11 @@ typedef struct OW_current {
     String description;
     String icon;
 
+    // alerts, only the first one is kept, event is "" when there is none
+    String alert_event;
+    uint32_t alert_start = 0;
+    uint32_t alert_end = 0;
+
 } OW_current;
 
 /***************************************************************************************
@@ -33,27 +33,43 @@
 ***************************************************************************************/
 // The structures etc are created by the sketch and passed to this function.
 // Pass a nullptr for current, hourly or daily pointers to exclude in response.
+// Alerts are only requested with current and alerts set, which the sketch
+// leaves out of fetches that skip the forecast to save the download.
 // ESP8266: Setting secure to false will invoke an insecure connection with AXTLS
 //          for the connection, when set true BearSSL will be used.
-// ESP32:   Secure parameter has no affect.
+// ESP32:   Setting secure to false will use a plain WiFiClient (http), this is
+//          intended for a local mock server selected with setServer().
 bool OW_Weather::getForecast(OW_current *current, OW_hourly *hourly, OW_daily *daily,
                              String api_key, String latitude, String longitude,
-                             String units, String language, bool secure) {
+                             String units, String language, bool secure,
+                             bool alerts) {
 
   data_set = "";
   hourly_index = 0;
   daily_index = 0;
   Secure = secure;
   oneCall = true;
+  openMeteo = false;
+  providerHost = "api.openweathermap.org";
 
   // Local copies of structure pointers, the structures are filled during parsing
   this->current  = current;
   this->hourly   = hourly;
   this->daily    = daily;
+  this->alerts   = current && alerts;
 
-  // Exclude some info by passing fn a NULL pointer to reduce memory needed
-  String exclude = ",alerts";
+  // The alerts block is only sent while there are alerts, so clear the last one
+  if (this->alerts) {
+    current->alert_event = "";
+    current->alert_start = 0;
+    current->alert_end = 0;
+  }
+
+  // Exclude some info by passing fn a NULL pointer to reduce memory needed,
+  // alerts are stored in the current structure
+  String exclude = "";
   if (!current)  exclude += ",current";
+  if (!this->alerts) exclude += ",alerts";
   if (!hourly)   exclude += ",hourly";
   if (!daily)    exclude += ",daily";
 
@@ -83,6 +99,8 @@ bool OW_Weather::getForecast(OW_forecast *forecast, String api_key,
   forecast_index = 0;
   Secure = secure;
   oneCall = false;
+  openMeteo = false;
+  providerHost = "api.openweathermap.org";
 
   // Local copies of structure pointers, the structures are filled during parsing
   this->forecast  = forecast;
@@ -98,6 +116,54 @@ bool OW_Weather::getForecast(OW_forecast *forecast, String api_key,
 
   return result;
 }
+/***************************************************************************************
+** Function name:           getOpenMeteoForecast
+** Description:             Setup the weather forecast request to Open-Meteo
+***************************************************************************************/
+// Open-Meteo lets the query select each field, so only the values the sketch
+// displays are requested and the response is a fraction of the onecall body.
+// The values are stored in the same OW_current, OW_hourly and OW_daily
+// structures, with the WMO weather codes translated to OpenWeather condition
+// ids. Pass a nullptr for current, hourly or daily pointers to exclude them.
+bool OW_Weather::getOpenMeteoForecast(OW_current *current, OW_hourly *hourly, OW_daily *daily,
+                                      String latitude, String longitude,
+                                      String units, bool secure) {
+
+  data_set = "";
+  Secure = secure;
+  oneCall = false;
+  openMeteo = true;
+  providerHost = "api.open-meteo.com";
+
+  // Local copies of structure pointers, the structures are filled during parsing
+  this->current  = current;
+  this->hourly   = hourly;
+  this->daily    = daily;
+
+  // Open-Meteo has no weather alerts
+  if (current) {
+    current->alert_event = "";
+    current->alert_start = 0;
+    current->alert_end = 0;
+  }
+
+  String url = "https://api.open-meteo.com/v1/forecast?latitude=" + latitude + "&longitude=" + longitude + "&timeformat=unixtime&timezone=auto";
+  if (current) url += "&current=temperature_2m,relative_humidity_2m,weather_code";
+  if (hourly)  url += "&hourly=temperature_2m,weather_code&forecast_hours=" + String(MAX_HOURS);
+  if (daily)   url += "&daily=weather_code,temperature_2m_max,temperature_2m_min,sunrise,sunset&forecast_days=" + String(MAX_DAYS);
+  if (units == "imperial") url += "&temperature_unit=fahrenheit&wind_speed_unit=mph";
+
+  // Send GET request and feed the parser
+  bool result = parseRequest(url);
+
+  // Null out pointers to prevent crashes
+  this->current  = nullptr;
+  this->hourly   = nullptr;
+  this->daily    = nullptr;
+
+  return result;
+}
+
 /***************************************************************************************
 ** Function name:           partialDataSet
 ** Description:             Set requested data set to partial (true) or full (false)
@@ -107,7 +173,103 @@ void OW_Weather::partialDataSet(bool partialSet) {
   this->partialSet = partialSet;
 }
 
-#ifdef ESP32 // Decide if ESP32 or ESP8266 parseRequest available
+/***************************************************************************************
+** Function name:           setServer
+** Description:             Redirect requests to another host, e.g. a local mock server
+***************************************************************************************/
+// A port of 0 selects the default port for the connection type (80 or 443)
+void OW_Weather::setServer(String host, uint16_t port) {
+
+  serverHost = host;
+  serverPort = port;
+}
+
+/***************************************************************************************
+** Function name:           setClient
+** Description:             Send requests over the given connection (ESP32 and host)
+***************************************************************************************/
+// The client is connected and stopped by each request as the own WiFiClient
+// would be, nullptr goes back to a new WiFiClient per request
+void OW_Weather::setClient(Client *client) {
+
+  requestClient = client;
+}
+
+/***************************************************************************************
+** Function name:           setTimeouts
+** Description:             Set the deadline budget of each parseRequest() stage in ms
+***************************************************************************************/
+void OW_Weather::setTimeouts(uint32_t connectTimeout, uint32_t headerTimeout,
+                             uint32_t bodyTimeout, uint32_t stallTimeout) {
+
+  this->connectTimeout = connectTimeout;
+  this->headerTimeout  = headerTimeout;
+  this->bodyTimeout    = bodyTimeout;
+  this->stallTimeout   = stallTimeout;
+}
+
+/***************************************************************************************
+** Function name:           parseHttpDate
+** Description:             Convert an HTTP Date header value to UTC unix time, 0 if invalid
+***************************************************************************************/
+// Format is fixed by RFC 7231, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+static uint32_t parseHttpDate(const char *date) {
+
+  static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  int day, year, hour, minute, second;
+  char mon[4] = "";
+  if (sscanf(date, "%*3s, %d %3s %d %d:%d:%d", &day, mon, &year, &hour, &minute, &second) != 6) return 0;
+  const char *m = strstr(months, mon);
+  if (!m || strlen(mon) != 3 || year < 1970) return 0;
+  int month = (m - months) / 3 + 1;
+
+  // Days since 1970-01-01 of a civil date, see http://howardhinnant.github.io/date_algorithms.html
+  year -= month <= 2;
+  int era = year / 400;
+  uint32_t yoe = year - era * 400;
+  uint32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  uint32_t days = era * 146097 + doe - 719468;
+
+  return days * 86400UL + hour * 3600UL + minute * 60UL + second;
+}
+
+/***************************************************************************************
+** Function name:           checkDateHeader
+** Description:             Keep the server time if the header line is the Date header
+***************************************************************************************/
+void OW_Weather::checkDateHeader(const char *line, size_t length) {
+
+  // Lines come without a terminator, the date is copied out to scan it
+  char date[40];
+  if (length < 6 || length - 6 >= sizeof(date)) return;
+  if (strncmp(line, "Date: ", 6) && strncmp(line, "date: ", 6)) return;
+  memcpy(date, line + 6, length - 6);
+  date[length - 6] = '\0';
+  serverTime = parseHttpDate(date);
+  serverTimeMillis = millis();
+}
+
+void OW_Weather::checkDateHeader(const String &line) {
+
+  checkDateHeader(line.c_str(), line.length());
+}
+
+/***************************************************************************************
+** Function name:           sampleHeap
+** Description:             Track the peak heap use since heapStart was taken
+***************************************************************************************/
+void OW_Weather::sampleHeap() {
+
+#if defined(ESP32) || defined(ESP8266)
+  uint32_t freeHeap = ESP.getFreeHeap();
+  if (heapStart > freeHeap && heapStart - freeHeap > heapUsed) heapUsed = heapStart - freeHeap;
+#endif
+}
+
+// Decide if ESP32 or ESP8266 parseRequest available, the host builds the ESP32
+// one for the native tests
+#if !defined(ESP8266) && !defined(ARDUINO_ARCH_MBED) && !defined(ARDUINO_ARCH_RP2040)
 
 /***************************************************************************************
 ** Function name:           parseRequest (for ESP32)
@@ -116,74 +278,150 @@ void OW_Weather::partialDataSet(bool partialSet) {
 bool OW_Weather::parseRequest(String url) {
 
   uint32_t dt = millis();
+  failStage = OW_FAIL_NONE;
+  bytesReceived = 0;
+  timeToFirstByte = 0;
+  fetchTime = 0;
+  heapUsed = 0;
+  heapStart = ESP.getFreeHeap();
+  serverTime = 0;
+
+  const char*  host = serverHost.length() ? serverHost.c_str() : providerHost;
+
+  if (requestClient)
+  {
+    port = serverPort ? serverPort : (Secure ? 443 : 80);
+
+    if (!requestClient->connect(host, port))
+    {
+      OW_STATUS_PRINTF("Connection failed.\n");
+      failStage = OW_FAIL_CONNECT;
+      return false;
+    }
+
+    return streamResponse(*requestClient, url, dt);
+  }
+
+  if (!Secure)
+  {
+    OW_STATUS_PRINTF("\n\nThe connection to server is INSECURE (http).\n");
+    WiFiClient client;
+    port = serverPort ? serverPort : 80;
+
+    if (!client.connect(host, port, connectTimeout))
+    {
+      OW_STATUS_PRINTF("Connection failed.\n");
+      failStage = OW_FAIL_CONNECT;
+      return false;
+    }
+
+    return streamResponse(client, url, dt);
+  }
 
   OW_STATUS_PRINTF("\n\nThe connection to server is secure (https). Certificate not checked.\n");
   WiFiClientSecure client;
   client.setInsecure(); // Certificate not checked
 
-  const char*  host = "api.openweathermap.org";
-  port = 443;
+  port = serverPort ? serverPort : 443;
 
-  if (!client.connect(host, port))
+  if (!client.connect(host, port, connectTimeout))
   {
     OW_STATUS_PRINTF("Connection failed.\n");
+    failStage = OW_FAIL_CONNECT;
     return false;
   }
 
+  return streamResponse(client, url, dt);
+}
+
+/***************************************************************************************
+** Function name:           streamResponse (for ESP32)
+** Description:             Sends the GET request on an open connection, feeds the parser
+***************************************************************************************/
+bool OW_Weather::streamResponse(Client &client, const String &url, uint32_t dt) {
+
+  const char*  host = serverHost.length() ? serverHost.c_str() : providerHost;
+
+  sampleHeap(); // Handshake done, TLS record buffers are allocated
+
   JSON_Decoder parser;
   parser.setListener(this);
 
-  uint32_t timeout = millis();
-  char c = 0;
+  // The response is read in spans, each span is one call into the client
+  // (and TLS layer) instead of one call per byte. feedSpan() walks every span
+  // in place, the read into buffer is the only copy of body bytes.
+  uint8_t  buffer[OW_READ_BUFFER];
   parseOK = false;
+  bytesCopied = 0;
 
+  struct Target { OW_Weather *ow; JSON_Decoder *parser; } target = { this, &parser };
+  const HttpSink sink = {
+    [](void *context, const char *line, size_t length) {
+#ifdef SHOW_HEADER
+      Serial.write(line, length); Serial.println();
+#endif
+      static_cast<Target*>(context)->ow->checkDateHeader(line, length);
+    },
+    [](void *context, const uint8_t *data, size_t length) {
+      JSON_Decoder *parser = static_cast<Target*>(context)->parser;
+      for (size_t i = 0; i < length; i++)
+      {
+        parser->parse(data[i]);
 #ifdef SHOW_JSON
-  int ccount = 0;
+        char c = data[i];
+        if (c == '{' || c == '[' || c == '}' || c == ']') Serial.println();
+        Serial.print(c);
 #endif
+      }
+    },
+    &target
+  };
+  HttpReader reader;
+
   // Send GET request
   Serial.println();
   OW_STATUS_PRINT("Sending GET request to "); OW_STATUS_PRINT(host); OW_STATUS_PRINT(" port "); OW_STATUS_PRINT(port); OW_STATUS_PRINTF("\n");
   client.print(String("GET ") + url + " HTTP/1.1\r\n" + "Host: " + host + "\r\n" + "Connection: close\r\n\r\n");
 
   // Pull out any header, X-Forecast-API-Calls: reports current daily API call count
-  while (client.connected())
+  // The span holding the end of the header also holds the start of the body
+  uint32_t stageStart = millis();
+  uint32_t lastByte = stageStart;
+  bool headerEnd = false;
+  while (client.available() > 0 || client.connected())
   {
-    String line = client.readStringUntil('\n');
-    if (line == "\r") {
-      OW_STATUS_PRINTF("Header end found\n");
-      break;
+    sampleHeap();
+    int available;
+    while ((available = client.available()) > 0)
+    {
+      int count = client.read(buffer, available < (int)sizeof(buffer) ? available : sizeof(buffer));
+      if (count <= 0) break;
+      if (bytesReceived == 0) timeToFirstByte = millis() - dt;
+      bytesReceived += count;
+      lastByte = millis();
+
+      if (feedSpan(reader, buffer, count, sink) && !headerEnd)
+      {
+        OW_STATUS_PRINTF("Header end found\n");
+        OW_STATUS_PRINTF("\nParsing JSON\n");
+        headerEnd = true;
+        stageStart = millis();
+      }
     }
 
-#ifdef SHOW_HEADER
-    Serial.println(line);
-#endif
-
-    if ((millis() - timeout) > 5000UL)
+    if ((millis() - lastByte) > stallTimeout)
     {
-      OW_STATUS_PRINTF ("HTTP header timeout\n");
+      OW_STATUS_PRINTF(headerEnd ? "Client stalled during JSON parse\n" : "HTTP header stalled\n");
+      failStage = OW_FAIL_STALL;
+      parser.reset();
       client.stop();
       return false;
     }
-  }
 
-  OW_STATUS_PRINTF("\nParsing JSON\n");
-
-  // Parse the JSON data, available() includes yields
-  while ( client.available() > 0 || client.connected())
-  {
-    while(client.available() > 0)
+    if ((millis() - stageStart) > (headerEnd ? bodyTimeout : headerTimeout))
     {
-      c = client.read();
-      parser.parse(c);
-#ifdef SHOW_JSON
-      if (c == '{' || c == '[' || c == '}' || c == ']') Serial.println();
-      Serial.println(c); if (ccount++ > 100 && c == ',') {ccount = 0; Serial.println();}
-#endif
-    }
-
-    if ((millis() - timeout) > 8000UL)
-    {
-      OW_STATUS_PRINTF("Client timeout during JSON parse\n");
+      OW_STATUS_PRINTF(headerEnd ? "Client timeout during JSON parse\n" : "HTTP header timeout\n");
+      failStage = headerEnd ? OW_FAIL_BODY : OW_FAIL_HEADER;
       parser.reset();
       client.stop();
       return false;
@@ -191,12 +429,29 @@ bool OW_Weather::parseRequest(String url) {
     yield();
   }
 
-  OW_STATUS_PRINTF("\nDone in "); OW_STATUS_PRINT(millis()-dt); OW_STATUS_PRINTF(" ms\n");
+  if (!headerEnd)
+  {
+    OW_STATUS_PRINTF ("Connection closed before header end\n");
+    failStage = OW_FAIL_HEADER;
+    parser.reset();
+    client.stop();
+    return false;
+  }
+
+  fetchTime = millis() - dt;
+  bytesCopied = bytesReceived + reader.copied;
+  OW_STATUS_PRINTF("\nDone in "); OW_STATUS_PRINT(fetchTime); OW_STATUS_PRINTF(" ms, ");
+  OW_STATUS_PRINT(bytesReceived); OW_STATUS_PRINTF(" bytes, "); OW_STATUS_PRINT(bytesCopied);
+  OW_STATUS_PRINTF(" copied, first byte after ");
+  OW_STATUS_PRINT(timeToFirstByte); OW_STATUS_PRINTF(" ms, peak heap use ");
+  OW_STATUS_PRINT(heapUsed); OW_STATUS_PRINTF(" bytes\n");
   Serial.println();
 
   parser.reset();
 
   client.stop();
+
+  if (!parseOK) failStage = OW_FAIL_PARSE;
   
   // A message has been parsed, but the data-point correctness is unknown
   return parseOK;
@@ -217,7 +472,7 @@ bool OW_Weather::parseRequestSecure(String* url) {
 
   uint32_t dt = millis();
 
-  const char*  host = "api.openweathermap.org";
+  const char*  host = providerHost;
 
   #if (defined(ARDUINO_ARCH_MBED) || defined(ARDUINO_ARCH_RP2040)) && !defined(ARDUINO_RASPBERRY_PI_PICO_W)
   WiFiSSLClient client;
@@ -227,10 +482,15 @@ bool OW_Weather::parseRequestSecure(String* url) {
   client.setInsecure(); // Certificate not checked
   #endif
   port = 443;
+  heapUsed = 0;
+  #ifdef ESP8266
+  heapStart = ESP.getFreeHeap();
+  #endif
 
   if (!client.connect(host, port))
   {
     OW_STATUS_PRINTF("Connection failed.\n");
+    failStage = OW_FAIL_CONNECT;
     return false;
   }
   JSON_Decoder parser;
@@ -239,6 +499,8 @@ bool OW_Weather::parseRequestSecure(String* url) {
   uint32_t timeout = millis();
   char c = 0;
   parseOK = false;
+  failStage = OW_FAIL_NONE;
+  serverTime = 0;
 
   #ifdef SHOW_JSON
   int ccount = 0;
@@ -250,7 +512,7 @@ bool OW_Weather::parseRequestSecure(String* url) {
 
   // Send GET request
   Serial.println();
-  OW_STATUS_PRINTF("Sending GET request to api.openweathermap.org...\n");
+  OW_STATUS_PRINTF("Sending GET request to "); OW_STATUS_PRINT(host); OW_STATUS_PRINTF("...\n");
   Serial.println();
   client.print(String("GET ") + *url + " HTTP/1.1\r\n" + "Host: " + host + "\r\n" + "Connection: close\r\n\r\n");
   Serial.println();
@@ -265,10 +527,12 @@ bool OW_Weather::parseRequestSecure(String* url) {
     }
 
     OW_STATUS_PRINT(line); OW_STATUS_PRINTF("\n");
+    checkDateHeader(line);
 
-    if ((millis() - timeout) > 5000UL)
+    if ((millis() - timeout) > headerTimeout)
     {
       OW_STATUS_PRINTF ("HTTP header timeout\n");
+      failStage = OW_FAIL_HEADER;
       client.stop();
       return false;
     }
@@ -276,8 +540,10 @@ bool OW_Weather::parseRequestSecure(String* url) {
 
 
   // Parse the JSON data, available() includes yields
+  timeout = millis(); // Body budget is measured from the end of the header
   while (client.available() || client.connected())
   {
+    sampleHeap();
     while (client.available())
     {
       c = client.read();
@@ -288,9 +554,10 @@ bool OW_Weather::parseRequestSecure(String* url) {
   #endif
     }
 
-    if ((millis() - timeout) > 8000UL)
+    if ((millis() - timeout) > bodyTimeout)
     {
       OW_STATUS_PRINTF ("JSON client timeout\n");
+      failStage = OW_FAIL_BODY;
       parser.reset();
       client.stop();
       return false;
@@ -298,11 +565,14 @@ bool OW_Weather::parseRequestSecure(String* url) {
   }
 
   Serial.println();
-  OW_STATUS_PRINTF("\nDone in "); OW_STATUS_PRINT(millis()-dt); OW_STATUS_PRINTF(" ms\n");
+  OW_STATUS_PRINTF("\nDone in "); OW_STATUS_PRINT(millis()-dt); OW_STATUS_PRINTF(" ms, peak heap use ");
+  OW_STATUS_PRINT(heapUsed); OW_STATUS_PRINTF(" bytes\n");
 
   parser.reset();
 
   client.stop();
+
+  if (!parseOK) failStage = OW_FAIL_PARSE;
   
   // A message has been parsed without error but the data-point correctness is unknown
   return parseOK;
@@ -312,15 +582,20 @@ bool OW_Weather::parseRequestInsecure(String* url) {
 
   uint32_t dt = millis();
 
-  const char*  host = "api.openweathermap.org";
+  const char*  host = providerHost;
 
   // AXTLS used (insecure)
   WiFiClient client;
   port = 80;
+  heapUsed = 0;
+  #ifdef ESP8266
+  heapStart = ESP.getFreeHeap();
+  #endif
  
   if (!client.connect(host, port))
   {
     OW_STATUS_PRINTF("Connection failed.\n");
+    failStage = OW_FAIL_CONNECT;
     return false;
   }
   JSON_Decoder parser;
@@ -329,6 +604,8 @@ bool OW_Weather::parseRequestInsecure(String* url) {
   uint32_t timeout = millis();
   char c = 0;
   parseOK = false;
+  failStage = OW_FAIL_NONE;
+  serverTime = 0;
 
   #ifdef SHOW_JSON
   int ccount = 0;
@@ -337,7 +614,7 @@ bool OW_Weather::parseRequestInsecure(String* url) {
   OW_STATUS_PRINTF("\nThe connection to server is INSECURE (using AXTLS).\n");
 
   // Send GET request
-  OW_STATUS_PRINTF("Sending GET request to api.openweathermap.org...\n");
+  OW_STATUS_PRINTF("Sending GET request to "); OW_STATUS_PRINT(host); OW_STATUS_PRINTF("...\n");
   client.print(String("GET ") + *url + " HTTP/1.1\r\n" + "Host: " + host + "\r\n" + "Connection: close\r\n\r\n");
 
   // Pull out any header, X-Forecast-API-Calls: reports current daily API call count
@@ -350,10 +627,12 @@ bool OW_Weather::parseRequestInsecure(String* url) {
     }
 
     OW_STATUS_PRINT(line); OW_STATUS_PRINTF("\n");
+    checkDateHeader(line);
 
-    if ((millis() - timeout) > 5000UL)
+    if ((millis() - timeout) > headerTimeout)
     {
       OW_STATUS_PRINTF("HTTP header timeout\n");
+      failStage = OW_FAIL_HEADER;
       client.stop();
       return false;
     }
@@ -361,8 +640,10 @@ bool OW_Weather::parseRequestInsecure(String* url) {
 
 
   // Parse the JSON data, available() includes yields
+  timeout = millis(); // Body budget is measured from the end of the header
   while (client.available() || client.connected())
   {
+    sampleHeap();
     while (client.available())
     {
       c = client.read();
@@ -373,20 +654,24 @@ bool OW_Weather::parseRequestInsecure(String* url) {
   #endif
     }
 
-    if ((millis() - timeout) > 8000UL)
+    if ((millis() - timeout) > bodyTimeout)
     {
       OW_STATUS_PRINTF("JSON client timeout\n");
+      failStage = OW_FAIL_BODY;
       parser.reset();
       client.stop();
       return false;
     }
   }
 
-  OW_STATUS_PRINTF("\nDone in "); OW_STATUS_PRINT(millis()-dt); OW_STATUS_PRINTF(" ms\n");
+  OW_STATUS_PRINTF("\nDone in "); OW_STATUS_PRINT(millis()-dt); OW_STATUS_PRINTF(" ms, peak heap use ");
+  OW_STATUS_PRINT(heapUsed); OW_STATUS_PRINTF(" bytes\n");
 
   parser.reset();
 
   client.stop();
+
+  if (!parseOK) failStage = OW_FAIL_PARSE;
   
   // A message has been parsed without error but the data-point correctness is unknown
   return parseOK;
@@ -415,7 +700,8 @@ void OW_Weather::startDocument() {
   valuePath = "";
   arrayIndex = 0;
   arrayLevel = 0;
-  parseOK = true;
+  parseOK = false;
+  parseError = false;
 
 #ifdef SHOW_CALLBACK
   Serial.print("\n>>> Start document >>>");
@@ -424,6 +710,9 @@ void OW_Weather::startDocument() {
 
 void OW_Weather::endDocument() {
 
+  // Only a document that reached its end parsed, a body cut off by the
+  // connection never gets here
+  parseOK = !parseError;
   currentParent = currentKey = "";
   objectLevel = 0;
   valuePath = "";
@@ -461,6 +750,7 @@ void OW_Weather::endObject() {
 void OW_Weather::startArray() {
 
   arrayLevel++;
+  valueIndex = 0;
   valuePath = currentParent + "/" + currentKey; // aka = current Object, e.g. "daily:data"
 
 #ifdef SHOW_CALLBACK
@@ -486,6 +776,7 @@ void OW_Weather::error( const char *message ) {
   Serial.print("\nParse error message: ");
   Serial.print(message);
   parseOK = false;
+  parseError = true;
 }
 
 /***************************************************************************************
@@ -494,7 +785,11 @@ void OW_Weather::error( const char *message ) {
 ***************************************************************************************/
 void OW_Weather::value(const char *val)
 {
-  if (oneCall) {
+  if (openMeteo) {
+    openMeteoDataSet(val);
+    valueIndex++;
+  }
+  else if (oneCall) {
     if (!partialSet) fullDataSet(val);
     else partialDataSet(val);
   }
@@ -521,8 +816,11 @@ void OW_Weather::fullDataSet(const char *val) {
     }
   }
 
+  // Sections the request excluded have no structure, a server that sends
+  // them anyway is ignored
+
   // Current forecast - no array index - short path
-  if (currentParent == "current") {
+  if (currentParent == "current" && current) {
     data_set = "current";
     if (currentKey == "dt") current->dt = (uint32_t)value.toInt();
     else
@@ -569,7 +867,7 @@ void OW_Weather::fullDataSet(const char *val) {
   }
 
   // Hourly forecast
-  if (currentParent == "hourly") {
+  if (currentParent == "hourly" && hourly) {
     data_set = "hourly";
     
     if (arrayIndex >= MAX_HOURS) return;
@@ -616,7 +914,7 @@ void OW_Weather::fullDataSet(const char *val) {
 
 
   // Daily forecast
-  if (currentParent == "daily") {
+  if (currentParent == "daily" && daily) {
     data_set = "daily";
     
     if (arrayIndex >= MAX_DAYS) return;
@@ -687,6 +985,21 @@ void OW_Weather::fullDataSet(const char *val) {
     return;
   }
 
+  // First alert - stored with the current weather
+  if (currentParent == "alerts" && current && alerts) {
+    data_set = "alerts";
+
+    if (arrayIndex > 0) return;
+
+    if (currentKey == "event") current->alert_event = value;
+    else
+    if (currentKey == "start") current->alert_start = (uint32_t)value.toInt();
+    else
+    if (currentKey == "end") current->alert_end = (uint32_t)value.toInt();
+
+    return;
+  }
+
 }
 
 /***************************************************************************************
@@ -778,7 +1091,7 @@ void OW_Weather::partialDataSet(const char *val) {
    String value = val;
 
   // Current forecast - no array index - short path
-  if (currentParent == "current") {
+  if (currentParent == "current" && current) {
     data_set = "current";
     if (currentKey == "dt") current->dt = (uint32_t)value.toInt();
     else
@@ -826,7 +1139,7 @@ void OW_Weather::partialDataSet(const char *val) {
 
 /*
   // Hourly forecast
-  if (currentParent == "hourly") {
+  if (currentParent == "hourly" && hourly) {
     data_set = "hourly";
     
     if (arrayIndex >= MAX_HOURS) return;
@@ -869,7 +1182,7 @@ void OW_Weather::partialDataSet(const char *val) {
 */
 
   // Daily forecast
-  if (currentParent == "daily") {
+  if (currentParent == "daily" && daily) {
     data_set = "daily";
     
     if (arrayIndex >= MAX_DAYS) return;
@@ -934,4 +1247,161 @@ void OW_Weather::partialDataSet(const char *val) {
     return;
   }
 
+  // First alert - stored with the current weather
+  if (currentParent == "alerts" && current && alerts) {
+    data_set = "alerts";
+
+    if (arrayIndex > 0) return;
+
+    if (currentKey == "event") current->alert_event = value;
+    else
+    if (currentKey == "start") current->alert_start = (uint32_t)value.toInt();
+    else
+    if (currentKey == "end") current->alert_end = (uint32_t)value.toInt();
+
+    return;
+  }
+
+}
+
+/***************************************************************************************
+** Function name:           wmoConditionId
+** Description:             Translate a WMO weather code to an OpenWeather condition id
+***************************************************************************************/
+static uint16_t wmoConditionId(int code) {
+
+  switch (code) {
+    case 0:  return 800; // Clear sky
+    case 1:  return 801; // Mainly clear
+    case 2:  return 802; // Partly cloudy
+    case 3:  return 804; // Overcast
+    case 45:
+    case 48: return 741; // Fog
+    case 51: return 300; // Drizzle
+    case 53: return 301;
+    case 55: return 302;
+    case 56:
+    case 57: return 511; // Freezing drizzle
+    case 61: return 500; // Rain
+    case 63: return 501;
+    case 65: return 502;
+    case 66:
+    case 67: return 511; // Freezing rain
+    case 71: return 600; // Snow
+    case 73: return 601;
+    case 75: return 602;
+    case 77: return 600; // Snow grains
+    case 80: return 520; // Rain showers
+    case 81: return 521;
+    case 82: return 522;
+    case 85: return 620; // Snow showers
+    case 86: return 622;
+    case 95: return 211; // Thunderstorm
+    case 96:
+    case 99: return 202; // Thunderstorm with hail
+    default: return 0;
+  }
+}
+
+/***************************************************************************************
+** Function name:           conditionMain
+** Description:             OpenWeather "main" text for a condition id
+***************************************************************************************/
+static const char* conditionMain(uint16_t id) {
+
+  switch (id / 100) {
+    case 2: return "Thunderstorm";
+    case 3: return "Drizzle";
+    case 5: return "Rain";
+    case 6: return "Snow";
+    case 7: return "Fog";
+    case 8: return id == 800 ? "Clear" : "Clouds";
+    default: return "Unknown";
+  }
+}
+
+/***************************************************************************************
+** Function name:           openMeteoDataSet
+** Description:             Collects the Open-Meteo data set
+***************************************************************************************/
+// Open-Meteo arrays hold one field for every time step, e.g. "hourly/temperature_2m",
+// so the array key is currentKey and valueIndex is the time step.
+void OW_Weather::openMeteoDataSet(const char *val) {
+
+   String value = val;
+
+  // Start of JSON
+  if (currentParent == "") {
+    if (currentKey == "latitude") lat = value.toFloat();
+    else
+    if (currentKey == "longitude") lon = value.toFloat();
+    else
+    if (currentKey == "timezone") timezone = value;
+    else
+    if (currentKey == "utc_offset_seconds") timezoneOffset = value.toInt();
+
+    return;
+  }
+
+  // Current weather - no array index
+  if (currentParent == "current" && current) {
+    data_set = "current";
+    if (currentKey == "time") current->dt = (uint32_t)value.toInt();
+    else
+    if (currentKey == "temperature_2m") current->temp = value.toFloat();
+    else
+    if (currentKey == "relative_humidity_2m") current->humidity = value.toInt();
+    else
+    if (currentKey == "weather_code") {
+      current->id = wmoConditionId(value.toInt());
+      current->main = conditionMain(current->id);
+    }
+
+    return;
+  }
+
+  // Hourly forecast
+  if (currentParent == "hourly" && hourly) {
+    data_set = "hourly";
+
+    if (valueIndex >= MAX_HOURS) return;
+
+    if (currentKey == "time") hourly->dt[valueIndex] = (uint32_t)value.toInt();
+    else
+    if (currentKey == "temperature_2m") hourly->temp[valueIndex] = value.toFloat();
+    else
+    if (currentKey == "weather_code") {
+      hourly->id[valueIndex] = wmoConditionId(value.toInt());
+      hourly->main[valueIndex] = conditionMain(hourly->id[valueIndex]);
+    }
+
+    return;
+  }
+
+  // Daily forecast
+  if (currentParent == "daily" && daily) {
+    data_set = "daily";
+
+    if (valueIndex >= MAX_DAYS) return;
+
+    // Daily time is local midnight, stored as local noon like the onecall
+    // daily dt so a day/night check of it gives day
+    if (currentKey == "time") daily->dt[valueIndex] = (uint32_t)value.toInt() + 12 * 3600;
+    else
+    if (currentKey == "sunrise") daily->sunrise[valueIndex] = (uint32_t)value.toInt();
+    else
+    if (currentKey == "sunset") daily->sunset[valueIndex] = (uint32_t)value.toInt();
+    else
+    if (currentKey == "temperature_2m_min") daily->temp_min[valueIndex] = value.toFloat();
+    else
+    if (currentKey == "temperature_2m_max") daily->temp_max[valueIndex] = value.toFloat();
+    else
+    if (currentKey == "weather_code") {
+      daily->id[valueIndex] = wmoConditionId(value.toInt());
+      daily->main[valueIndex] = conditionMain(daily->id[valueIndex]);
+    }
+
+    return;
+  }
+
 }
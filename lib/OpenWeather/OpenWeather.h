@@ -16,12 +16,22 @@
 #ifndef OpenWeather_h
 #define OpenWeather_h
 
+// Stage of parseRequest() that failed, reported in OW_Weather::failStage
+#define OW_FAIL_NONE    0 // No failure, message parsed
+#define OW_FAIL_CONNECT 1 // TCP/TLS connection could not be opened
+#define OW_FAIL_HEADER  2 // Header stage ran out of its deadline budget
+#define OW_FAIL_BODY    3 // Body stage ran out of its deadline budget
+#define OW_FAIL_STALL   4 // No byte received within the stall timeout
+#define OW_FAIL_PARSE   5 // Message ended but did not parse
+
 // The streaming parser to use is not the Arduino IDE library manager default,
 // but this one which is slightly different and renamed to avoid conflicts:
 // https://github.com/Bodmer/JSON_Decoder
 
+#include <Client.h>
 #include <JSON_Listener.h>
 #include <JSON_Decoder.h>
+#include <HttpSpans.h>
 
 #include "User_Setup.h"
 #include "Data_Point_Set.h"
@@ -34,10 +44,13 @@ class OW_Weather: public JsonListener {
 
   public:
     // Sketch calls this forecast request, it returns true if no parse errors encountered
-    // ESP8266 only: setting secure to false will invoke an insecure connection
+    // Setting secure to false will invoke an insecure (http) connection
+    // Setting alerts to false excludes the alerts block and leaves the alert
+    // fields of current as they are
     bool getForecast(OW_current *current, OW_hourly *hourly, OW_daily  *daily,
                      String api_key, String latitude, String longitude,
-                     String units, String language, bool secure = true);
+                     String units, String language, bool secure = true,
+                     bool alerts = true);
 
     // From 2023 the above call requires a subscription, this of uses the forecast API
     // and is free for 1000 calls per day
@@ -45,6 +58,13 @@ class OW_Weather: public JsonListener {
                      String api_key, String latitude, String longitude,
                      String units, String language, bool secure = true);
 
+    // Same structures filled from the free Open-Meteo API, only the fields shown
+    // by the sketch are requested: temperature, weather code, humidity,
+    // sunrise/sunset and daily min/max
+    bool getOpenMeteoForecast(OW_current *current, OW_hourly *hourly, OW_daily *daily,
+                              String latitude, String longitude,
+                              String units, bool secure = true);
+
     // Called by library (or user sketch), sends a GET request to a https (secure) url
     bool parseRequest(String url); // and parses response, returns true if no parse errors
 
@@ -54,6 +74,31 @@ class OW_Weather: public JsonListener {
 
     void partialDataSet(bool partialSet);
 
+    // Send requests to another host (ESP32), e.g. a local mock server. A port
+    // of 0 uses the default port of the connection type.
+    void setServer(String host, uint16_t port = 0);
+
+    // Send requests over this connection instead of a new WiFiClient (ESP32
+    // and host), e.g. a replay of recorded responses in the native tests.
+    // nullptr restores the default.
+    void setClient(Client *client);
+
+    // Set the deadline budget (ms) of each parseRequest() stage. Header and
+    // body budgets are measured from the start of their own stage, stall
+    // aborts the request if the gap between two received bytes exceeds it.
+    void setTimeouts(uint32_t connectTimeout, uint32_t headerTimeout,
+                     uint32_t bodyTimeout, uint32_t stallTimeout);
+
+    // Result of the last parseRequest(), for failure reporting by the sketch
+    uint8_t  failStage = OW_FAIL_NONE; // One of the OW_FAIL_* values
+    uint32_t bytesReceived = 0;        // Header and body bytes received
+    uint32_t timeToFirstByte = 0;      // ms from request start to first byte
+    uint32_t fetchTime = 0;            // ms from request start to end of body
+    uint32_t heapUsed = 0;             // Peak heap taken during the request, bytes
+    uint32_t bytesCopied = 0;          // Bytes the library copied, reads and split header lines (ESP32)
+    uint32_t serverTime = 0;           // UTC from the response Date header, 0 if none
+    uint32_t serverTimeMillis = 0;     // millis() when serverTime was received
+
     float    lat = 0;
     float    lon = 0;
     String   timezone = "";
@@ -86,6 +131,14 @@ class OW_Weather: public JsonListener {
     void fullDataSet(const char *value);    // Populate structure with full data set
     void partialDataSet(const char *value); // Populate structure with minimal data set
     void forecastDataSet(const char *val);  // Populate forecast structure
+    void openMeteoDataSet(const char *val); // Populate structures from Open-Meteo
+
+    // Send the GET request on an open connection and feed the response to the parser
+    bool streamResponse(Client &client, const String &url, uint32_t dt);
+
+    void sampleHeap(); // Update heapUsed from the current free heap
+    void checkDateHeader(const String &line); // Set serverTime from a Date header line
+    void checkDateHeader(const char *line, size_t length);
 
 
   private: // Variables used internal to library
@@ -112,9 +165,13 @@ class OW_Weather: public JsonListener {
 
     bool     parseOK;       // true if the parse been completed
                             // (does not mean data values gathered are good!)
+    bool     parseError;    // true if the parser reported an error
 
     bool     partialSet = false;    // Set true for partial data set acquisition
     bool     oneCall = true;        // Use the oneCall API
+    bool     openMeteo = false;     // Use the Open-Meteo API
+    bool     alerts = true;         // Store the first alert in current
+    const char* providerHost = "api.openweathermap.org"; // Host of the selected API
 
     String   currentParent; // Current object e.g. "daily"
     uint16_t objectLevel;   // Object level, increments for new object, decrements at end
@@ -123,9 +180,20 @@ class OW_Weather: public JsonListener {
     String   arrayPath;     // Path to name:value pair e.g.  "daily/data"
     uint16_t arrayIndex;    // Array index e.g. 5 for day 5 forecast, qualify with arrayPath
     uint16_t arrayLevel;    // Array level
+    uint16_t valueIndex;    // Index of the value in the current array
 
     bool     Secure = true; // Link security setting secure (https) or insecure (http)
     uint16_t port;          // 
+    String   serverHost = "";     // See setServer(), empty uses providerHost
+    uint16_t serverPort = 0;
+    Client  *requestClient = nullptr; // See setClient()
+
+    uint32_t connectTimeout = 5000; // Stage deadline budgets in ms, see setTimeouts()
+    uint32_t headerTimeout  = 5000;
+    uint32_t bodyTimeout    = 8000;
+    uint32_t stallTimeout   = 3000;
+
+    uint32_t heapStart = 0; // Free heap when the request started
 };
 
 /***************************************************************************************
@@ -14,6 +14,10 @@
     // maximum) TFT_eSPI_OpenWeather example requires this to be >= 5 (today + 4
     // forecast days)
 
+// Size of the stack buffer the response is read into (ESP32), every read pulls
+// up to this many bytes out of the client and TLS layer in one call
+#define OW_READ_BUFFER 512
+
 // #define SHOW_HEADER   // Debug only - for checking response header via serial
 // message #define SHOW_JSON     // Debug only - simple serial output formatting
 // of whole JSON message #define SHOW_CALLBACK // Debug only to show the decode
@@ -0,0 +1,68 @@
+#include "BmpHeader.h"
+
+// BMP data is stored little-endian
+static uint16_t get16(const uint8_t* data) {
+  return data[0] | (uint16_t)data[1] << 8;
+}
+
+static uint32_t get32(const uint8_t* data) {
+  return get16(data) | (uint32_t)get16(data + 2) << 16;
+}
+
+uint8_t parseBmpHeader(const uint8_t* data, uint16_t length,
+                       BmpHeader& header) {
+  if (length < 2 || get16(data) != 0x4D42) {
+    return BMP_NOT_A_BITMAP;
+  }
+  if (length < 14 + 40) {
+    return BMP_UNSUPPORTED;
+  }
+  header.fileSize = get32(data + 2);
+  header.imageOffset = get32(data + 10);
+  header.headerSize = get32(data + 14);
+  header.width = get32(data + 18);
+  int32_t height = (int32_t)get32(data + 22);
+  header.planes = get16(data + 26);
+  header.depth = get16(data + 28);
+  header.format = get32(data + 30);
+  header.flip = height > 0;
+  header.height = height < 0 ? -height : height;
+
+  // BITMAPINFOHEADER, the V2/V3 extensions of it, V4 and V5
+  const uint32_t headerSize = header.headerSize;
+  if (headerSize != 40 && headerSize != 52 && headerSize != 56 &&
+      headerSize != 108 && headerSize != 124) {
+    return BMP_UNSUPPORTED;
+  }
+  const uint16_t depth = header.depth;
+  if (header.planes != 1 || (header.format != 0 && header.format != 3) ||
+      (depth != 1 && depth != 4 && depth != 8 && depth != 16 && depth != 24 &&
+       depth != 32)) {
+    return BMP_UNSUPPORTED;
+  }
+  if (header.width == 0 || header.width > 0xFFFF || header.height == 0 ||
+      header.height > 0xFFFF) {
+    return BMP_UNSUPPORTED;
+  }
+
+  // Rows are padded to a 4-byte boundary
+  header.rowSize = (header.width * depth + 31) / 32 * 4;
+  if (header.imageOffset < 14 + headerSize ||
+      (header.fileSize != 0 &&
+       header.imageOffset + header.rowSize * header.height >
+           header.fileSize)) {
+    return BMP_UNSUPPORTED;
+  }
+  header.paletteOffset = 0;
+  header.paletteSize = 0;
+  if (depth <= 8) {
+    // The palette ends where the pixels start, there may be bitfield masks
+    // between it and the info header
+    header.paletteSize = 4 << depth;
+    if (header.imageOffset < 14 + headerSize + header.paletteSize) {
+      return BMP_UNSUPPORTED;
+    }
+    header.paletteOffset = header.imageOffset - header.paletteSize;
+  }
+  return BMP_OK;
+}
@@ -0,0 +1,39 @@
+#include "DayNight.h"
+
+void buildDayNightTable(DayNightTable& table, const uint32_t* sunrise,
+                        const uint32_t* sunset, uint8_t days, int32_t offset) {
+  table.count = 0;
+  for (uint8_t i = 0; i < days && table.count < MAX_DAYLIGHT_INTERVALS; i++) {
+    // Polar day and night have no sunrise or sunset
+    if (sunrise[i] == 0 || sunset[i] <= sunrise[i]) {
+      continue;
+    }
+    // Insertion keeps the table sorted, the API already sends days in order
+    uint8_t j = table.count++;
+    for (; j > 0 && table.sunrise[j - 1] > sunrise[i] + offset; j--) {
+      table.sunrise[j] = table.sunrise[j - 1];
+      table.sunset[j] = table.sunset[j - 1];
+    }
+    table.sunrise[j] = sunrise[i] + offset;
+    table.sunset[j] = sunset[i] + offset;
+  }
+}
+
+bool isNight(const DayNightTable& table, uint32_t t) {
+  // Without any sunrise (polar regions, no forecast yet) show day icons
+  if (table.count == 0) {
+    return false;
+  }
+  // Find the last interval that starts at or before t
+  uint8_t lo = 0;
+  uint8_t hi = table.count;
+  while (lo < hi) {
+    const uint8_t mid = (lo + hi) / 2;
+    if (table.sunrise[mid] <= t) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo == 0 || t > table.sunset[lo - 1];
+}
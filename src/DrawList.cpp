@@ -0,0 +1,74 @@
+#include "DrawList.h"
+
+DrawOp* DrawList::add(DrawOpType type) {
+  if (count >= MAX_DRAW_OPS) {
+    overflow = true;
+    return nullptr;
+  }
+  DrawOp& op = ops[count++];
+  op = DrawOp();
+  op.type = type;
+  return &op;
+}
+
+void DrawList::clear() {
+  count = 0;
+  textUsed = 0;
+  textColor = 0;
+  overflow = false;
+}
+
+void DrawList::setFont(const GFXfont* font) {
+  DrawOp* op = add(DRAW_FONT);
+  if (op != nullptr) {
+    op->font = font;
+  }
+}
+
+void DrawList::setTextColor(uint16_t color) {
+  if (color == textColor) {
+    return;
+  }
+  DrawOp* op = add(DRAW_COLOR);
+  if (op != nullptr) {
+    op->color = color;
+    textColor = color;
+  }
+}
+
+void DrawList::setCursor(int16_t x, int16_t y) {
+  DrawOp* op = add(DRAW_CURSOR);
+  if (op != nullptr) {
+    op->x = x;
+    op->y = y;
+  }
+}
+
+void DrawList::drawIcon(uint8_t icon, int16_t x, int16_t y) {
+  DrawOp* op = add(DRAW_ICON);
+  if (op != nullptr) {
+    op->icon = icon;
+    op->x = x;
+    op->y = y;
+  }
+}
+
+size_t DrawList::write(uint8_t c) {
+  if (textUsed >= DRAW_TEXT_SIZE) {
+    overflow = true;
+    return 0;
+  }
+  // Consecutive characters share one op, its text is always the last run
+  DrawOp* op = count > 0 && ops[count - 1].type == DRAW_TEXT
+                   ? &ops[count - 1]
+                   : add(DRAW_TEXT);
+  if (op == nullptr) {
+    return 0;
+  }
+  if (op->length == 0) {
+    op->text = textUsed;
+  }
+  text[textUsed++] = c;
+  op->length++;
+  return 1;
+}
@@ -0,0 +1,18 @@
+#include "Fingerprint.h"
+
+#include <string.h>
+
+void addBytes(Fingerprint& fingerprint, const void* data, size_t length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t i = 0; i < length; i++) {
+    fingerprint.hash = (fingerprint.hash ^ bytes[i]) * 16777619u;
+  }
+}
+
+void addString(Fingerprint& fingerprint, const char* text) {
+  addBytes(fingerprint, text, strlen(text) + 1);
+}
+
+void addInt(Fingerprint& fingerprint, int32_t value) {
+  addBytes(fingerprint, &value, sizeof(value));
+}
@@ -0,0 +1,153 @@
+#include "FrameBlit.h"
+
+// 8 bitmap pixels starting at bit, MSB first, pixels outside the row are 0.
+// Unaligned positions merge the two bytes the pixels straddle.
+static uint8_t sourceByte(const uint8_t* row, int32_t bit, uint16_t bytes) {
+  const int32_t index = bit >= 0 ? bit / 8 : (bit - 7) / 8;
+  const uint8_t shift = bit - index * 8;
+  const uint8_t high = index >= 0 && index < bytes ? row[index] : 0;
+  if (shift == 0) {
+    return high;
+  }
+  const uint8_t low = index + 1 >= 0 && index + 1 < bytes ? row[index + 1] : 0;
+  return (high << shift) | (low >> (8 - shift));
+}
+
+static uint8_t reverseBits(uint8_t b) {
+  b = (b & 0xF0) >> 4 | (b & 0x0F) << 4;
+  b = (b & 0xCC) >> 2 | (b & 0x33) << 2;
+  b = (b & 0xAA) >> 1 | (b & 0x55) << 1;
+  return b;
+}
+
+// Blits one bitmap row into panel row py, rotation 0 or 2. The panel pixels
+// [x0, x1) are the ones the row covers after clipping.
+static void blitRow(const FrameTarget& target, uint16_t py, int16_t x0,
+                    int16_t x1, int32_t firstBit, bool reversed,
+                    const uint8_t* row, uint16_t bytes, bool white) {
+  if (py < target.top || py >= target.top + target.rows) {
+    return;
+  }
+  uint8_t* out =
+      target.buffer + (uint32_t)(py - target.top) * (target.width / 8);
+  const int16_t firstByte = x0 / 8;
+  const int16_t lastByte = (x1 - 1) / 8;
+  for (int16_t bx = firstByte; bx <= lastByte; bx++) {
+    uint8_t mask = 0xFF;
+    if (bx == firstByte) {
+      mask &= 0xFF >> (x0 % 8);
+    }
+    if (bx == lastByte) {
+      mask &= 0xFF << (7 - (x1 - 1) % 8);
+    }
+    uint8_t pixels;
+    if (reversed) {
+      // Panel pixel X shows bitmap bit firstBit - X
+      pixels = reverseBits(sourceByte(row, firstBit - bx * 8 - 7, bytes));
+    } else {
+      // Panel pixel X shows bitmap bit X - firstBit
+      pixels = sourceByte(row, bx * 8 - firstBit, bytes);
+    }
+    if (white) {
+      out[bx] |= pixels & mask;
+    } else {
+      out[bx] &= ~(pixels & mask);
+    }
+  }
+}
+
+// Panel pixel X, Y of the pixel at x, y in rotated coordinates, false
+// outside the panel or the rows in the buffer
+static bool panelPixel(const FrameTarget& target, int16_t x, int16_t y,
+                       uint16_t& X, uint16_t& Y) {
+  const bool swapped = target.rotation & 1;
+  const int16_t width = swapped ? target.height : target.width;
+  const int16_t height = swapped ? target.width : target.height;
+  if (x < 0 || x >= width || y < 0 || y >= height) {
+    return false;
+  }
+  switch (target.rotation & 3) {
+    case 0:
+      X = x;
+      Y = y;
+      break;
+    case 1:
+      X = target.width - y - 1;
+      Y = x;
+      break;
+    case 2:
+      X = target.width - x - 1;
+      Y = target.height - y - 1;
+      break;
+    default:
+      X = y;
+      Y = target.height - x - 1;
+      break;
+  }
+  return Y >= target.top && Y < target.top + target.rows;
+}
+
+static void setPixel(const FrameTarget& target, uint16_t X, uint16_t Y,
+                     bool white) {
+  uint8_t& out =
+      target.buffer[X / 8 + (uint32_t)(Y - target.top) * (target.width / 8)];
+  out = white ? out | (0x80 >> (X % 8)) : out & ~(0x80 >> (X % 8));
+}
+
+void setFramePixel(const FrameTarget& target, int16_t x, int16_t y,
+                   bool white) {
+  uint16_t X, Y;
+  if (panelPixel(target, x, y, X, Y)) {
+    setPixel(target, X, Y, white);
+  }
+}
+
+static void blit(const FrameTarget& target, int16_t x, int16_t y,
+                 const uint8_t* bits, uint16_t w, uint16_t h, bool white) {
+  const uint16_t bytes = (w + 7) / 8;
+  const bool swapped = target.rotation & 1;
+  const int16_t width = swapped ? target.height : target.width;
+  const int16_t height = swapped ? target.width : target.height;
+  const int16_t x0 = x < 0 ? 0 : x;
+  const int16_t x1 = x + w > width ? width : x + w;
+  if (x0 >= x1) {
+    return;
+  }
+  for (uint16_t r = 0; r < h; r++) {
+    const int16_t py = y + r;
+    if (py < 0 || py >= height) {
+      continue;
+    }
+    const uint8_t* row = bits + (uint32_t)r * bytes;
+    switch (target.rotation & 3) {
+      case 0:
+        blitRow(target, py, x0, x1, x, false, row, bytes, white);
+        break;
+      case 2:
+        blitRow(target, target.height - py - 1, target.width - x1,
+                target.width - x0, target.width - 1 - x, true, row, bytes,
+                white);
+        break;
+      default:
+        // Rows become panel columns, so go pixel by pixel like drawPixel()
+        for (int16_t px = x0; px < x1; px++) {
+          uint16_t X, Y;
+          if ((row[(px - x) / 8] & (0x80 >> ((px - x) % 8))) &&
+              panelPixel(target, px, py, X, Y)) {
+            setPixel(target, X, Y, white);
+          }
+        }
+        break;
+    }
+  }
+}
+
+void blitBitmap(const FrameTarget& target, int16_t x, int16_t y,
+                const uint8_t* bits, uint16_t w, uint16_t h) {
+  blit(target, x, y, bits, w, h, false);
+}
+
+void eraseBitmap(const FrameTarget& target, int16_t x, int16_t y,
+                 const uint8_t* bits, uint16_t w, uint16_t h) {
+  blit(target, x, y, bits, w, h, true);
+}
@@ -0,0 +1,77 @@
+#include "FrameCodec.h"
+
+// Byte i of the frame XORed with the one above it
+static uint8_t delta(const uint8_t* frame, uint32_t i, uint16_t rowBytes) {
+  return frame[i] ^ (i >= rowBytes ? frame[i - rowBytes] : 0xFF);
+}
+
+static bool zeroRunAt(const uint8_t* frame, uint32_t length,
+                      uint16_t rowBytes, uint32_t i) {
+  if (length - i < FRAME_MIN_ZERO_RUN) {
+    return false;
+  }
+  for (uint8_t n = 0; n < FRAME_MIN_ZERO_RUN; n++) {
+    if (delta(frame, i + n, rowBytes) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t maxEncodedFrameSize(uint32_t length) {
+  return length + (length + FRAME_MAX_RUN - 1) / FRAME_MAX_RUN;
+}
+
+uint32_t encodeFrame(const uint8_t* frame, uint32_t length, uint16_t rowBytes,
+                     uint8_t* out, uint32_t capacity) {
+  uint32_t i = 0;
+  uint32_t o = 0;
+  while (i < length) {
+    uint32_t run = 0;
+    while (i + run < length && run < FRAME_MAX_RUN &&
+           delta(frame, i + run, rowBytes) == 0) {
+      run++;
+    }
+    if (run >= FRAME_MIN_ZERO_RUN || (run > 0 && i + run == length)) {
+      if (o >= capacity) {
+        return 0;
+      }
+      out[o++] = FRAME_RUN_ZERO | (run - 1);
+      i += run;
+      continue;
+    }
+
+    const uint32_t start = i;
+    do {
+      i++;
+    } while (i < length && i - start < FRAME_MAX_RUN &&
+             !zeroRunAt(frame, length, rowBytes, i));
+    if (o + 1 + (i - start) > capacity) {
+      return 0;
+    }
+    out[o++] = i - start - 1;
+    for (uint32_t j = start; j < i; j++) {
+      out[o++] = delta(frame, j, rowBytes);
+    }
+  }
+  return o;
+}
+
+bool decodeFrame(const uint8_t* in, uint32_t size, uint8_t* frame,
+                 uint32_t length, uint16_t rowBytes) {
+  uint32_t i = 0;
+  uint32_t o = 0;
+  while (i < size) {
+    const uint8_t control = in[i++];
+    const uint32_t run = (control & ~FRAME_RUN_ZERO) + 1;
+    if (o + run > length ||
+        (!(control & FRAME_RUN_ZERO) && i + run > size)) {
+      return false;
+    }
+    for (uint32_t end = o + run; o < end; o++) {
+      const uint8_t above = o >= rowBytes ? frame[o - rowBytes] : 0xFF;
+      frame[o] = control & FRAME_RUN_ZERO ? above : above ^ in[i++];
+    }
+  }
+  return o == length;
+}
@@ -0,0 +1,60 @@
+#include "GlyphCache.h"
+
+#include <string.h>
+
+static void unpackGlyph(const uint8_t* bits, uint8_t width, uint8_t height,
+                        uint8_t* rows) {
+  const uint8_t rowBytes = (width + 7) / 8;
+  memset(rows, 0, rowBytes * height);
+  uint16_t bit = 0;
+  for (uint8_t y = 0; y < height; y++) {
+    uint8_t* row = rows + y * rowBytes;
+    for (uint8_t x = 0; x < width; x++, bit++) {
+      if (bits[bit >> 3] & (0x80 >> (bit & 7))) {
+        row[x >> 3] |= 0x80 >> (x & 7);
+      }
+    }
+  }
+}
+
+const uint8_t* glyphRows(GlyphCache& cache, const GFXfont* font, uint8_t c) {
+  if (c < font->first || c > font->last ||
+      c - font->first >= GLYPH_CACHE_CHARS) {
+    return nullptr;
+  }
+  uint8_t slot = 0;
+  while (slot < GLYPH_CACHE_FONTS && cache.fonts[slot] != font &&
+         cache.fonts[slot] != nullptr) {
+    slot++;
+  }
+  if (slot == GLYPH_CACHE_FONTS) {
+    return nullptr;
+  }
+  cache.fonts[slot] = font;
+
+  const uint8_t index = c - font->first;
+  uint16_t& offset = cache.offsets[slot][index];
+  if (offset != 0) {
+    cache.hits++;
+    return cache.rows + offset - 1;
+  }
+  cache.misses++;
+  const GFXglyph& glyph = font->glyph[index];
+  const uint16_t size = (glyph.width + 7) / 8 * glyph.height;
+  const uint16_t budget =
+      cache.budget < GLYPH_CACHE_SIZE ? cache.budget : GLYPH_CACHE_SIZE;
+  if (size == 0 || cache.used + size > budget) {
+    return nullptr;
+  }
+  unpackGlyph(font->bitmap + glyph.bitmapOffset, glyph.width, glyph.height,
+              cache.rows + cache.used);
+  offset = cache.used + 1;
+  cache.used += size;
+  return cache.rows + offset - 1;
+}
+
+void clearGlyphCache(GlyphCache& cache) {
+  memset(cache.fonts, 0, sizeof(cache.fonts));
+  memset(cache.offsets, 0, sizeof(cache.offsets));
+  cache.used = 0;
+}
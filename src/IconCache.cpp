@@ -0,0 +1,85 @@
+#include "IconCache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void freeEntry(IconCache& cache, IconCacheEntry& entry) {
+  free(entry.bits);
+  cache.used -= entry.size;
+  entry.key[0] = '\0';
+  entry.bits = nullptr;
+  entry.size = 0;
+}
+
+const IconCacheEntry* findIcon(IconCache& cache, const char* key) {
+  for (uint8_t i = 0; i < ICON_CACHE_SLOTS; i++) {
+    IconCacheEntry& entry = cache.entries[i];
+    if (entry.bits != nullptr && strcmp(entry.key, key) == 0) {
+      entry.lastUse = ++cache.clock;
+      cache.hits++;
+      return &entry;
+    }
+  }
+  cache.misses++;
+  return nullptr;
+}
+
+IconCacheEntry* insertIcon(IconCache& cache, const char* key, uint16_t width,
+                           uint16_t height) {
+  const uint32_t size = (uint32_t)(width + 7) / 8 * height;
+  if (size == 0 || size > cache.budget ||
+      strlen(key) >= ICON_CACHE_KEY_LENGTH) {
+    return nullptr;
+  }
+
+  IconCacheEntry* slot = nullptr;
+  while (true) {
+    IconCacheEntry* oldest = nullptr;
+    slot = nullptr;
+    for (uint8_t i = 0; i < ICON_CACHE_SLOTS; i++) {
+      IconCacheEntry& entry = cache.entries[i];
+      if (entry.bits == nullptr) {
+        slot = &entry;
+      } else if (oldest == nullptr || entry.lastUse < oldest->lastUse) {
+        oldest = &entry;
+      }
+    }
+    if (slot != nullptr && cache.used + size <= cache.budget) {
+      break;
+    }
+    // Out of slots or over budget, oldest can't be null here because an
+    // empty cache always has both
+    freeEntry(cache, *oldest);
+    cache.evictions++;
+  }
+
+  slot->bits = (uint8_t*)malloc(size);
+  if (slot->bits == nullptr) {
+    return nullptr;
+  }
+  strcpy(slot->key, key);
+  slot->width = width;
+  slot->height = height;
+  slot->size = size;
+  slot->lastUse = ++cache.clock;
+  cache.used += size;
+  return slot;
+}
+
+void removeIcon(IconCache& cache, const char* key) {
+  for (uint8_t i = 0; i < ICON_CACHE_SLOTS; i++) {
+    IconCacheEntry& entry = cache.entries[i];
+    if (entry.bits != nullptr && strcmp(entry.key, key) == 0) {
+      freeEntry(cache, entry);
+      return;
+    }
+  }
+}
+
+void clearIconCache(IconCache& cache) {
+  for (uint8_t i = 0; i < ICON_CACHE_SLOTS; i++) {
+    if (cache.entries[i].bits != nullptr) {
+      freeEntry(cache, cache.entries[i]);
+    }
+  }
+}
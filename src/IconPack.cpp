@@ -0,0 +1,54 @@
+#include "IconPack.h"
+
+#include <string.h>
+
+uint32_t iconPackHash(const char* path) {
+  uint32_t hash = 2166136261u;
+  for (; *path != '\0'; path++) {
+    hash = (hash ^ (uint8_t)*path) * 16777619u;
+  }
+  return hash;
+}
+
+const IconPackEntry* findPackEntry(const IconPackEntry* index, uint16_t count,
+                                   uint32_t hash) {
+  uint16_t low = 0;
+  uint16_t high = count;
+  while (low < high) {
+    const uint16_t mid = low + (high - low) / 2;
+    if (index[mid].hash < hash) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low < count && index[low].hash == hash ? &index[low] : nullptr;
+}
+
+// A control byte n below 128 is followed by n + 1 literal bytes, above 128
+// by one byte repeated 257 - n times, and 128 is skipped
+bool unpackRle(const uint8_t* in, uint32_t inSize, uint8_t* out,
+               uint32_t outSize) {
+  uint32_t i = 0;
+  uint32_t o = 0;
+  while (i < inSize) {
+    const uint8_t control = in[i++];
+    if (control < 128) {
+      const uint32_t length = control + 1;
+      if (i + length > inSize || o + length > outSize) {
+        return false;
+      }
+      memcpy(out + o, in + i, length);
+      i += length;
+      o += length;
+    } else if (control > 128) {
+      const uint32_t length = 257 - control;
+      if (i >= inSize || o + length > outSize) {
+        return false;
+      }
+      memset(out + o, in[i++], length);
+      o += length;
+    }
+  }
+  return o == outSize;
+}
@@ -0,0 +1,30 @@
+#include "RetryPolicy.h"
+
+void recordAttempt(RetryState& state) {
+  state.totalAttempts++;
+}
+
+void recordSuccess(RetryState& state) {
+  state.consecutiveFailures = 0;
+  state.lastBackoff = 0;
+}
+
+uint32_t recordFailure(RetryState& state, const RetryPolicy& policy,
+                       uint8_t failStage, uint32_t randomValue) {
+  state.consecutiveFailures++;
+  state.totalFailures++;
+  state.lastFailStage = failStage;
+
+  uint32_t window = policy.baseDelay;
+  for (uint16_t i = 1;
+       i < state.consecutiveFailures && window < policy.maxDelay; i++) {
+    window *= 2;
+  }
+  if (window > policy.maxDelay) {
+    window = policy.maxDelay;
+  }
+
+  const uint32_t half = window / 2;
+  state.lastBackoff = half + (half > 0 ? randomValue % (half + 1) : 0);
+  return state.lastBackoff;
+}
@@ -0,0 +1,730 @@
+#include "Screen.h"
+
+#include <Arduino.h>
+#include <BmpHeader.h>
+#include <Fingerprint.h>
+#include <FontMetrics.h>
+#include <Fonts/FreeMono12pt7b.h>
+#include <Fonts/FreeMono18pt7b.h>
+#include <Fonts/FreeMono24pt7b.h>
+#include <Fonts/FreeMono9pt7b.h>
+#include <IconPack.h>
+#include <SPIFFS.h>
+
+FrameCanvas canvas;
+DrawList screen;
+#ifdef USE_GLYPH_CACHE
+GlyphCache glyphCache;
+#endif
+#ifndef USE_ICON_ATLAS
+IconCache iconCache;
+static fs::File iconPack;
+static IconPackEntry* iconPackIndex = nullptr;
+static uint16_t iconPackCount = 0;
+#endif
+
+const GFXfont* const FONT_9PT = &FreeMono9pt7b;
+const GFXfont* const FONT_12PT = &FreeMono12pt7b;
+const GFXfont* const FONT_18PT = &FreeMono18pt7b;
+const GFXfont* const FONT_24PT = &FreeMono24pt7b;
+
+void FrameCanvas::begin(uint16_t width, uint16_t height, uint16_t pageHeight,
+                        uint8_t* black, uint8_t* color) {
+  WIDTH = width;
+  HEIGHT = height;
+  setRotation(getRotation());
+  this->pageHeight = pageHeight;
+  this->black = black;
+  this->color = color;
+  top = 0;
+}
+
+FrameTarget FrameCanvas::target(bool colorPlane) const {
+  const uint16_t rows =
+      HEIGHT - top < pageHeight ? HEIGHT - top : pageHeight;
+  const FrameTarget plane = {colorPlane ? color : black,
+                             (uint16_t)WIDTH,
+                             (uint16_t)HEIGHT,
+                             getRotation(),
+                             top,
+                             rows};
+  return plane;
+}
+
+void FrameCanvas::drawPixel(int16_t x, int16_t y, uint16_t c) {
+  setFramePixel(target(false), x, y, c != GxEPD_BLACK);
+  if (color != nullptr) {
+    setFramePixel(target(true), x, y, !isColored(c));
+  }
+}
+
+void FrameCanvas::fillScreen(uint16_t c) {
+  memset(black, c == GxEPD_BLACK ? 0x00 : 0xFF, planeSize());
+  if (color != nullptr) {
+    memset(color, isColored(c) ? 0x00 : 0xFF, planeSize());
+  }
+}
+
+void setFont(const GFXfont* font) {
+  screen.setFont(font);
+  canvas.setFont(font);
+}
+
+uint16_t panelColor(uint16_t color) {
+  return canvas.color != nullptr || color == GxEPD_WHITE ? color : GxEPD_BLACK;
+}
+
+void drawBits(int16_t x, int16_t y, const uint8_t* bits, uint16_t w,
+              uint16_t h, uint16_t color) {
+  const FrameTarget black = canvas.target(false);
+  if (canvas.color == nullptr) {
+    blitBitmap(black, x, y, bits, w, h);
+    return;
+  }
+  // Like GxEPD2_3C::drawPixel() a pixel is either black or colored
+  const FrameTarget colored = canvas.target(true);
+  const bool ink = color == GxEPD_BLACK;
+  blitBitmap(ink ? black : colored, x, y, bits, w, h);
+  eraseBitmap(ink ? colored : black, x, y, bits, w, h);
+}
+
+// Draws a row decoded into both planes at once, the set bits of black in
+// black and those of color in the panel's color. The two never overlap.
+static void drawPlanes(int16_t x, int16_t y, const uint8_t* black,
+                       const uint8_t* color, uint16_t w, uint16_t h) {
+  drawBits(x, y, black, w, h);
+  if (canvas.color != nullptr) {
+    drawBits(x, y, color, w, h, ACCENT_COLOR);
+  }
+}
+
+// Maps a row of 1bpp pixels to drawBitmap() bits a whole byte at a time,
+// drawn0 and drawn1 are 0xFF when that palette entry is drawn in black
+static void decodeMonoRow(const uint8_t* in, uint8_t* out, uint16_t bytes,
+                          uint8_t drawn0, uint8_t drawn1) {
+  for (uint16_t i = 0; i < bytes; i++) {
+    out[i] = (in[i] & drawn1) | (~in[i] & drawn0);
+  }
+}
+
+// Generic path of drawBitmapFromSpiffs(), every supported depth decoded pixel
+// by pixel through the palette. Each row is decoded into the black and the
+// color plane in one pass, colored pixels are only drawn in color on three
+// color panels. input_buffer is the read buffer of the caller, returns the
+// SPIFFS calls taken
+static uint32_t drawBitmapPixels(fs::File& file, const BmpHeader& header,
+                                 const uint8_t* headerBuffer,
+                                 uint16_t headerBytes, int16_t x, int16_t y,
+                                 uint16_t w, uint16_t h, bool with_color,
+                                 uint8_t* input_buffer, uint16_t input_size) {
+  static const uint16_t max_row_width =
+      1872; // for up to 7.8" display 1872x1404
+  static const uint16_t max_palette_pixels = 256; // for depth <= 8
+
+  uint8_t output_row_mono_buffer[max_row_width /
+                                 8]; // buffer for at least one row of b/w bits
+  uint8_t output_row_color_buffer[max_row_width / 8]; // buffer for at least one
+                                                      // row of color bits
+  uint8_t mono_palette_buffer[max_palette_pixels /
+                              8]; // palette buffer for depth <= 8 b/w
+  uint8_t color_palette_buffer[max_palette_pixels /
+                               8]; // palette buffer for depth <= 8 c/w
+
+  const uint32_t imageOffset = header.imageOffset;
+  const uint32_t height = header.height;
+  const uint32_t rowSize = header.rowSize;
+  const uint16_t depth = header.depth;
+  const uint32_t format = header.format;
+  const bool flip = header.flip;
+  uint32_t spiffsCalls = 0;
+  uint8_t bitmask = 0xFF;
+  uint8_t bitshift = 8 - depth;
+  uint16_t red, green, blue;
+  bool whitish = false;
+  bool colored = false;
+  if (depth == 1)
+    with_color = false;
+  if (depth <= 8) {
+    if (depth < 8)
+      bitmask >>= depth;
+    // The 1bpp palette came with the header, bigger ones take one read
+    const uint8_t* palette = headerBuffer + header.paletteOffset;
+    if (header.paletteOffset + header.paletteSize > headerBytes) {
+      file.seek(header.paletteOffset);
+      file.read(input_buffer, header.paletteSize);
+      spiffsCalls += 2;
+      palette = input_buffer;
+    }
+    for (uint16_t pn = 0; pn < (1 << depth); pn++) {
+      blue = palette[pn * 4];
+      green = palette[pn * 4 + 1];
+      red = palette[pn * 4 + 2];
+      whitish = with_color ? ((red > 0x80) && (green > 0x80) && (blue > 0x80))
+                           : ((red + green + blue) > 3 * 0x80); // whitish
+      colored = (red > 0xF0) ||
+                ((green > 0xF0) && (blue > 0xF0)); // reddish or yellowish?
+      if (0 == pn % 8)
+        mono_palette_buffer[pn / 8] = 0;
+      mono_palette_buffer[pn / 8] |= whitish << pn % 8;
+      if (0 == pn % 8)
+        color_palette_buffer[pn / 8] = 0;
+      color_palette_buffer[pn / 8] |= colored << pn % 8;
+    }
+  }
+  uint32_t rowPosition =
+      flip ? imageOffset + (height - h) * rowSize : imageOffset;
+  for (uint16_t row = 0; row < h;
+       row++, rowPosition += rowSize) // for each line
+  {
+    uint32_t in_remain = rowSize;
+    uint32_t in_idx = 0;
+    uint32_t in_bytes = 0;
+    uint8_t in_byte = 0;           // for depth <= 8
+    uint8_t in_bits = 0;           // for depth <= 8
+    uint8_t out_byte = 0xFF;       // white (for w%8!=0 border)
+    uint8_t out_color_byte = 0x00; // none (for w%8!=0 border)
+    uint32_t out_idx = 0;
+    file.seek(rowPosition);
+    spiffsCalls++;
+    for (uint16_t col = 0; col < w; col++) // for each pixel
+    {
+      // Time to read more pixel data?
+      if (in_idx >= in_bytes) // ok, exact match for 24bit also (size IS
+                              // multiple of 3)
+      {
+        in_bytes = file.read(input_buffer,
+                             in_remain > input_size ? input_size : in_remain);
+        spiffsCalls++;
+        in_remain -= in_bytes;
+        in_idx = 0;
+      }
+      switch (depth) {
+        case 32:
+          blue = input_buffer[in_idx++];
+          green = input_buffer[in_idx++];
+          red = input_buffer[in_idx++];
+          in_idx++; // skip alpha
+          whitish = with_color
+                        ? ((red > 0x80) && (green > 0x80) && (blue > 0x80))
+                        : ((red + green + blue) > 3 * 0x80); // whitish
+          colored = (red > 0xF0) ||
+                    ((green > 0xF0) && (blue > 0xF0)); // reddish or yellowish?
+          break;
+        case 24:
+          blue = input_buffer[in_idx++];
+          green = input_buffer[in_idx++];
+          red = input_buffer[in_idx++];
+          whitish = with_color
+                        ? ((red > 0x80) && (green > 0x80) && (blue > 0x80))
+                        : ((red + green + blue) > 3 * 0x80); // whitish
+          colored = (red > 0xF0) ||
+                    ((green > 0xF0) && (blue > 0xF0)); // reddish or yellowish?
+          break;
+        case 16: {
+          uint8_t lsb = input_buffer[in_idx++];
+          uint8_t msb = input_buffer[in_idx++];
+          if (format == 0) // 555
+          {
+            blue = (lsb & 0x1F) << 3;
+            green = ((msb & 0x03) << 6) | ((lsb & 0xE0) >> 2);
+            red = (msb & 0x7C) << 1;
+          } else // 565
+          {
+            blue = (lsb & 0x1F) << 3;
+            green = ((msb & 0x07) << 5) | ((lsb & 0xE0) >> 3);
+            red = (msb & 0xF8);
+          }
+          whitish = with_color
+                        ? ((red > 0x80) && (green > 0x80) && (blue > 0x80))
+                        : ((red + green + blue) > 3 * 0x80); // whitish
+          colored = (red > 0xF0) ||
+                    ((green > 0xF0) && (blue > 0xF0)); // reddish or yellowish?
+        } break;
+        case 1:
+        case 2:
+        case 4:
+        case 8: {
+          if (0 == in_bits) {
+            in_byte = input_buffer[in_idx++];
+            in_bits = 8;
+          }
+          uint16_t pn = (in_byte >> bitshift) & bitmask;
+          whitish = mono_palette_buffer[pn / 8] & (0x1 << pn % 8);
+          colored = color_palette_buffer[pn / 8] & (0x1 << pn % 8);
+          in_byte <<= depth;
+          in_bits -= depth;
+        } break;
+      }
+      if (whitish) {
+        // keep white
+      } else if (colored && with_color) {
+        out_byte &= ~(0x80 >> col % 8);    // not black
+        out_color_byte |= 0x80 >> col % 8; // colored
+      } else {
+        out_byte &= ~(0x80 >> col % 8); // black
+      }
+      if ((7 == col % 8) ||
+          (col == w - 1)) // write that last byte! (for w%8!=0 border)
+      {
+        output_row_color_buffer[out_idx] = out_color_byte;
+        output_row_mono_buffer[out_idx++] = out_byte;
+        out_byte = 0xFF;       // white (for w%8!=0 border)
+        out_color_byte = 0x00; // none (for w%8!=0 border)
+      }
+    } // end pixel
+    uint16_t yrow = y + (flip ? h - row - 1 : row);
+    drawPlanes(x, yrow, output_row_mono_buffer, output_row_color_buffer, w, 1);
+  } // end line
+  return spiffsCalls;
+}
+
+// The whitish rule of drawBitmapPixels() without color for a palette entry
+static bool whitishEntry(const uint8_t* entry) {
+  return entry[0] + entry[1] + entry[2] > 3 * 0x80;
+}
+
+// https://github.com/ZinggJM/GxEPD2/blob/master/examples/GxEPD2_Spiffs_Example/GxEPD2_Spiffs_Example.ino#L245
+// 1bpp bitmaps that fit the read buffer take the fast path, the rest go
+// through drawBitmapPixels()
+void drawBitmapFromSpiffs(const char* filename, int16_t x, int16_t y,
+                          bool with_color) {
+  static const uint16_t input_buffer_pixels = 800; // may affect performance
+
+  static const uint16_t max_row_width =
+      1872; // for up to 7.8" display 1872x1404
+
+  uint8_t input_buffer[3 * input_buffer_pixels]; // up to depth 24
+  uint8_t output_row_mono_buffer[max_row_width /
+                                 8]; // buffer for at least one row of b/w bits
+
+  fs::File file;
+  bool valid = false; // valid format to be handled
+  bool flip = true;   // bitmap is stored bottom-to-top
+  uint32_t startTime = millis();
+  const FrameTarget panel = canvas.target(false);
+  if ((x >= panel.width) || (y >= panel.height))
+    return;
+  Serial.println();
+  Serial.print("Loading image '");
+  Serial.print(filename);
+  Serial.println('\'');
+  file = SPIFFS.open(filename, "r");
+  if (!file) {
+    Serial.println("File not found");
+    return;
+  } else {
+    Serial.println("Opened file successfully");
+  }
+  // Parse the BMP header, and a 1bpp palette with it, from a single read
+  uint32_t spiffsCalls = 2; // open and header read
+  uint8_t headerBuffer[BMP_HEADER_READ];
+  const uint16_t headerBytes = file.read(headerBuffer, sizeof(headerBuffer));
+  BmpHeader header;
+  const uint8_t headerStatus =
+      parseBmpHeader(headerBuffer, headerBytes, header);
+  Serial.print("Magic number: 0x");
+  Serial.println(headerBuffer[0] | headerBuffer[1] << 8, HEX);
+  if (headerStatus != BMP_NOT_A_BITMAP) // BMP signature
+  {
+    const uint32_t fileSize = header.fileSize;
+    const uint32_t imageOffset = header.imageOffset; // Start of image data
+    const uint32_t headerSize = header.headerSize;
+    const uint32_t width = header.width;
+    const uint32_t height = header.height;
+    const uint16_t planes = header.planes;
+    const uint16_t depth = header.depth; // bits per pixel
+    const uint32_t format = header.format;
+    flip = header.flip;
+    if (headerStatus == BMP_OK) // uncompressed is handled, 565 also
+    {
+      Serial.print("File size: ");
+      Serial.println(fileSize);
+      Serial.print("Image Offset: ");
+      Serial.println(imageOffset);
+      Serial.print("Header size: ");
+      Serial.println(headerSize);
+      Serial.print("Bit Depth: ");
+      Serial.println(depth);
+      Serial.print("Image size: ");
+      Serial.print(width);
+      Serial.print('x');
+      Serial.println(height);
+      // BMP rows are padded (if needed) to 4-byte boundary
+      const uint32_t rowSize = header.rowSize;
+      uint16_t w = width;
+      uint16_t h = height;
+      if ((x + w - 1) >= panel.width)
+        w = panel.width - x;
+      if ((y + h - 1) >= panel.height)
+        h = panel.height - y;
+      if (w <= max_row_width) // handle with direct drawing
+      {
+        valid = true;
+        if (depth == 1 && rowSize * h <= sizeof(input_buffer) &&
+            header.paletteOffset + header.paletteSize <= headerBytes) {
+          // 1bpp fast path: the palette came with the header, one read for
+          // the whole pixel array, then whole bytes per row through the two
+          // palette entries
+          const uint8_t* palette = headerBuffer + header.paletteOffset;
+          const uint8_t drawn0 = whitishEntry(palette) ? 0xFF : 0x00;
+          const uint8_t drawn1 = whitishEntry(palette + 4) ? 0xFF : 0x00;
+          const uint32_t pixelBytes = rowSize * h;
+          file.seek(flip ? imageOffset + (height - h) * rowSize : imageOffset);
+          valid = file.read(input_buffer, pixelBytes) == pixelBytes;
+          spiffsCalls += 2;
+          for (uint16_t row = 0; valid && row < h; row++) {
+            decodeMonoRow(input_buffer + row * rowSize, output_row_mono_buffer,
+                          (w + 7) / 8, drawn0, drawn1);
+            uint16_t yrow = y + (flip ? h - row - 1 : row);
+            drawBits(x, yrow, output_row_mono_buffer, w, 1);
+          }
+        } else {
+          spiffsCalls += drawBitmapPixels(file, header, headerBuffer,
+                                          headerBytes, x, y, w, h, with_color,
+                                          input_buffer, sizeof(input_buffer));
+        }
+        Serial.print("loaded in ");
+        Serial.print(millis() - startTime);
+        Serial.print(" ms, ");
+        Serial.print(spiffsCalls);
+        Serial.println(" SPIFFS calls");
+      }
+    } else {
+      Serial.println("Invalid bitmap format and plane count");
+      Serial.print("planes: ");
+      Serial.println(planes);
+      Serial.print("format: ");
+      Serial.println(format);
+    }
+  } else {
+    Serial.println("Not a bitmap");
+  }
+  file.close();
+  if (!valid) {
+    Serial.println("bitmap format not handled.");
+  }
+}
+
+void drawBitmapFromSpiffs(const char* filename, int16_t x, int16_t y) {
+  drawBitmapFromSpiffs(filename, x, y, canvas.color != nullptr);
+}
+
+#ifndef USE_ICON_ATLAS
+static bool openIconPack() {
+  iconPack = SPIFFS.open(ICON_PACK_PATH, "r");
+  if (!iconPack) {
+    Serial.println("No icon pack, drawing icons from their bitmaps");
+    return false;
+  }
+  IconPackHeader header;
+  if (iconPack.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+      header.magic != ICON_PACK_MAGIC || header.version != ICON_PACK_VERSION) {
+    Serial.println("Icon pack invalid");
+    iconPack.close();
+    return false;
+  }
+  const size_t indexSize = header.count * sizeof(IconPackEntry);
+  iconPackIndex = (IconPackEntry*)malloc(indexSize);
+  if (iconPackIndex == nullptr ||
+      iconPack.read((uint8_t*)iconPackIndex, indexSize) != indexSize) {
+    Serial.println("Failed to read icon pack index");
+    free(iconPackIndex);
+    iconPackIndex = nullptr;
+    iconPack.close();
+    return false;
+  }
+  iconPackCount = header.count;
+  Serial.print("Opened icon pack with ");
+  Serial.print(iconPackCount);
+  Serial.println(" icons");
+  return true;
+}
+
+// Decodes an icon from the pack into the icon cache, nullptr when it isn't
+// in the pack or doesn't fit in the cache
+static const IconCacheEntry* loadPackedIcon(const char* path) {
+  static bool packOpened = false;
+  if (!packOpened) {
+    packOpened = true;
+    openIconPack();
+  }
+  if (iconPackIndex == nullptr) {
+    return nullptr;
+  }
+  const IconPackEntry* packed =
+      findPackEntry(iconPackIndex, iconPackCount, iconPackHash(path));
+  if (packed == nullptr) {
+    return nullptr;
+  }
+  IconCacheEntry* entry =
+      insertIcon(iconCache, path, packed->width, packed->height);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  bool valid = iconPack.seek(packed->offset);
+  if (packed->encoding == ICON_PACK_RLE) {
+    uint8_t* encoded = (uint8_t*)malloc(packed->size);
+    valid = valid && encoded != nullptr &&
+            iconPack.read(encoded, packed->size) == packed->size &&
+            unpackRle(encoded, packed->size, entry->bits, entry->size);
+    free(encoded);
+  } else {
+    valid = valid && packed->size == entry->size &&
+            iconPack.read(entry->bits, entry->size) == entry->size;
+  }
+  if (!valid) {
+    removeIcon(iconCache, path);
+    return nullptr;
+  }
+  return entry;
+}
+
+// Decodes a 1bpp BMP from SPIFFS into the icon cache, other formats and
+// icons that don't fit in the cache return nullptr
+static const IconCacheEntry* loadIcon(const char* filename) {
+  fs::File file = SPIFFS.open(filename, "r");
+  if (!file) {
+    return nullptr;
+  }
+  const IconCacheEntry* result = nullptr;
+  uint8_t headerBuffer[BMP_HEADER_READ];
+  const uint16_t headerBytes = file.read(headerBuffer, sizeof(headerBuffer));
+  BmpHeader header;
+  if (parseBmpHeader(headerBuffer, headerBytes, header) == BMP_OK &&
+      header.depth == 1 && header.width <= 1872 &&
+      header.paletteOffset + header.paletteSize <= headerBytes) {
+    // Set bits are drawn in black, which are the whitish palette entries
+    // like in drawBitmapFromSpiffs()
+    uint8_t drawn[2];
+    for (uint8_t i = 0; i < 2; i++) {
+      const uint8_t* color = headerBuffer + header.paletteOffset + i * 4;
+      drawn[i] = (color[0] + color[1] + color[2]) > 3 * 0x80 ? 0xFF : 0x00;
+    }
+    const uint16_t width = header.width;
+    const uint16_t height = header.height;
+    IconCacheEntry* entry = insertIcon(iconCache, filename, width, height);
+    if (entry != nullptr) {
+      const uint16_t outSize = (width + 7) / 8;
+      const uint8_t lastMask = 0xFF << ((8 - width % 8) % 8);
+      uint8_t row[1872 / 8 + 4];
+      // Rows are stored back to back, so read them in file order
+      bool valid = file.seek(header.imageOffset);
+      for (uint16_t r = 0; r < height && valid; r++) {
+        valid = file.read(row, header.rowSize) == header.rowSize;
+        const uint16_t outRow = header.flip ? height - 1 - r : r;
+        uint8_t* out = entry->bits + outRow * outSize;
+        decodeMonoRow(row, out, outSize, drawn[0], drawn[1]);
+        out[outSize - 1] &= lastMask;
+      }
+      if (valid) {
+        result = entry;
+      } else {
+        removeIcon(iconCache, filename);
+      }
+    }
+  }
+  file.close();
+  return result;
+}
+
+#endif
+
+uint16_t drawIcon(IconAsset asset, int16_t x, int16_t y) {
+#ifdef USE_ICON_ATLAS
+  const IconBitmap& icon = ICON_ATLAS[asset];
+  drawBits(x, y, icon.bits, icon.width, icon.height);
+  return icon.height;
+#else
+  const char* path = ICON_ASSET_PATHS[asset];
+  const IconCacheEntry* icon = findIcon(iconCache, path);
+  if (icon == nullptr) {
+    icon = loadPackedIcon(path);
+  }
+  if (icon == nullptr) {
+    icon = loadIcon(path);
+  }
+  if (icon != nullptr) {
+    drawBits(x, y, icon->bits, icon->width, icon->height);
+    return icon->height;
+  }
+  drawBitmapFromSpiffs(path, x, y);
+  return 0;
+#endif
+}
+
+// Adafruit_GFX has no getters for the text settings print() draws with
+struct TextState : Adafruit_GFX {
+  static const GFXfont* font(const Adafruit_GFX& gfx) {
+    return gfx.*(&TextState::gfxFont);
+  }
+  static uint16_t color(const Adafruit_GFX& gfx) {
+    return gfx.*(&TextState::textcolor);
+  }
+  // Wrapped black or colored text at size 1, which is how every screen prints
+  static bool plain(const Adafruit_GFX& gfx) {
+    return gfx.*(&TextState::textsize_x) == 1 &&
+           gfx.*(&TextState::textsize_y) == 1 &&
+           gfx.*(&TextState::textcolor) != GxEPD_WHITE &&
+           gfx.*(&TextState::wrap);
+  }
+};
+
+#ifdef USE_GLYPH_CACHE
+// Blits the characters from the glyph cache, wrapping and moving the cursor
+// like Adafruit_GFX::write()
+static void blitText(const GFXfont* font, const uint8_t* text,
+                     uint16_t length) {
+  const uint16_t color = TextState::color(canvas);
+  int16_t x = canvas.getCursorX();
+  int16_t y = canvas.getCursorY();
+  for (uint16_t i = 0; i < length; i++) {
+    const uint8_t c = text[i];
+    if (c == '\n') {
+      x = 0;
+      y += font->yAdvance;
+    } else if (c != '\r' && c >= font->first && c <= font->last) {
+      const GFXglyph& glyph = font->glyph[c - font->first];
+      if (glyph.width > 0 && glyph.height > 0) {
+        if (x + glyph.xOffset + glyph.width > canvas.width()) {
+          x = 0;
+          y += font->yAdvance;
+        }
+        const uint8_t* rows = glyphRows(glyphCache, font, c);
+        if (rows != nullptr) {
+          drawBits(x + glyph.xOffset, y + glyph.yOffset, rows, glyph.width,
+                   glyph.height, color);
+        } else {
+          canvas.drawChar(x, y, c, color, GxEPD_WHITE, 1);
+        }
+      }
+      x += glyph.xAdvance;
+    }
+  }
+  canvas.setCursor(x, y);
+}
+#endif
+
+void drawText(const uint8_t* text, uint16_t length) {
+#ifdef USE_GLYPH_CACHE
+  const GFXfont* font = TextState::font(canvas);
+  if (font != nullptr && glyphCache.budget > 0 && TextState::plain(canvas)) {
+    blitText(font, text, length);
+    return;
+  }
+#endif
+  canvas.write(text, length);
+}
+
+// Draws the recorded screen into the current page on a white background.
+// Icons entirely above or below the page are skipped, their height is only
+// known after the first page they were drawn on.
+void replayScreen() {
+  const int16_t pageBottom = canvas.top + canvas.pageHeight;
+  canvas.fillScreen(GxEPD_WHITE);
+  canvas.setTextColor(GxEPD_BLACK);
+  for (uint8_t i = 0; i < screen.count; i++) {
+    DrawOp& op = screen.ops[i];
+    switch (op.type) {
+    case DRAW_FONT:
+      canvas.setFont(op.font);
+      break;
+    case DRAW_COLOR:
+      canvas.setTextColor(panelColor(op.color));
+      break;
+    case DRAW_CURSOR:
+      canvas.setCursor(op.x, op.y);
+      break;
+    case DRAW_TEXT:
+      drawText((const uint8_t*)screen.text + op.text, op.length);
+      break;
+    case DRAW_ICON:
+      if (op.y < pageBottom && (op.h == 0 || op.y + op.h > canvas.top)) {
+        op.h = drawIcon((IconAsset)op.icon, op.x, op.y);
+      }
+      break;
+    }
+  }
+}
+
+// Metrics generated by tools/gen_font_metrics.py, nullptr for other fonts
+static const FontMetrics* fontMetrics(const GFXfont* font) {
+  if (font == &FreeMono9pt7b) {
+    return &FreeMono9pt7bMetrics;
+  } else if (font == &FreeMono12pt7b) {
+    return &FreeMono12pt7bMetrics;
+  } else if (font == &FreeMono18pt7b) {
+    return &FreeMono18pt7bMetrics;
+  } else if (font == &FreeMono24pt7b) {
+    return &FreeMono24pt7bMetrics;
+  }
+  return nullptr;
+}
+
+// Longest text getTextBounds() results are kept for, with its terminator
+const uint8_t TEXT_BOUNDS_LENGTH = 48;
+
+struct TextBounds {
+  bool valid;
+  const GFXfont* font;
+  uint32_t hash;
+  uint16_t length;
+  char text[TEXT_BOUNDS_LENGTH];
+  uint16_t w;
+  uint16_t h;
+};
+
+// getTextBounds() results for text the font metrics don't cover, replaced
+// round robin. The hash only finds the slot, the text is compared too.
+const uint8_t TEXT_BOUNDS_SLOTS = 8;
+static TextBounds textBoundsCache[TEXT_BOUNDS_SLOTS];
+static uint8_t textBoundsNext = 0;
+
+static const TextBounds& measureText(const char* text) {
+  const GFXfont* font = TextState::font(canvas);
+  const size_t length = strlen(text);
+  Fingerprint key;
+  addBytes(key, text, length);
+  for (const TextBounds& bounds : textBoundsCache) {
+    if (bounds.valid && bounds.font == font && bounds.hash == key.hash &&
+        bounds.length == length && memcmp(bounds.text, text, length) == 0) {
+      return bounds;
+    }
+  }
+  int16_t tx, ty;
+  if (length >= TEXT_BOUNDS_LENGTH) {
+    // Too long to keep, measured every time
+    static TextBounds uncached;
+    canvas.getTextBounds(text, 0, 0, &tx, &ty, &uncached.w, &uncached.h);
+    return uncached;
+  }
+  TextBounds& bounds = textBoundsCache[textBoundsNext];
+  textBoundsNext = (textBoundsNext + 1) % TEXT_BOUNDS_SLOTS;
+  bounds.valid = true;
+  bounds.font = font;
+  bounds.hash = key.hash;
+  bounds.length = length;
+  memcpy(bounds.text, text, length + 1);
+  canvas.getTextBounds(text, 0, 0, &tx, &ty, &bounds.w, &bounds.h);
+  return bounds;
+}
+
+// The metrics only measure a single line that doesn't wrap at the edge
+static const FontMetrics* metricsFor(const char* text) {
+  const FontMetrics* metrics = fontMetrics(TextState::font(canvas));
+  if (metrics == nullptr || strchr(text, '\n') != nullptr ||
+      textRight(*metrics, text) >= canvas.width()) {
+    return nullptr;
+  }
+  return metrics;
+}
+
+uint16_t getWidthOfText(const char* text) {
+  const FontMetrics* metrics = metricsFor(text);
+  return metrics != nullptr ? textWidth(*metrics, text) : measureText(text).w;
+}
+
+uint16_t getHeightOfText(const char* text) {
+  const FontMetrics* metrics = metricsFor(text);
+  return metrics != nullptr ? textHeight(*metrics, text) : measureText(text).h;
+}
+
@@ -0,0 +1,160 @@
+#include "TileDiff.h"
+
+static uint32_t hashTile(const uint8_t* buffer, uint16_t width, uint16_t x,
+                         uint16_t y, uint16_t w, uint16_t h) {
+  uint32_t hash = 2166136261u;
+  for (uint16_t row = y; row < y + h; row++) {
+    const uint8_t* bytes = buffer + (uint32_t)row * (width / 8) + x / 8;
+    for (uint16_t i = 0; i < w / 8; i++) {
+      hash = (hash ^ bytes[i]) * 16777619u;
+    }
+  }
+  return hash;
+}
+
+static int32_t rectArea(const TileRect& rect) {
+  return (int32_t)rect.w * rect.h;
+}
+
+static TileRect boundingRect(const TileRect& a, const TileRect& b) {
+  const int16_t x0 = a.x < b.x ? a.x : b.x;
+  const int16_t y0 = a.y < b.y ? a.y : b.y;
+  const int16_t x1 = a.x + a.w > b.x + b.w ? a.x + a.w : b.x + b.w;
+  const int16_t y1 = a.y + a.h > b.y + b.h ? a.y + a.h : b.y + b.h;
+  return {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+}
+
+// Pixels covered by any of the rectangles. Their edges split the panel into
+// cells that are either covered or not, with at most MAX_REFRESH_RECTS
+// rectangles there are few enough of them to check each.
+static uint32_t unionArea(const TileRect* rects, uint8_t count) {
+  int16_t xs[MAX_REFRESH_RECTS * 2];
+  int16_t ys[MAX_REFRESH_RECTS * 2];
+  uint8_t edges = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    xs[edges] = rects[i].x;
+    ys[edges++] = rects[i].y;
+    xs[edges] = rects[i].x + rects[i].w;
+    ys[edges++] = rects[i].y + rects[i].h;
+  }
+  // Insertion sort, duplicate edges just give empty cells
+  for (uint8_t i = 1; i < edges; i++) {
+    for (uint8_t j = i; j > 0 && xs[j - 1] > xs[j]; j--) {
+      const int16_t x = xs[j];
+      xs[j] = xs[j - 1];
+      xs[j - 1] = x;
+    }
+    for (uint8_t j = i; j > 0 && ys[j - 1] > ys[j]; j--) {
+      const int16_t y = ys[j];
+      ys[j] = ys[j - 1];
+      ys[j - 1] = y;
+    }
+  }
+  uint32_t area = 0;
+  for (uint8_t i = 0; i + 1 < edges; i++) {
+    for (uint8_t j = 0; j + 1 < edges; j++) {
+      for (uint8_t k = 0; k < count; k++) {
+        const TileRect& rect = rects[k];
+        if (xs[i] >= rect.x && xs[i + 1] <= rect.x + rect.w &&
+            ys[j] >= rect.y && ys[j + 1] <= rect.y + rect.h) {
+          area += (uint32_t)(xs[i + 1] - xs[i]) * (ys[j + 1] - ys[j]);
+          break;
+        }
+      }
+    }
+  }
+  return area;
+}
+
+uint8_t diffTiles(TileState& state, const uint8_t* buffer, uint16_t width,
+                  uint16_t height, TileRect* rects, uint32_t& area) {
+  if (tileCount(width, height) > MAX_TILES) {
+    // No room for the hashes, refresh everything every time
+    state.valid = false;
+    rects[0] = {0, 0, (int16_t)width, (int16_t)height};
+    area = (uint32_t)width * height;
+    return 1;
+  }
+  const uint8_t columns = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+  const uint8_t rows = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+  const bool compare =
+      state.valid && state.columns == columns && state.rows == rows;
+
+  // Runs of changed tiles per tile row, grown downwards while the run in the
+  // next row has the same columns. This can need more than
+  // MAX_REFRESH_RECTS, the extra ones are merged below.
+  const uint8_t maxOpen = MAX_REFRESH_RECTS * 4;
+  TileRect open[maxOpen];
+  uint8_t count = 0;
+  for (uint8_t row = 0; row < rows; row++) {
+    const uint16_t y = row * TILE_HEIGHT;
+    const uint16_t h = y + TILE_HEIGHT > height ? height - y : TILE_HEIGHT;
+    int16_t runStart = -1;
+    for (uint8_t column = 0; column <= columns; column++) {
+      bool changed = false;
+      if (column < columns) {
+        const uint16_t x = column * TILE_WIDTH;
+        const uint16_t w = x + TILE_WIDTH > width ? width - x : TILE_WIDTH;
+        const uint32_t hash = hashTile(buffer, width, x, y, w, h);
+        const uint16_t tile = row * columns + column;
+        changed = !compare || state.hashes[tile] != hash;
+        state.hashes[tile] = hash;
+      }
+      if (changed && runStart < 0) {
+        runStart = column;
+      } else if (!changed && runStart >= 0) {
+        const int16_t x = runStart * TILE_WIDTH;
+        const int16_t x1 = column * TILE_WIDTH > width ? width
+                                                       : column * TILE_WIDTH;
+        TileRect run = {x, (int16_t)y, (int16_t)(x1 - x), (int16_t)h};
+        runStart = -1;
+        bool extended = false;
+        for (uint8_t i = 0; i < count && !extended; i++) {
+          if (open[i].x == run.x && open[i].w == run.w &&
+              open[i].y + open[i].h == run.y) {
+            open[i].h += run.h;
+            extended = true;
+          }
+        }
+        if (!extended) {
+          if (count == maxOpen) {
+            // Fold the run into the last rectangle rather than dropping it
+            open[count - 1] = boundingRect(open[count - 1], run);
+          } else {
+            open[count++] = run;
+          }
+        }
+      }
+    }
+  }
+  state.valid = true;
+  state.columns = columns;
+  state.rows = rows;
+
+  // Every refresh call has a fixed cost, so merge the pair that adds the
+  // least area until few enough are left
+  while (count > MAX_REFRESH_RECTS) {
+    uint8_t bestA = 0;
+    uint8_t bestB = 1;
+    int32_t bestCost = INT32_MAX;
+    for (uint8_t a = 0; a < count; a++) {
+      for (uint8_t b = a + 1; b < count; b++) {
+        const int32_t cost = rectArea(boundingRect(open[a], open[b])) -
+                             rectArea(open[a]) - rectArea(open[b]);
+        if (cost < bestCost) {
+          bestCost = cost;
+          bestA = a;
+          bestB = b;
+        }
+      }
+    }
+    open[bestA] = boundingRect(open[bestA], open[bestB]);
+    open[bestB] = open[--count];
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    rects[i] = open[i];
+  }
+  area = unionArea(rects, count);
+  return count;
+}
@@ -0,0 +1,54 @@
+#include "WakeScheduler.h"
+
+// Anything further off is a wake that wasn't ours or a clock jump, not drift
+const int32_t MAX_DRIFT_PPM = 100000;
+// Clocks before this haven't been set yet
+const uint32_t MIN_VALID_TIME = 1577836800; // 2020-01-01
+
+void recordWake(WakeState& state, uint32_t actualWake) {
+  if (state.expectedWake == 0 || state.expectedWake <= state.sleepStart) {
+    return;
+  }
+  const int64_t error = (int64_t)actualWake - state.expectedWake;
+  const int64_t slept = (int64_t)state.expectedWake - state.sleepStart;
+  // Errors are whole seconds, keep the residual drift instead of noise
+  const int64_t measured = (error * 1000000 + slept / 2) / slept;
+  state.expectedWake = 0;
+  if (measured > MAX_DRIFT_PPM || measured < -MAX_DRIFT_PPM) {
+    return;
+  }
+  // The sleep was already corrected by driftPpm, so the error is residual
+  state.driftPpm += (int32_t)measured / 2;
+}
+
+void recordBootLatency(WakeState& state, uint32_t latency) {
+  if (state.bootLatency == 0) {
+    state.bootLatency = latency;
+  } else {
+    state.bootLatency = (state.bootLatency * 3 + latency) / 4;
+  }
+}
+
+uint64_t nextSleep(WakeState& state, uint32_t now, int32_t tzOffset,
+                   uint32_t interval, uint32_t minSleep) {
+  if (now < MIN_VALID_TIME || interval == 0) {
+    skipAlignment(state);
+    return (uint64_t)interval * 1000000;
+  }
+
+  const int64_t local = (int64_t)now + tzOffset;
+  const int64_t latency = (state.bootLatency + 999) / 1000;
+  int64_t boundary = (local / interval + 1) * interval;
+  while (boundary - latency < local + minSleep) {
+    boundary += interval;
+  }
+  const uint32_t sleep = boundary - latency - local;
+
+  state.sleepStart = now;
+  state.expectedWake = now + sleep;
+  return (uint64_t)sleep * 1000000 * 1000000 / (1000000 + state.driftPpm);
+}
+
+void skipAlignment(WakeState& state) {
+  state.expectedWake = 0;
+}
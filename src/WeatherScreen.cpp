@@ -0,0 +1,294 @@
+#include "WeatherScreen.h"
+
+#include <Arduino.h>
+#include <Fingerprint.h>
+#include <FontMetrics.h>
+#include <Screen.h>
+
+const char* daysOfTheWeek[8] = {"???", "Sun", "Mon", "Tue",
+                                "Wed", "Thu", "Fri", "Sat"};
+
+IconAsset getMeteoconIcon(uint16_t id, bool nightVersion) {
+  if (nightVersion && id / 100 == 8)
+    id += 1000;
+
+  if (id / 100 == 2)
+    return ICON_THUNDERSTORM;
+  if (id / 100 == 3)
+    return ICON_DRIZZLE;
+  if (id / 100 == 4)
+    return ICON_UNKNOWN;
+  if (id == 500)
+    return ICON_LIGHT_RAIN;
+  else if (id == 511)
+    return ICON_SLEET;
+  else if (id / 100 == 5)
+    return ICON_RAIN;
+  if (id >= 611 && id <= 616)
+    return ICON_SLEET;
+  else if (id / 100 == 6)
+    return ICON_SNOW;
+  if (id / 100 == 7)
+    return ICON_FOG;
+  if (id == 800)
+    return ICON_CLEAR_DAY;
+  if (id == 801)
+    return ICON_PARTLY_CLOUDY_DAY;
+  if (id == 802)
+    return ICON_CLOUDY;
+  if (id == 803)
+    return ICON_CLOUDY;
+  if (id == 804)
+    return ICON_CLOUDY;
+  if (id == 1800)
+    return ICON_CLEAR_NIGHT;
+  if (id == 1801)
+    return ICON_PARTLY_CLOUDY_NIGHT;
+  if (id == 1802)
+    return ICON_CLOUDY;
+  if (id == 1803)
+    return ICON_CLOUDY;
+  if (id == 1804)
+    return ICON_CLOUDY;
+
+  return ICON_UNKNOWN;
+}
+
+uint16_t temperatureColor(float t, bool imperial) {
+  const float celsius = imperial ? (t - 32) / 1.8 : t;
+  return celsius <= FREEZING_TEMP || celsius >= HOT_TEMP ? ACCENT_COLOR
+                                                         : GxEPD_BLACK;
+}
+
+uint16_t printTemperature(float t, bool imperial, uint16_t x, uint16_t y) {
+  uint16_t totalWidth = 0;
+  const String temp = String(t, 0);
+  screen.setTextColor(temperatureColor(t, imperial));
+  setFont(FONT_18PT);
+  screen.setCursor(x, y);
+  screen.print(temp.c_str());
+  uint16_t tw = getWidthOfText(temp.c_str());
+  totalWidth += tw + 2;
+  setFont(FONT_9PT);
+  const uint16_t nx = x + tw + 6;
+  const uint16_t ny = y - 10;
+  screen.setCursor(nx, ny);
+  screen.print(imperial ? "oF" : "oC");
+  tw = getWidthOfText(temp.c_str());
+  totalWidth += tw + 4;
+  screen.setTextColor(GxEPD_BLACK);
+  return totalWidth;
+}
+
+// The alert, or without one the battery state, right of the humidity
+static const char* statusText(const WeatherView& view) {
+  if (view.alert[0] != '\0') {
+    return view.alert;
+  }
+  return view.battery == BATTERY_CHARGING
+             ? "Charging"
+             : (view.battery == BATTERY_LOW ? "Battery low" : "");
+}
+
+static uint16_t statusColor(const WeatherView& view) {
+  return view.alert[0] != '\0' || view.battery == BATTERY_LOW ? ACCENT_COLOR
+                                                              : GxEPD_BLACK;
+}
+
+static void addTemperature(Fingerprint& f, float t, bool imperial) {
+  addInt(f, temperatureColor(t, imperial));
+}
+
+uint32_t weatherFingerprint(const WeatherView& view) {
+  Fingerprint f;
+  addString(f, view.name);
+  addString(f, view.state);
+  addString(f, view.country);
+  addInt(f, view.imperial);
+  addString(f, view.main);
+  addInt(f, view.icon);
+  addString(f, String(view.temp, 0).c_str());
+  addString(f, String(view.tempMin, 0).c_str());
+  addString(f, String(view.tempMax, 0).c_str());
+  addTemperature(f, view.temp, view.imperial);
+  addTemperature(f, view.tempMin, view.imperial);
+  addTemperature(f, view.tempMax, view.imperial);
+  addInt(f, view.humidity);
+  addString(f, statusText(view));
+  addInt(f, statusColor(view));
+  for (const WeatherHour& hour : view.hours) {
+    addInt(f, hour.hour * 60 + hour.minute);
+    addInt(f, (int16_t)hour.temp);
+    addTemperature(f, hour.temp, view.imperial);
+    addInt(f, hour.icon);
+  }
+  for (const WeatherDay& day : view.days) {
+    addInt(f, day.weekday);
+    addInt(f, (int16_t)round(day.tempMin));
+    addInt(f, (int16_t)round(day.tempMax));
+    addTemperature(f, day.tempMin, view.imperial);
+    addTemperature(f, day.tempMax, view.imperial);
+    addInt(f, day.icon);
+  }
+  return f.hash;
+}
+
+void drawWeather(const WeatherView& view) {
+  screen.clear();
+  screen.drawIcon(view.icon, 2, 2);
+
+  setFont(FONT_9PT);
+  screen.setCursor(103, 21);
+  screen.print(view.name);
+  screen.print(", ");
+  screen.print(view.state);
+  screen.print(", ");
+  screen.print(view.country);
+
+  uint16_t currY = 53;
+  uint16_t currX = 100;
+
+  screen.setCursor(currX, currY);
+  setFont(strlen(view.main) > 10 ? FONT_18PT : FONT_24PT);
+  screen.print(view.main);
+  currY += getHeightOfText(view.main) + 6;
+
+  currX += printTemperature(view.temp, view.imperial, currX, currY);
+  setFont(FONT_18PT);
+  screen.setCursor(currX, currY);
+  screen.print(" (");
+  constexpr uint16_t openWidth = textWidth(FreeMono18pt7bMetrics, " (");
+  currX += openWidth;
+  currX += printTemperature(view.tempMin, view.imperial, currX, currY);
+  setFont(FONT_18PT);
+  screen.setCursor(currX, currY);
+  screen.print("-");
+  constexpr uint16_t dashWidth = textWidth(FreeMono18pt7bMetrics, "-");
+  currX += dashWidth + 2;
+  currX += printTemperature(view.tempMax, view.imperial, currX, currY);
+  setFont(FONT_18PT);
+  screen.setCursor(currX, currY);
+  screen.print(")");
+  constexpr uint16_t closeWidth = textWidth(FreeMono18pt7bMetrics, ")");
+  currX += closeWidth;
+
+  // The label is the only part of the screen that never moves, everything
+  // else follows the data. Starting from a pre-rasterized background instead
+  // of fillScreen() doesn't pay: coded with FrameCodec (337 bytes) it decodes
+  // ten times slower than drawing the label, raw it costs a whole frame of
+  // memory for the 2 us the label takes.
+  currX = 2;
+  setFont(FONT_12PT);
+  screen.setCursor(currX, 114);
+  screen.print("Humidity: ");
+  screen.print(view.humidity);
+  screen.print("%");
+
+  // Alerts too wide for the 12 pt font next to the longest humidity are
+  // drawn in 9 pt, and cut when they don't fit that either
+  char status[48];
+  snprintf(status, sizeof(status), "%s", statusText(view));
+  constexpr uint16_t marginWidth = textWidth(FreeMono12pt7bMetrics, "#");
+  constexpr uint16_t humidityWidth =
+      textWidth(FreeMono12pt7bMetrics, "Humidity: 100% ");
+  const uint16_t space = canvas.width() - humidityWidth - marginWidth - 4;
+  const bool small = textWidth(FreeMono12pt7bMetrics, status) > space;
+  if (small) {
+    size_t length = strlen(status);
+    while (length > 0 && textWidth(FreeMono9pt7bMetrics, status) > space) {
+      status[--length] = '\0';
+    }
+  }
+  const FontMetrics& metrics =
+      small ? FreeMono9pt7bMetrics : FreeMono12pt7bMetrics;
+  const uint16_t width = textWidth(metrics, status) + marginWidth;
+  currX = canvas.width() - width - 2;
+  setFont(small ? FONT_9PT : FONT_12PT);
+  screen.setCursor(currX, 114);
+  screen.setTextColor(statusColor(view));
+  screen.print(status);
+  screen.setTextColor(GxEPD_BLACK);
+
+  // screen.setCursor(currX, 136);
+  // screen.print("Wind: ");
+  // screen.print(round(current.wind_speed), 0);
+  // if (strcmp(units, "imperial") == 0) {
+  //   screen.print(" mph ");
+  // } else {
+  //   screen.print(" m/s ");
+  // }
+  // uint16_t windAngle = (current.wind_deg + 22.5) / 45;
+  // if (windAngle > 7) {
+  //   windAngle = 0;
+  // }
+  // const char* windText[] = {"N", "NE", "E", "SE", "S", "SW", "W", "NW"};
+  // screen.print(windText[windAngle]);
+
+  // screen.setCursor(currX, 158);
+  // screen.print("UV index: ");
+  // screen.print(round(current.uvi), 0);
+  // // https://www.epa.gov/sunsafety/uv-index-scale-0
+  // if (current.uvi >= 11) {
+  //   screen.print(" (extreme)");
+  // } else if (current.uvi >= 8) {
+  //   screen.print(" (very high)");
+  // } else if (current.uvi >= 6) {
+  //   screen.print(" (high)");
+  // } else if (current.uvi >= 3) {
+  //   screen.print(" (moderate)");
+  // } else {
+  //   screen.print(" (low)");
+  // }
+
+  setFont(FONT_12PT);
+
+  constexpr uint8_t charWidth = textWidth(FreeMono12pt7bMetrics, "-");
+  uint16_t x = 2;
+  uint16_t y = 128;
+  constexpr uint16_t itemWidth =
+      textWidth(FreeMono12pt7bMetrics, " Sun  ") + charWidth * 0.75 + 2;
+
+  for (const WeatherHour& hour : view.hours) {
+    char timeBuf[6];
+    snprintf(timeBuf, 6, "%02d:%02d", hour.hour, hour.minute);
+    timeBuf[5] = 0;
+    screen.setCursor(x, y + 14);
+    screen.print(timeBuf);
+    const int16_t temp = hour.temp;
+    char tempBuf[6];
+    memset(tempBuf, 0, 6);
+    snprintf(tempBuf, 6, "%d", temp);
+    screen.setCursor(x + charWidth * 3 - getWidthOfText(tempBuf) / 2, y + 36);
+    screen.setTextColor(temperatureColor(hour.temp, view.imperial));
+    screen.print(tempBuf);
+    screen.setTextColor(GxEPD_BLACK);
+    screen.drawIcon(hour.icon + ICON_FOLDER_SIZE, x + charWidth, y + 34);
+    x += itemWidth;
+  }
+
+  x = 2;
+  y = 212;
+  for (const WeatherDay& day : view.days) {
+    screen.setCursor(x, y + 14);
+    screen.print(" ");
+    screen.print(daysOfTheWeek[day.weekday]);
+    screen.print(" ");
+    screen.setCursor(x, y + 36);
+    const int16_t tempMin = round(day.tempMin);
+    if (tempMin >= 0 && tempMin <= 9) {
+      screen.print(" ");
+    }
+    screen.setTextColor(temperatureColor(day.tempMin, view.imperial));
+    screen.print(tempMin, 0);
+    screen.print(" ");
+    const int16_t tempMax = round(day.tempMax);
+    if (tempMax >= 0 && tempMin <= 9) {
+      screen.print(" ");
+    }
+    screen.setTextColor(temperatureColor(day.tempMax, view.imperial));
+    screen.print(tempMax, 0);
+    screen.setTextColor(GxEPD_BLACK);
+    screen.drawIcon(day.icon + ICON_FOLDER_SIZE, x + charWidth, y + 34);
+    x += itemWidth;
+  }
+}
@@ -1,27 +1,56 @@
-#include <Adafruit_GFX.h>
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <Button.h>
-#include <Fonts/FreeMono12pt7b.h>
-#include <Fonts/FreeMono18pt7b.h>
-#include <Fonts/FreeMono24pt7b.h>
-#include <Fonts/FreeMono9pt7b.h>
+#include <DayNight.h>
+#include <Fingerprint.h>
+#include <FrameBlit.h>
+#include <FrameCodec.h>
+#include <GxEPD2_3C.h>
 #include <GxEPD2_BW.h>
 #include <GxEPD2_display_selection_new_style.h>
 #include <OpenWeather.h>
 #include <Preferences.h>
+#include <RetryPolicy.h>
 #include <SPIFFS.h>
+#include <Screen.h>
+#include <ScreenGrab.h>
+#include <TileDiff.h>
 #include <TimeLib.h>
+#include <WeatherScreen.h>
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
+#include <WakeScheduler.h>
 #include <WiFiManager.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
 #include <time.h>
 
-const char* daysOfTheWeek[8] = {"???", "Sun", "Mon", "Tue",
-                                "Wed", "Thu", "Fri", "Sat"};
-
 // Useful for debugging to go right to the weather screen
 // #define FAST_BOOT
+// Get the forecast from the free Open-Meteo API, which only sends the fields
+// that are displayed, instead of the subscription-gated OpenWeather onecall
+// #define USE_OPEN_METEO
+// Fetch from a local mock OpenWeather server over plain HTTP instead of the
+// real API, see tools/mock_openweather.py
+// #define MOCK_SERVER_HOST "192.168.1.2"
+// #define MOCK_SERVER_PORT 8080
+// Time drawBitmap() against the blit of every atlas icon at boot. The bitmap
+// depths of drawBitmapFromSpiffs() are timed on the host by
+// test_bitmap_depths.
+// #define BENCHMARK_BITMAPS
+// Time getTextBounds() against the constexpr font metrics and printing
+// against the glyph cache blit at boot
+// #define BENCHMARK_TEXT
+// Hash of a known good weather frame, rendered from the recorded payloads of
+// tools/mock_openweather.py on battery. Every render is compared with it so
+// rendering changes can be checked pixel for pixel against the frame hash
+// logged before the change.
+// #define GOLDEN_FRAME_HASH 0x00000000
+// Hash of the color plane of the same frame on a three color panel
+// (GxEPD2_3C in GxEPD2_display_selection_new_style.h), the "Color plane hash"
+// logged before the change. Both hashes check the board, the host checks both
+// planes against the golden frames of test/test_weather_screen.
+// #define GOLDEN_COLOR_HASH 0x00000000
 const uint32_t SERIAL_SPEED = 115200;
 
 const uint8_t USER_BTN_PIN = 27;
@@ -30,17 +59,44 @@ const gpio_num_t USER_BTN_RTC_PIN = GPIO_NUM_27;
 const uint8_t CHARGING_DETECT_PIN = 36;
 const uint8_t BATT_PIN = 39;
 
-const uint8_t BATTERY_DISCHARGING = 0;
-const uint8_t BATTERY_CHARGING = 1;
-const uint8_t BATTERY_LOW = 2;
 uint8_t battState = BATTERY_DISCHARGING;
 
 const char* CONFIG_AP_NAME = "WeatherStationConfig";
 
-const uint32_t FAIL_RETRY_TIME = 5; // minutes
-const uint32_t UPDATE_TIME = 15;    // minutes
+const uint32_t FAIL_RETRY_TIME = 5;      // minutes, first backoff window
+const uint32_t FAIL_RETRY_MAX_TIME = 60; // minutes, backoff window cap
+const uint32_t UPDATE_TIME = 15;         // minutes
+const uint32_t MIN_SLEEP = 60;           // seconds, shortest aligned sleep
+
+// Deadline budget of each fetch stage, header and body are measured from the
+// start of their own stage and stall is the longest gap allowed between bytes
+const uint32_t CONNECT_TIMEOUT = 5000; // ms
+const uint32_t HEADER_TIMEOUT = 5000;  // ms
+const uint32_t BODY_TIMEOUT = 8000;    // ms
+const uint32_t STALL_TIMEOUT = 3000;   // ms
+
+// Most wakes only fetch current weather and reuse the cached hourly and daily
+// forecast, which is refreshed every FULL_FETCH_EVERY wakes or once it is
+// older than FULL_FETCH_MAX_AGE
+const uint8_t FULL_FETCH_EVERY = 4;      // wakes
+const uint32_t FULL_FETCH_MAX_AGE = 60;  // minutes
+const uint16_t API_CALLS_PER_DAY = 1000; // free OpenWeather budget
+
+// Failure stages outside of the OpenWeather library's OW_FAIL_* range
+const uint8_t FAIL_STAGE_WIFI = 0x80;
 
 const char* NTP_SERVER = "pool.ntp.org";
+// The clock is set from the weather response Date header, a full SNTP sync is
+// only done every NTP_SYNC_INTERVAL or when the two disagree by more than
+// TIME_TOLERANCE
+const uint32_t NTP_SYNC_INTERVAL = 6; // hours
+const uint32_t TIME_TOLERANCE = 120;  // seconds
+const uint32_t NTP_TIMEOUT = 5000;    // ms to wait for an SNTP sync
+
+// Timer wakes only refresh the tiles that changed since the last frame with
+// partial updates, with a full refresh every FULL_REFRESH_EVERY wakes to clear
+// ghosting or when more than half the panel changed
+const uint8_t FULL_REFRESH_EVERY = 8; // wakes
 
 uint32_t TZ_OFFSET = 0;               // seconds
 uint16_t DAYLIGHT_SAVINGS_OFFSET = 0; // seconds
@@ -75,9 +131,113 @@ struct OW_GeocodingReverse {
 // clang-format on
 RTC_DATA_ATTR OW_GeocodingReverse georev;
 
+DayNightTable dayNight;
+
 struct tm timeInfo;
 
 RTC_DATA_ATTR bool lastUpdateSuccess = false;
+RTC_DATA_ATTR uint32_t lastNtpSync = 0; // UTC, seconds
+
+// Bytes of the alert event kept across deep sleep, longer events are cut
+const uint8_t ALERT_EVENT_LENGTH = 48;
+
+// Displayed fields of the last full forecast fetch
+// clang-format off
+struct ForecastCache {
+  bool valid = false;
+  uint8_t wakesSinceFull = 0;
+  uint32_t fetchedAt = 0; // UTC, seconds
+  uint32_t hourlyDt[MAX_HOURS] = {0};
+  float hourlyTemp[MAX_HOURS] = {0};
+  uint16_t hourlyId[MAX_HOURS] = {0};
+  uint32_t dailyDt[MAX_DAYS] = {0};
+  uint32_t dailySunrise[MAX_DAYS] = {0};
+  uint32_t dailySunset[MAX_DAYS] = {0};
+  float dailyTempMin[MAX_DAYS] = {0};
+  float dailyTempMax[MAX_DAYS] = {0};
+  uint16_t dailyId[MAX_DAYS] = {0};
+  // The first alert, fetched with the forecast and shown until alertEnd
+  char alertEvent[ALERT_EVENT_LENGTH] = "";
+  uint32_t alertStart = 0; // UTC, seconds
+  uint32_t alertEnd = 0;   // UTC, seconds
+};
+// clang-format on
+RTC_DATA_ATTR ForecastCache forecastCache;
+
+// API usage of the current UTC day, OpenWeather resets its count at 00:00 UTC
+struct FetchStats {
+  uint32_t day = 0; // days since epoch
+  uint16_t apiCalls = 0;
+  uint16_t fullFetches = 0;
+  uint32_t bytes = 0;
+};
+RTC_DATA_ATTR FetchStats fetchStats;
+
+const RetryPolicy retryPolicy = {FAIL_RETRY_TIME * 60,
+                                 FAIL_RETRY_MAX_TIME * 60};
+RTC_DATA_ATTR RetryState retryState;
+RTC_DATA_ATTR WakeState wakeState;
+RTC_DATA_ATTR TileState tileState;
+// Fingerprint of what the panel shows, see weatherFingerprint()
+RTC_DATA_ATTR uint32_t shownFingerprint = 0;
+struct DisplayStats {
+  uint32_t day = 0; // days since epoch
+  uint16_t wakes = 0;
+  uint16_t skips = 0;
+};
+RTC_DATA_ATTR DisplayStats displayStats;
+// The panel still shows the last weather frame
+bool panelRetained = false;
+// The snapshot of that frame is back in the controller as its previous
+// frame, which partial refreshes are made against
+bool frameRestored = false;
+
+// The last weather frame shown, compressed, to put back into the
+// controller's previous frame RAM on wake. Frames that don't fit in RTC
+// memory are kept in FRAME_SNAPSHOT_PATH instead.
+const uint16_t FRAME_SNAPSHOT_SIZE = 4096;
+const char* FRAME_SNAPSHOT_PATH = "/frame.snap";
+struct FrameSnapshot {
+  bool valid = false;
+  bool inFlash = false;
+  uint32_t size = 0; // bytes encoded
+  uint32_t hash = 0; // of the decoded frame
+};
+RTC_DATA_ATTR FrameSnapshot frameSnapshot;
+RTC_DATA_ATTR uint8_t frameSnapshotData[FRAME_SNAPSHOT_SIZE];
+// The frame buffer holds what the panel shows, see sendScreenGrab()
+bool frameRendered = false;
+
+// Sizes of the panel and of the frame drawn for it, FRAME_PAGE_HEIGHT rows
+// at a time. Three color panels have a black and a color plane.
+template <typename Display> struct DisplayTraits;
+template <typename Driver, const uint16_t pageHeight>
+struct DisplayTraits<GxEPD2_BW<Driver, pageHeight>> {
+  static const uint16_t WIDTH = Driver::WIDTH;
+  static const uint16_t HEIGHT = Driver::HEIGHT;
+  static const uint16_t PAGE_HEIGHT = FRAME_PAGE_HEIGHT;
+  static const bool COLOR = false;
+  typedef uint8_t Buffer[Driver::WIDTH / 8 * FRAME_PAGE_HEIGHT];
+};
+template <typename Driver, const uint16_t pageHeight>
+struct DisplayTraits<GxEPD2_3C<Driver, pageHeight>> {
+  static const uint16_t WIDTH = Driver::WIDTH;
+  static const uint16_t HEIGHT = Driver::HEIGHT;
+  static const uint16_t PAGE_HEIGHT = FRAME_PAGE_HEIGHT;
+  static const bool COLOR = true;
+  typedef uint8_t Buffer[Driver::WIDTH / 8 * FRAME_PAGE_HEIGHT];
+};
+typedef decltype(display) Display;
+
+// The planes canvas of include/Screen.h draws into, sent to the panel with
+// the public writeImage() of the driver, see writeFrame(). GxEPD2 keeps its
+// own buffers private and one row high.
+uint8_t frameBlack[sizeof(DisplayTraits<Display>::Buffer)];
+uint8_t frameColor[DisplayTraits<Display>::COLOR
+                       ? sizeof(DisplayTraits<Display>::Buffer)
+                       : 1];
+
+void showScreen();
 
 void printWakeupReason() {
   esp_sleep_wakeup_cause_t reason = esp_sleep_get_wakeup_cause();
@@ -163,21 +323,21 @@ bool connectToWiFi(bool useScreen) {
   wm.setConfigPortalTimeout(60);
   Serial.println("Attempting connection to WiFi");
 
-  display.setFont(&FreeMono9pt7b);
-  display.setTextColor(GxEPD_BLACK);
-  display.fillScreen(GxEPD_WHITE);
+  screen.clear();
+  setFont(FONT_9PT);
+  canvas.setTextColor(GxEPD_BLACK);
 
-  display.setCursor(0, 10);
+  screen.setCursor(0, 10);
 
   if (userBtn.read() == Button::PRESSED) {
     wm.resetSettings();
     Serial.println("WiFi configuration deleted.");
-    display.println("WiFi configuration deleted.");
+    screen.println("WiFi configuration deleted.");
   }
 
-  display.println("Connecting to WiFi...");
+  screen.println("Connecting to WiFi...");
   if (useScreen) {
-    display.display();
+    showScreen();
   }
 
   if (!wm.autoConnect(CONFIG_AP_NAME)) {
@@ -191,20 +351,20 @@ bool connectToWiFi(bool useScreen) {
         Serial.print(CONFIG_AP_NAME);
         Serial.println("\" and open http://192.168.4.1 to open the WiFi "
                        "credential configuration page.");
-        display.println(
+        screen.println(
             "Failed to connect to WiFi, starting configuration AP.");
-        display.print("Join the WiFi network \"");
-        display.print(CONFIG_AP_NAME);
-        display.println("\" and open http://192.168.4.1 to open the WiFi "
+        screen.print("Join the WiFi network \"");
+        screen.print(CONFIG_AP_NAME);
+        screen.println("\" and open http://192.168.4.1 to open the WiFi "
                         "credential configuration page.");
         if (useScreen) {
-          display.display();
+          showScreen();
         }
         displayedAboutStartedConfigAP = true;
       }
       if (configAPTimedOut && !displayedAboutConfigAPTimedOut) {
         Serial.println("Configuration AP timed out, exiting.");
-        display.println("Configuration AP timed out, exiting.");
+        screen.println("Configuration AP timed out, exiting.");
         displayedAboutConfigAPTimedOut = true;
         goto wifiConnectFailed;
       }
@@ -241,18 +401,18 @@ bool connectToWiFi(bool useScreen) {
     saveParams();
   }
 
-  display.println("Successfully connected to WiFi!");
+  screen.println("Successfully connected to WiFi!");
   if (useScreen) {
-    display.display();
+    showScreen();
     delay(5000);
   }
   return true;
 
 wifiConnectFailed:
   Serial.println("Failed to connect to WiFi!");
-  display.println("Failed to connect to WiFi!");
+  screen.println("Failed to connect to WiFi!");
   if (useScreen) {
-    display.display();
+    showScreen();
     delay(5000);
   }
   return false;
@@ -268,13 +428,93 @@ bool disconnectFromWiFi() {
   return true;
 }
 
+void setTimezone(int32_t offset) {
+  // POSIX TZ offsets are west of UTC, so the sign is flipped
+  char tz[16];
+  const uint32_t absOffset = abs(offset);
+  snprintf(tz, sizeof(tz), "UTC%c%02u:%02u", offset >= 0 ? '-' : '+',
+           absOffset / 3600, absOffset % 3600 / 60);
+  setenv("TZ", tz, 1);
+  tzset();
+}
+
+void setTimeFromServer() {
+  const uint32_t serverNow =
+      ow.serverTime + (millis() - ow.serverTimeMillis) / 1000;
+  const timeval tv = {(time_t)serverNow, 0};
+  settimeofday(&tv, nullptr);
+  setTimezone(ow.timezoneOffset);
+}
+
+bool syncTimeWithNtp() {
+  Serial.println("Syncing time with NTP");
+  // getLocalTime() returns at once when the RTC already holds a time, so it
+  // can't tell a sync happened. Wait for SNTP to report one instead.
+  sntp_set_sync_status(SNTP_SYNC_STATUS_RESET);
+  configTime(ow.timezoneOffset, DAYLIGHT_SAVINGS_OFFSET, NTP_SERVER);
+  const uint32_t start = millis();
+  while (sntp_get_sync_status() != SNTP_SYNC_STATUS_COMPLETED) {
+    if (millis() - start > NTP_TIMEOUT) {
+      Serial.println("NTP sync timed out");
+      return false;
+    }
+    delay(10);
+  }
+  lastNtpSync = time(nullptr);
+  return getLocalTime(&timeInfo, 0);
+}
+
 bool updateTime() {
+  const uint32_t start = millis();
   Serial.println("Configuring time");
   Serial.print("Timezone offset: ");
   Serial.println(ow.timezoneOffset);
-  configTime(ow.timezoneOffset, DAYLIGHT_SAVINGS_OFFSET, NTP_SERVER);
-  if (!getLocalTime(&timeInfo)) {
-    Serial.println("Failed to obtain time");
+
+  bool useNtp = false;
+  if (ow.serverTime == 0) {
+    Serial.println("No server time in weather response");
+    useNtp = true;
+  } else {
+    const uint32_t serverNow =
+        ow.serverTime + (millis() - ow.serverTimeMillis) / 1000;
+    const uint32_t clockNow = time(nullptr);
+    const uint32_t drift = serverNow > clockNow ? serverNow - clockNow
+                                                : clockNow - serverNow;
+    Serial.print("Clock drift from server time: ");
+    Serial.print(drift);
+    Serial.println(" seconds");
+    if (lastNtpSync == 0 ||
+        serverNow - lastNtpSync > NTP_SYNC_INTERVAL * 3600) {
+      Serial.println("NTP sync due");
+      useNtp = true;
+    } else if (drift > TIME_TOLERANCE) {
+      Serial.println("Drift out of tolerance");
+      useNtp = true;
+    } else {
+      setTimeFromServer();
+    }
+  }
+
+  bool success;
+  if (useNtp) {
+    success = syncTimeWithNtp();
+    // The drifted clock is not kept, and lastNtpSync stays so the next wake
+    // tries NTP again
+    if (!success && ow.serverTime != 0) {
+      Serial.println("Falling back to server time");
+      setTimeFromServer();
+      useNtp = false;
+      success = getLocalTime(&timeInfo, 0);
+    }
+  } else {
+    Serial.println("Set time from weather response");
+    success = getLocalTime(&timeInfo, 0);
+  }
+  Serial.print("Time to valid clock: ");
+  Serial.print(millis() - start);
+  Serial.print(" ms using ");
+  Serial.println(useNtp ? "NTP" : "server time");
+  if (!success) {
     return false;
   }
   Serial.print("Time is ");
@@ -288,11 +528,20 @@ bool updateGeocodingReverse() {
   Serial.println(latitude);
   Serial.print("Longitude: ");
   Serial.println(longitude);
+  const uint32_t fetchStart = millis();
+#ifdef MOCK_SERVER_HOST
+  WiFiClient client;
+  const char* host = MOCK_SERVER_HOST;
+  const uint16_t port = MOCK_SERVER_PORT;
+#else
   WiFiClientSecure client;
   client.setInsecure();
   const char* host = "api.openweathermap.org";
   const uint16_t port = 443;
-  if (!client.connect(host, port)) {
+#endif
+  // Stream timeout is per byte, so find() and ArduinoJson abort on a stall
+  client.Stream::setTimeout(STALL_TIMEOUT);
+  if (!client.connect(host, port, CONNECT_TIMEOUT)) {
     Serial.println("Connection failed");
     return false;
   }
@@ -314,6 +563,13 @@ bool updateGeocodingReverse() {
     return false;
   }
   Serial.println("Sent request, pulling out header");
+  if (!client.find("HTTP/1.1")) {
+    Serial.println("No response");
+    return false;
+  }
+  Serial.print("Time to first byte: ");
+  Serial.print(millis() - fetchStart);
+  Serial.println(" ms");
   if (!client.find("\r\n\r\n")) {
     Serial.println("Could not find end of headers");
     return false;
@@ -337,22 +593,191 @@ bool updateGeocodingReverse() {
   Serial.print("Country: ");
   Serial.println(georev.country);
   client.stop();
+  Serial.print("Fetch took ");
+  Serial.print(millis() - fetchStart);
+  Serial.println(" ms");
   return true;
 }
 
+const char* failStageName(uint8_t stage) {
+  switch (stage) {
+    case OW_FAIL_NONE:
+      return "none";
+    case OW_FAIL_CONNECT:
+      return "connect";
+    case OW_FAIL_HEADER:
+      return "header";
+    case OW_FAIL_BODY:
+      return "body";
+    case OW_FAIL_STALL:
+      return "stall";
+    case OW_FAIL_PARSE:
+      return "parse";
+    case FAIL_STAGE_WIFI:
+      return "WiFi";
+    default:
+      return "unknown";
+  }
+}
+
+void printRetryState() {
+  Serial.print("Attempts: ");
+  Serial.print(retryState.totalAttempts);
+  Serial.print(", failures: ");
+  Serial.print(retryState.totalFailures);
+  Serial.print(" (");
+  Serial.print(retryState.consecutiveFailures);
+  Serial.println(" consecutive)");
+  Serial.print("Last failed stage: ");
+  Serial.println(failStageName(retryState.lastFailStage));
+  Serial.print("Last backoff: ");
+  Serial.print(retryState.lastBackoff);
+  Serial.println(" seconds");
+}
+
+bool shouldFetchFull() {
+  if (!forecastCache.valid) {
+    Serial.println("No cached forecast");
+    return true;
+  }
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_EXT0) {
+    Serial.println("Woken by button, refreshing forecast");
+    return true;
+  }
+  if (forecastCache.wakesSinceFull + 1 >= FULL_FETCH_EVERY) {
+    return true;
+  }
+  // The RTC keeps system time across deep sleep once it has been set
+  const uint32_t now = time(nullptr);
+  return now < forecastCache.fetchedAt ||
+         now - forecastCache.fetchedAt >= FULL_FETCH_MAX_AGE * 60;
+}
+
+void saveForecastCache() {
+  forecastCache.valid = true;
+  forecastCache.wakesSinceFull = 0;
+  forecastCache.fetchedAt = current.dt;
+  for (uint8_t i = 0; i < MAX_HOURS; i++) {
+    forecastCache.hourlyDt[i] = hourly.dt[i];
+    forecastCache.hourlyTemp[i] = hourly.temp[i];
+    forecastCache.hourlyId[i] = hourly.id[i];
+  }
+  for (uint8_t i = 0; i < MAX_DAYS; i++) {
+    forecastCache.dailyDt[i] = daily.dt[i];
+    forecastCache.dailySunrise[i] = daily.sunrise[i];
+    forecastCache.dailySunset[i] = daily.sunset[i];
+    forecastCache.dailyTempMin[i] = daily.temp_min[i];
+    forecastCache.dailyTempMax[i] = daily.temp_max[i];
+    forecastCache.dailyId[i] = daily.id[i];
+  }
+  strlcpy(forecastCache.alertEvent, current.alert_event.c_str(),
+          sizeof(forecastCache.alertEvent));
+  forecastCache.alertStart = current.alert_start;
+  forecastCache.alertEnd = current.alert_end;
+}
+
+void restoreForecastCache() {
+  forecastCache.wakesSinceFull++;
+  for (uint8_t i = 0; i < MAX_HOURS; i++) {
+    hourly.dt[i] = forecastCache.hourlyDt[i];
+    hourly.temp[i] = forecastCache.hourlyTemp[i];
+    hourly.id[i] = forecastCache.hourlyId[i];
+  }
+  for (uint8_t i = 0; i < MAX_DAYS; i++) {
+    daily.dt[i] = forecastCache.dailyDt[i];
+    daily.sunrise[i] = forecastCache.dailySunrise[i];
+    daily.sunset[i] = forecastCache.dailySunset[i];
+    daily.temp_min[i] = forecastCache.dailyTempMin[i];
+    daily.temp_max[i] = forecastCache.dailyTempMax[i];
+    daily.id[i] = forecastCache.dailyId[i];
+  }
+  current.alert_event = forecastCache.alertEvent;
+  current.alert_start = forecastCache.alertStart;
+  current.alert_end = forecastCache.alertEnd;
+}
+
+void recordFetch(bool full, uint32_t bytes) {
+  const uint32_t now = current.dt != 0 ? current.dt : time(nullptr);
+  if (now / 86400 != fetchStats.day) {
+    fetchStats = FetchStats();
+    fetchStats.day = now / 86400;
+  }
+  fetchStats.apiCalls++;
+  fetchStats.bytes += bytes;
+  if (full) {
+    fetchStats.fullFetches++;
+  }
+  Serial.print("API calls today: ");
+  Serial.print(fetchStats.apiCalls);
+  Serial.print("/");
+  Serial.print(API_CALLS_PER_DAY);
+  Serial.print(" (");
+  Serial.print(fetchStats.fullFetches);
+  Serial.print(" full), ");
+  Serial.print(fetchStats.bytes / 1024);
+  Serial.println(" KiB downloaded");
+}
+
 bool updateWeather(bool useScreen) {
-  Serial.println("Getting weather from OpenWeather");
-  const bool success = ow.getForecast(&current, &hourly, &daily, apiKey,
-                                      latitude, longitude, units, lang);
+  const bool full = shouldFetchFull();
+  OW_hourly* const wantHourly = full ? &hourly : nullptr;
+  OW_daily* const wantDaily = full ? &daily : nullptr;
+  Serial.println(full ? "Getting full forecast"
+                      : "Getting current weather, reusing cached forecast");
+  ow.setTimeouts(CONNECT_TIMEOUT, HEADER_TIMEOUT, BODY_TIMEOUT, STALL_TIMEOUT);
+#ifdef MOCK_SERVER_HOST
+  ow.setServer(MOCK_SERVER_HOST, MOCK_SERVER_PORT);
+  const bool secure = false;
+#else
+  const bool secure = true;
+#endif
+#ifdef USE_OPEN_METEO
+  const bool success = ow.getOpenMeteoForecast(
+      &current, wantHourly, wantDaily, latitude, longitude, units, secure);
+#else
+  // The alerts block takes kilobytes, it comes with the forecast and is kept
+  // in forecastCache until the next full fetch
+  const bool success =
+      ow.getForecast(&current, wantHourly, wantDaily, apiKey, latitude,
+                     longitude, units, lang, secure, full);
+#endif
+  Serial.print("Received ");
+  Serial.print(ow.bytesReceived);
+  Serial.print(" bytes, copied ");
+  Serial.print(ow.bytesCopied);
+  Serial.println(" bytes");
+  Serial.print("Time to first byte: ");
+  Serial.print(ow.timeToFirstByte);
+  Serial.print(" ms, fetch took ");
+  Serial.print(ow.fetchTime);
+  Serial.println(" ms");
+  Serial.print("Peak heap use during fetch: ");
+  Serial.print(ow.heapUsed);
+  Serial.println(" bytes");
+  // Requests that never got a response, e.g. failed connects, never reached
+  // the API and do not count against its daily budget
+  if (ow.bytesReceived > 0) {
+    recordFetch(full, ow.bytesReceived);
+  } else {
+    Serial.println("No response, not counted as an API call");
+  }
   if (success) {
+    if (full) {
+      saveForecastCache();
+    } else {
+      restoreForecastCache();
+    }
+    buildDayNightTable(dayNight, daily.sunrise, daily.sunset, MAX_DAYS,
+                       ow.timezoneOffset);
     Serial.println("Obtained weather successfully!");
-    display.println("Obtained weather successfully!");
+    screen.println("Obtained weather successfully!");
   } else {
-    Serial.println("Failed to get weather!");
-    display.println("Failed to get weather!");
+    Serial.print("Failed to get weather in stage: ");
+    Serial.println(failStageName(ow.failStage));
+    screen.println("Failed to get weather!");
   }
   if (useScreen) {
-    display.display();
+    showScreen();
     delay(5000);
   }
   return success;
@@ -447,6 +872,15 @@ void printWeather() {
   Serial.println(current.description);
   Serial.print("icon             : ");
   Serial.println(current.icon);
+  if (current.alert_event.length() > 0) {
+    Serial.println();
+    Serial.print("alert            : ");
+    Serial.println(current.alert_event);
+    Serial.print("alert start      : ");
+    Serial.println(strTime(current.alert_start));
+    Serial.print("alert end        : ");
+    Serial.println(strTime(current.alert_end));
+  }
 
   Serial.println();
 
@@ -569,550 +1003,625 @@ void printWeather() {
   }
 }
 
-uint16_t read16(fs::File& f) {
-  // BMP data is stored little-endian, same as Arduino.
-  uint16_t result;
-  ((uint8_t*)&result)[0] = f.read(); // LSB
-  ((uint8_t*)&result)[1] = f.read(); // MSB
-  return result;
+// Sends the rows of the canvas to the controller like GxEPD2 sends its own
+// buffer, again writes them as the previous frame of a panel with fast
+// partial update
+void writeFrame(bool again) {
+  const FrameTarget plane = canvas.target(false);
+#if IS_GxEPD2_3C(GxEPD2_DISPLAY_CLASS)
+  (void)again;
+  display.epd2.writeImage(canvas.black, canvas.color, 0, plane.top,
+                          plane.width, plane.rows);
+#else
+  if (again) {
+    display.epd2.writeImageAgain(canvas.black, 0, plane.top, plane.width,
+                                 plane.rows);
+  } else {
+    display.epd2.writeImageForFullRefresh(canvas.black, 0, plane.top,
+                                          plane.width, plane.rows);
+  }
+#endif
 }
 
-uint32_t read32(fs::File& f) {
-  // BMP data is stored little-endian, same as Arduino.
-  uint32_t result;
-  ((uint8_t*)&result)[0] = f.read(); // LSB
-  ((uint8_t*)&result)[1] = f.read();
-  ((uint8_t*)&result)[2] = f.read();
-  ((uint8_t*)&result)[3] = f.read(); // MSB
-  return result;
+// Full refresh with the frame in the canvas, display() of GxEPD2
+void displayFrame() {
+  writeFrame(false);
+  display.epd2.refresh(false);
+  if (!DisplayTraits<Display>::COLOR && display.epd2.hasFastPartialUpdate) {
+    writeFrame(true);
+  }
+  display.epd2.powerOff();
 }
 
-// https://github.com/ZinggJM/GxEPD2/blob/master/examples/GxEPD2_Spiffs_Example/GxEPD2_Spiffs_Example.ino#L245
-void drawBitmapFromSpiffs(const char* filename, int16_t x, int16_t y,
-                          bool with_color = false) {
-  static const uint16_t input_buffer_pixels = 800; // may affect performance
-
-  static const uint16_t max_row_width =
-      1872; // for up to 7.8" display 1872x1404
-  static const uint16_t max_palette_pixels = 256; // for depth <= 8
-
-  uint8_t input_buffer[3 * input_buffer_pixels]; // up to depth 24
-  uint8_t output_row_mono_buffer[max_row_width /
-                                 8]; // buffer for at least one row of b/w bits
-  uint8_t output_row_color_buffer[max_row_width / 8]; // buffer for at least one
-                                                      // row of color bits
-  uint8_t mono_palette_buffer[max_palette_pixels /
-                              8]; // palette buffer for depth <= 8 b/w
-  uint8_t color_palette_buffer[max_palette_pixels /
-                               8]; // palette buffer for depth <= 8 c/w
-
-  fs::File file;
-  bool valid = false; // valid format to be handled
-  bool flip = true;   // bitmap is stored bottom-to-top
-  uint32_t startTime = millis();
-  if ((x >= display.epd2.WIDTH) || (y >= display.epd2.HEIGHT))
-    return;
-  Serial.println();
-  Serial.print("Loading image '");
-  Serial.print(filename);
-  Serial.println('\'');
-#if defined(ESP32)
-  file = SPIFFS.open(filename, "r");
+// Partial refresh of a rectangle in panel coordinates, displayWindow() of
+// GxEPD2_BW. Three color panels only get full refreshes.
+void displayFrameRect(const TileRect& rect) {
+  typedef DisplayTraits<Display> Traits;
+#if IS_GxEPD2_BW(GxEPD2_DISPLAY_CLASS)
+  display.epd2.writeImagePart(canvas.black, rect.x, rect.y, Traits::WIDTH,
+                              Traits::HEIGHT, rect.x, rect.y, rect.w, rect.h);
+  display.epd2.refresh(rect.x, rect.y, rect.w, rect.h);
+  if (display.epd2.hasFastPartialUpdate) {
+    display.epd2.writeImagePartAgain(canvas.black, rect.x, rect.y,
+                                     Traits::WIDTH, Traits::HEIGHT, rect.x,
+                                     rect.y, rect.w, rect.h);
+  }
 #else
-  file = LittleFS.open(filename, "r");
+  (void)rect;
+  displayFrame();
 #endif
-  if (!file) {
-    Serial.println("File not found");
-    return;
-  } else {
-    Serial.println("Opened file successfully");
+}
+
+#ifdef BENCHMARK_BITMAPS
+void benchmarkBitmaps() {
+#ifdef USE_ICON_ATLAS
+  for (uint8_t i = 0; i < ICON_ASSET_COUNT; i++) {
+    const IconBitmap& icon = ICON_ATLAS[i];
+    uint32_t start = micros();
+    canvas.drawBitmap(0, 0, icon.bits, icon.width, icon.height, GxEPD_BLACK);
+    const uint32_t gfxTime = micros() - start;
+    start = micros();
+    drawBits(3, 0, icon.bits, icon.width, icon.height);
+    const uint32_t blitTime = micros() - start;
+    Serial.print("Benchmark ");
+    Serial.print(ICON_ASSET_PATHS[i]);
+    Serial.print(": drawBitmap ");
+    Serial.print(gfxTime);
+    Serial.print(" us, blit ");
+    Serial.print(blitTime);
+    Serial.println(" us");
   }
-  // Parse BMP header
-  uint16_t signature = read16(file);
-  Serial.print("Magic number: 0x");
-  Serial.println(signature, HEX);
-  if (signature == 0x4D42) // BMP signature
-  {
-    uint32_t fileSize = read32(file);
-    uint32_t creatorBytes = read32(file);
-    (void)creatorBytes;                  // unused
-    uint32_t imageOffset = read32(file); // Start of image data
-    uint32_t headerSize = read32(file);
-    uint32_t width = read32(file);
-    int32_t height = (int32_t)read32(file);
-    uint16_t planes = read16(file);
-    uint16_t depth = read16(file); // bits per pixel
-    uint32_t format = read32(file);
-    if ((planes == 1) &&
-        ((format == 0) || (format == 3))) // uncompressed is handled, 565 also
-    {
-      Serial.print("File size: ");
-      Serial.println(fileSize);
-      Serial.print("Image Offset: ");
-      Serial.println(imageOffset);
-      Serial.print("Header size: ");
-      Serial.println(headerSize);
-      Serial.print("Bit Depth: ");
-      Serial.println(depth);
-      Serial.print("Image size: ");
-      Serial.print(width);
-      Serial.print('x');
-      Serial.println(height);
-      // BMP rows are padded (if needed) to 4-byte boundary
-      uint32_t rowSize = (width * depth / 8 + 3) & ~3;
-      if (depth < 8)
-        rowSize = ((width * depth + 8 - depth) / 8 + 3) & ~3;
-      if (height < 0) {
-        height = -height;
-        flip = false;
-      }
-      uint16_t w = width;
-      uint16_t h = height;
-      if ((x + w - 1) >= display.epd2.WIDTH)
-        w = display.epd2.WIDTH - x;
-      if ((y + h - 1) >= display.epd2.HEIGHT)
-        h = display.epd2.HEIGHT - y;
-      if (w <= max_row_width) // handle with direct drawing
-      {
-        valid = true;
-        uint8_t bitmask = 0xFF;
-        uint8_t bitshift = 8 - depth;
-        uint16_t red, green, blue;
-        bool whitish = false;
-        bool colored = false;
-        if (depth == 1)
-          with_color = false;
-        if (depth <= 8) {
-          if (depth < 8)
-            bitmask >>= depth;
-          // file.seek(54); //palette is always @ 54
-          file.seek(imageOffset -
-                    (4 << depth)); // 54 for regular, diff for colorsimportant
-          for (uint16_t pn = 0; pn < (1 << depth); pn++) {
-            blue = file.read();
-            green = file.read();
-            red = file.read();
-            file.read();
-            whitish = with_color
-                          ? ((red > 0x80) && (green > 0x80) && (blue > 0x80))
-                          : ((red + green + blue) > 3 * 0x80); // whitish
-            colored = (red > 0xF0) || ((green > 0xF0) &&
-                                       (blue > 0xF0)); // reddish or yellowish?
-            if (0 == pn % 8)
-              mono_palette_buffer[pn / 8] = 0;
-            mono_palette_buffer[pn / 8] |= whitish << pn % 8;
-            if (0 == pn % 8)
-              color_palette_buffer[pn / 8] = 0;
-            color_palette_buffer[pn / 8] |= colored << pn % 8;
+#endif
+  canvas.fillScreen(GxEPD_WHITE);
+}
+#endif
+
+// Hashes of the planes of a rendered frame, color is 0 on black and white
+// panels
+struct FrameHash {
+  uint32_t black;
+  uint32_t color;
+};
+
+// Draws the recorded screen into the frame buffer and returns the hashes of
+// the frame. With a full frame buffer the caller refreshes the panel,
+// otherwise the frame is drawn and sent a page at a time and the whole panel
+// is refreshed after the last one.
+FrameHash renderScreen() {
+  typedef DisplayTraits<Display> Traits;
+  const uint8_t* buffer = canvas.black;
+  Fingerprint black;
+  Fingerprint color;
+  if (screen.overflow) {
+    Serial.println("Draw list full, the screen is incomplete");
+  }
+  if (Traits::PAGE_HEIGHT == Traits::HEIGHT) {
+    replayScreen();
+    frameRendered = true;
+    addBytes(black, buffer, sizeof(Traits::Buffer));
+    if (Traits::COLOR) {
+      addBytes(color, canvas.color, sizeof(Traits::Buffer));
+    }
+  } else {
+    // Sent a page at a time like nextPage() of GxEPD2 does. Panels with fast
+    // partial update go through the pages a second time to fill the
+    // controller's previous frame, only the first pass is hashed.
+    const bool again = !Traits::COLOR && display.epd2.hasFastPartialUpdate;
+    for (uint8_t pass = 0; pass < (again ? 2 : 1); pass++) {
+      for (canvas.top = 0; canvas.top < Traits::HEIGHT;
+           canvas.top += Traits::PAGE_HEIGHT) {
+        replayScreen();
+        const uint16_t rows = canvas.target(false).rows;
+        if (pass == 0) {
+          addBytes(black, buffer, rows * (Traits::WIDTH / 8));
+          if (Traits::COLOR) {
+            addBytes(color, canvas.color, rows * (Traits::WIDTH / 8));
           }
         }
-        uint32_t rowPosition =
-            flip ? imageOffset + (height - h) * rowSize : imageOffset;
-        for (uint16_t row = 0; row < h;
-             row++, rowPosition += rowSize) // for each line
-        {
-          uint32_t in_remain = rowSize;
-          uint32_t in_idx = 0;
-          uint32_t in_bytes = 0;
-          uint8_t in_byte = 0;           // for depth <= 8
-          uint8_t in_bits = 0;           // for depth <= 8
-          uint8_t out_byte = 0xFF;       // white (for w%8!=0 border)
-          uint8_t out_color_byte = 0xFF; // white (for w%8!=0 border)
-          uint32_t out_idx = 0;
-          file.seek(rowPosition);
-          for (uint16_t col = 0; col < w; col++) // for each pixel
-          {
-            // Time to read more pixel data?
-            if (in_idx >= in_bytes) // ok, exact match for 24bit also (size IS
-                                    // multiple of 3)
-            {
-              in_bytes =
-                  file.read(input_buffer, in_remain > sizeof(input_buffer)
-                                              ? sizeof(input_buffer)
-                                              : in_remain);
-              in_remain -= in_bytes;
-              in_idx = 0;
-            }
-            switch (depth) {
-              case 32:
-                blue = input_buffer[in_idx++];
-                green = input_buffer[in_idx++];
-                red = input_buffer[in_idx++];
-                in_idx++; // skip alpha
-                whitish =
-                    with_color
-                        ? ((red > 0x80) && (green > 0x80) && (blue > 0x80))
-                        : ((red + green + blue) > 3 * 0x80); // whitish
-                colored =
-                    (red > 0xF0) ||
-                    ((green > 0xF0) && (blue > 0xF0)); // reddish or yellowish?
-                break;
-              case 24:
-                blue = input_buffer[in_idx++];
-                green = input_buffer[in_idx++];
-                red = input_buffer[in_idx++];
-                whitish =
-                    with_color
-                        ? ((red > 0x80) && (green > 0x80) && (blue > 0x80))
-                        : ((red + green + blue) > 3 * 0x80); // whitish
-                colored =
-                    (red > 0xF0) ||
-                    ((green > 0xF0) && (blue > 0xF0)); // reddish or yellowish?
-                break;
-              case 16: {
-                uint8_t lsb = input_buffer[in_idx++];
-                uint8_t msb = input_buffer[in_idx++];
-                if (format == 0) // 555
-                {
-                  blue = (lsb & 0x1F) << 3;
-                  green = ((msb & 0x03) << 6) | ((lsb & 0xE0) >> 2);
-                  red = (msb & 0x7C) << 1;
-                } else // 565
-                {
-                  blue = (lsb & 0x1F) << 3;
-                  green = ((msb & 0x07) << 5) | ((lsb & 0xE0) >> 3);
-                  red = (msb & 0xF8);
-                }
-                whitish =
-                    with_color
-                        ? ((red > 0x80) && (green > 0x80) && (blue > 0x80))
-                        : ((red + green + blue) > 3 * 0x80); // whitish
-                colored =
-                    (red > 0xF0) ||
-                    ((green > 0xF0) && (blue > 0xF0)); // reddish or yellowish?
-              } break;
-              case 1:
-              case 2:
-              case 4:
-              case 8: {
-                if (0 == in_bits) {
-                  in_byte = input_buffer[in_idx++];
-                  in_bits = 8;
-                }
-                uint16_t pn = (in_byte >> bitshift) & bitmask;
-                whitish = mono_palette_buffer[pn / 8] & (0x1 << pn % 8);
-                colored = color_palette_buffer[pn / 8] & (0x1 << pn % 8);
-                in_byte <<= depth;
-                in_bits -= depth;
-              } break;
-            }
-            if (whitish) {
-              // keep white
-            } else if (colored && with_color) {
-              out_color_byte &= ~(0x80 >> col % 8); // colored
-            } else {
-              out_byte &= ~(0x80 >> col % 8); // black
-            }
-            if ((7 == col % 8) ||
-                (col == w - 1)) // write that last byte! (for w%8!=0 border)
-            {
-              output_row_color_buffer[out_idx] = out_color_byte;
-              output_row_mono_buffer[out_idx++] = out_byte;
-              out_byte = 0xFF;       // white (for w%8!=0 border)
-              out_color_byte = 0xFF; // white (for w%8!=0 border)
-            }
-          } // end pixel
-          uint16_t yrow = y + (flip ? h - row - 1 : row);
-          // display.writeImage(output_row_mono_buffer, output_row_color_buffer,
-          // x,
-          //                    yrow, w, 1);
-          display.drawBitmap(x, yrow, output_row_mono_buffer, w, 1,
-                             GxEPD_BLACK);
-        } // end line
-        Serial.print("loaded in ");
-        Serial.print(millis() - startTime);
-        Serial.println(" ms");
+        writeFrame(pass == 1);
+      }
+      if (pass == 0) {
+        display.epd2.refresh(false);
       }
-    } else {
-      Serial.println("Invalid bitmap format and plane count");
-      Serial.print("planes: ");
-      Serial.println(planes);
-      Serial.print("format: ");
-      Serial.println(format);
     }
-  } else {
-    Serial.println("Not a bitmap");
+    display.epd2.powerOff();
+    canvas.top = 0;
   }
-  file.close();
-  if (!valid) {
-    Serial.println("bitmap format not handled.");
+  const FrameHash frame = {black.hash, Traits::COLOR ? color.hash : 0};
+  return frame;
+}
+
+// Shows the recorded screen with a full refresh
+void showScreen() {
+  typedef DisplayTraits<Display> Traits;
+  renderScreen();
+  if (Traits::PAGE_HEIGHT == Traits::HEIGHT) {
+    displayFrame();
   }
 }
 
-const char* getMeteoconIcon(uint16_t id, bool nightVersion = false) {
-  if (nightVersion && id / 100 == 8)
-    id += 1000;
-
-  if (id / 100 == 2)
-    return "thunderstorm";
-  if (id / 100 == 3)
-    return "drizzle";
-  if (id / 100 == 4)
-    return "unknown";
-  if (id == 500)
-    return "light-rain";
-  else if (id == 511)
-    return "sleet";
-  else if (id / 100 == 5)
-    return "rain";
-  if (id >= 611 && id <= 616)
-    return "sleet";
-  else if (id / 100 == 6)
-    return "snow";
-  if (id / 100 == 7)
-    return "fog";
-  if (id == 800)
-    return "clear-day";
-  if (id == 801)
-    return "partly-cloudy-day";
-  if (id == 802)
-    return "cloudy";
-  if (id == 803)
-    return "cloudy";
-  if (id == 804)
-    return "cloudy";
-  if (id == 1800)
-    return "clear-night";
-  if (id == 1801)
-    return "partly-cloudy-night";
-  if (id == 1802)
-    return "cloudy";
-  if (id == 1803)
-    return "cloudy";
-  if (id == 1804)
-    return "cloudy";
-
-  return "unknown";
+#ifdef BENCHMARK_TEXT
+void benchmarkText() {
+  const GFXfont* fonts[] = {FONT_9PT, FONT_12PT, FONT_18PT, FONT_24PT};
+  const char* texts[] = {"-", " (", " Sun  ", "Battery low", "Thunderstorm"};
+  const uint16_t runs = 1000;
+  volatile uint16_t sink;
+  for (const GFXfont* font : fonts) {
+    canvas.setFont(font);
+    for (const char* text : texts) {
+      int16_t tx, ty;
+      uint16_t tw, th;
+      uint32_t start = micros();
+      for (uint16_t i = 0; i < runs; i++) {
+        canvas.getTextBounds(text, 0, 0, &tx, &ty, &tw, &th);
+      }
+      const uint32_t gfxTime = micros() - start;
+      start = micros();
+      for (uint16_t i = 0; i < runs; i++) {
+        sink = getWidthOfText(text) + getHeightOfText(text);
+      }
+      const uint32_t metricsTime = micros() - start;
+      Serial.print("Benchmark \"");
+      Serial.print(text);
+      Serial.print("\": getTextBounds ");
+      Serial.print(gfxTime * 1000 / runs);
+      Serial.print(" ns, metrics ");
+      Serial.print(metricsTime * 1000 / runs);
+      Serial.print(" ns");
+      if (getWidthOfText(text) != tw || getHeightOfText(text) != th) {
+        Serial.print(", mismatch");
+      }
+      Serial.println();
+    }
+  }
+  (void)sink;
+
+#ifdef USE_GLYPH_CACHE
+  // A forecast row through drawChar() and through the glyph cache, the
+  // first cached draw unpacks the glyphs and isn't timed
+  const char* row = " Sun   Mon   Tue   Wed   Thu  ";
+  const uint8_t textRuns = 10;
+  const uint8_t* buffer = canvas.black;
+  for (const GFXfont* font : fonts) {
+    canvas.setFont(font);
+    canvas.fillScreen(GxEPD_WHITE);
+    uint32_t start = micros();
+    for (uint8_t i = 0; i < textRuns; i++) {
+      canvas.setCursor(0, 40);
+      canvas.print(row);
+    }
+    const uint32_t gfxTime = micros() - start;
+    Fingerprint gfxFrame;
+    addBytes(gfxFrame, buffer, sizeof(DisplayTraits<Display>::Buffer));
+    canvas.fillScreen(GxEPD_WHITE);
+    canvas.setCursor(0, 40);
+    drawText((const uint8_t*)row, strlen(row));
+    start = micros();
+    for (uint8_t i = 0; i < textRuns; i++) {
+      canvas.setCursor(0, 40);
+      drawText((const uint8_t*)row, strlen(row));
+    }
+    const uint32_t blitTime = micros() - start;
+    Fingerprint blitFrame;
+    addBytes(blitFrame, buffer, sizeof(DisplayTraits<Display>::Buffer));
+    Serial.print("Benchmark row at ");
+    Serial.print(font->yAdvance);
+    Serial.print(" px line height: drawChar ");
+    Serial.print(gfxTime / textRuns);
+    Serial.print(" us, glyph cache ");
+    Serial.print(blitTime / textRuns);
+    Serial.print(" us");
+    if (gfxFrame.hash != blitFrame.hash) {
+      Serial.print(", pixels differ");
+    }
+    Serial.println();
+  }
+  Serial.print("Glyph cache: ");
+  Serial.print(glyphCache.used);
+  Serial.println(" bytes");
+#endif
+  canvas.fillScreen(GxEPD_WHITE);
+  canvas.setFont(FONT_9PT);
 }
+#endif
 
-uint16_t getWidthOfText(const char* text) {
-  int16_t tx, ty;
-  uint16_t tw, th;
-  display.getTextBounds(text, 0, 0, &tx, &ty, &tw, &th);
-  return tw;
+void recordDisplay(bool skipped) {
+  const uint32_t now = current.dt != 0 ? current.dt : time(nullptr);
+  if (now / 86400 != displayStats.day) {
+    if (displayStats.wakes > 0) {
+      Serial.print("Display skipped on ");
+      Serial.print(displayStats.skips);
+      Serial.print(" of ");
+      Serial.print(displayStats.wakes);
+      Serial.println(" wakes yesterday");
+    }
+    displayStats = DisplayStats();
+    displayStats.day = now / 86400;
+  }
+  displayStats.wakes++;
+  if (skipped) {
+    displayStats.skips++;
+  }
+  Serial.print("Display skipped today: ");
+  Serial.print(displayStats.skips);
+  Serial.print("/");
+  Serial.print(displayStats.wakes);
+  Serial.print(" (");
+  Serial.print(displayStats.skips * 100 / displayStats.wakes);
+  Serial.println("%)");
 }
 
-uint16_t getHeightOfText(const char* text) {
-  int16_t tx, ty;
-  uint16_t tw, th;
-  display.getTextBounds(text, 0, 0, &tx, &ty, &tw, &th);
-  return th;
+// Refreshes only the rectangles whose tiles changed since the last frame,
+// or the whole panel when that is due or cheaper. Tiles only cover the black
+// plane, three color panels always get a full refresh. So does a wake whose
+// snapshot wasn't restored, the controller RAM can't be trusted after deep
+// sleep.
+void refreshChangedTiles() {
+  typedef DisplayTraits<Display> Traits;
+  TileRect rects[MAX_REFRESH_RECTS];
+  uint32_t area = 0;
+  const uint32_t panelArea = (uint32_t)Traits::WIDTH * Traits::HEIGHT;
+  const bool compared = !Traits::COLOR && frameRestored && tileState.valid;
+  const uint8_t count =
+      diffTiles(tileState, canvas.black, Traits::WIDTH, Traits::HEIGHT, rects,
+                area);
+  const uint32_t start = millis();
+  if (!compared || tileState.partialRefreshes >= FULL_REFRESH_EVERY ||
+      area * 2 > panelArea) {
+    displayFrame();
+    tileState.partialRefreshes = 0;
+    area = panelArea;
+    Serial.print("Full refresh");
+  } else if (count == 0) {
+    Serial.print("No tiles changed, refresh skipped");
+  } else {
+    for (uint8_t i = 0; i < count; i++) {
+      displayFrameRect(rects[i]);
+    }
+    tileState.partialRefreshes++;
+    Serial.print("Partial refresh of ");
+    Serial.print(count);
+    Serial.print(" rects");
+  }
+  Serial.print(", ");
+  Serial.print(area);
+  Serial.print(" of ");
+  Serial.print(panelArea);
+  Serial.print(" px in ");
+  Serial.print(millis() - start);
+  Serial.println(" ms");
 }
 
-uint16_t printTemperature(float t, const char* unit, uint16_t x, uint16_t y) {
-  uint16_t totalWidth = 0;
-  const String temp = String(t, 0);
-  display.setFont(&FreeMono18pt7b);
-  display.setCursor(x, y);
-  display.print(temp);
-  uint16_t tw = getWidthOfText(temp.c_str());
-  totalWidth += tw + 2;
-  display.setFont(&FreeMono9pt7b);
-  const uint16_t nx = x + tw + 6;
-  const uint16_t ny = y - 10;
-  display.setCursor(nx, ny);
-  display.print(unit);
-  tw = getWidthOfText(temp.c_str());
-  totalWidth += tw + 4;
-  return totalWidth;
+// Compresses the frame buffer after a refresh, frameHash is its hash from
+// renderScreen(). Only called with a full frame buffer. Three color panels
+// have no partial refresh to restore the previous frame for.
+void saveFrameSnapshot(uint32_t frameHash) {
+  typedef DisplayTraits<Display> Traits;
+  if (Traits::COLOR) {
+    return;
+  }
+  if (frameSnapshot.valid && frameSnapshot.hash == frameHash) {
+    Serial.println("Frame snapshot unchanged");
+    return;
+  }
+  const uint8_t* buffer = canvas.black;
+  const uint32_t length = sizeof(Traits::Buffer);
+  const uint32_t start = micros();
+  frameSnapshot.valid = false;
+  frameSnapshot.inFlash = false;
+  frameSnapshot.size =
+      encodeFrame(buffer, length, Traits::WIDTH / 8, frameSnapshotData,
+                  sizeof(frameSnapshotData));
+  bool saved = frameSnapshot.size != 0;
+  uint8_t* encoded = nullptr;
+  if (!saved) {
+    const uint32_t capacity = maxEncodedFrameSize(length);
+    encoded = (uint8_t*)malloc(capacity);
+    if (encoded != nullptr) {
+      frameSnapshot.size =
+          encodeFrame(buffer, length, Traits::WIDTH / 8, encoded, capacity);
+    }
+  }
+  const uint32_t encodeTime = micros() - start;
+  if (encoded != nullptr) {
+    fs::File file = SPIFFS.open(FRAME_SNAPSHOT_PATH, "w");
+    saved = file && file.write(encoded, frameSnapshot.size) ==
+                        frameSnapshot.size;
+    file.close();
+    free(encoded);
+    frameSnapshot.inFlash = true;
+  }
+  if (!saved) {
+    Serial.println("Failed to save frame snapshot");
+    return;
+  }
+  frameSnapshot.valid = true;
+  frameSnapshot.hash = frameHash;
+  Serial.print("Frame snapshot: ");
+  Serial.print(frameSnapshot.size);
+  Serial.print(" of ");
+  Serial.print(length);
+  Serial.print(" bytes (");
+  Serial.print((float)length / frameSnapshot.size, 1);
+  Serial.print(":1) in ");
+  Serial.print(frameSnapshot.inFlash ? FRAME_SNAPSHOT_PATH : "RTC memory");
+  Serial.print(", encoded in ");
+  Serial.print(encodeTime);
+  Serial.println(" us");
 }
 
-bool isDuringNight(uint32_t t) {
-  for (uint8_t i = 0; i < MAX_DAYS; i++) {
-    const uint32_t sunrise = daily.sunrise[i] + ow.timezoneOffset;
-    const uint32_t sunset = daily.sunset[i] + ow.timezoneOffset;
-    if (day(sunrise) == day(t) && month(sunrise) == month(t)) {
-      return t < sunrise || t > sunset;
+// Decodes the snapshot into the frame buffer, false when there is none or it
+// doesn't match its hash
+bool loadFrameSnapshot() {
+  typedef DisplayTraits<Display> Traits;
+  if (!frameSnapshot.valid || Traits::PAGE_HEIGHT != Traits::HEIGHT) {
+    return false;
+  }
+  uint8_t* buffer = canvas.black;
+  const uint32_t length = sizeof(Traits::Buffer);
+  const uint8_t* encoded = frameSnapshotData;
+  uint8_t* loaded = nullptr;
+  if (frameSnapshot.inFlash) {
+    fs::File file = SPIFFS.open(FRAME_SNAPSHOT_PATH, "r");
+    loaded = (uint8_t*)malloc(frameSnapshot.size);
+    if (loaded == nullptr || !file ||
+        file.read(loaded, frameSnapshot.size) != frameSnapshot.size) {
+      free(loaded);
+      loaded = nullptr;
     }
+    file.close();
+    encoded = loaded;
   }
-  return false;
+  const uint32_t start = micros();
+  bool valid = encoded != nullptr &&
+               decodeFrame(encoded, frameSnapshot.size, buffer, length,
+                           Traits::WIDTH / 8);
+  const uint32_t decodeTime = micros() - start;
+  free(loaded);
+  if (valid) {
+    Fingerprint frame;
+    addBytes(frame, buffer, length);
+    valid = frame.hash == frameSnapshot.hash;
+  }
+  if (!valid) {
+    Serial.println("Frame snapshot invalid");
+    frameSnapshot.valid = false;
+    canvas.fillScreen(GxEPD_WHITE);
+    return false;
+  }
+  Serial.print("Frame snapshot decoded in ");
+  Serial.print(decodeTime);
+  Serial.println(" us");
+  return true;
 }
 
-void displayWeather() {
-  Serial.println("Displaying weather");
-  display.setTextColor(GxEPD_BLACK);
-  display.fillScreen(GxEPD_WHITE);
+// Puts the last weather frame back into the controller's RAM as both the
+// previous and current frame, so partial refreshes are against what the
+// panel shows even when the controller lost it over deep sleep. Leaves the
+// frame buffer white. Without a snapshot the next refresh is a full one.
+void restoreFrameSnapshot() {
+  typedef DisplayTraits<Display> Traits;
+  if (!loadFrameSnapshot()) {
+    return;
+  }
+  // Only saved for GxEPD2_BW, three color drivers have no writeImageAgain()
+#if IS_GxEPD2_BW(GxEPD2_DISPLAY_CLASS)
+  display.epd2.writeImageAgain(canvas.black, 0, 0, Traits::WIDTH,
+                               Traits::HEIGHT);
+  frameRestored = true;
+#endif
+  canvas.fillScreen(GxEPD_WHITE);
+  Serial.println("Frame snapshot restored to the controller");
+}
 
-  Serial.print("Heap: ");
-  Serial.print(ESP.getFreeHeap() / 1024);
-  Serial.println(" KiB");
+// Sends the frame the panel shows, the one rendered this wake or else the
+// snapshot, as described in include/ScreenGrab.h
+void sendScreenGrab() {
+  typedef DisplayTraits<Display> Traits;
+  if (Traits::PAGE_HEIGHT != Traits::HEIGHT) {
+    Serial.println("Screen grab needs a full frame buffer");
+    return;
+  }
+  if (!frameRendered && !loadFrameSnapshot()) {
+    Serial.println("Screen grab: no frame to send");
+    return;
+  }
+  frameRendered = true;
+  const uint8_t* planes[] = {canvas.black, canvas.color};
+  const uint32_t length = sizeof(Traits::Buffer);
+  const uint32_t capacity = maxEncodedFrameSize(length);
+  uint8_t* encoded = (uint8_t*)malloc(capacity);
+  if (encoded == nullptr) {
+    Serial.println("Screen grab: out of memory");
+    return;
+  }
+  ScreenGrabHeader header = {};
+  header.magic = SCREEN_GRAB_MAGIC;
+  header.version = SCREEN_GRAB_VERSION;
+  header.rotation = canvas.getRotation();
+  header.width = Traits::WIDTH;
+  header.height = Traits::HEIGHT;
+  header.planes = Traits::COLOR ? 2 : 1;
+  const uint32_t start = millis();
+  uint32_t sent = sizeof(header);
+  Serial.write((const uint8_t*)&header, sizeof(header));
+  for (uint8_t i = 0; i < header.planes; i++) {
+    ScreenGrabPlane plane;
+    plane.size =
+        encodeFrame(planes[i], length, Traits::WIDTH / 8, encoded, capacity);
+    Fingerprint frame;
+    addBytes(frame, planes[i], length);
+    plane.hash = frame.hash;
+    Serial.write((const uint8_t*)&plane, sizeof(plane));
+    Serial.write(encoded, plane.size);
+    sent += sizeof(plane) + plane.size;
+  }
+  Serial.flush();
+  free(encoded);
+  Serial.println();
+  Serial.print("Screen grab: ");
+  Serial.print(sent);
+  Serial.print(" bytes sent in ");
+  Serial.print(millis() - start);
+  Serial.print(" ms, a raw frame takes ");
+  // 10 bits per byte with the start and stop bits
+  Serial.print(length * header.planes * 10 * 1000 / SERIAL_SPEED);
+  Serial.println(" ms");
+}
 
-  drawBitmapFromSpiffs(
-      String("/icon/" +
-             String(getMeteoconIcon(
-                 current.id, isDuringNight(current.dt + ow.timezoneOffset))) +
-             ".bmp")
-          .c_str(),
-      2, 2);
-
-  display.setFont(&FreeMono9pt7b);
-  display.setCursor(103, 21);
-  display.print(georev.name);
-  display.print(", ");
-  display.print(georev.state);
-  display.print(", ");
-  display.print(georev.country);
-
-  uint16_t currY = 53;
-  uint16_t currX = 100;
-
-  display.setCursor(currX, currY);
-  display.setFont(current.main.length() > 10 ? &FreeMono18pt7b
-                                             : &FreeMono24pt7b);
-  display.print(current.main);
-  currY += getHeightOfText(current.main.c_str()) + 6;
-
-  currX += printTemperature(
-      current.temp, strcmp(units, "imperial") == 0 ? "oF" : "oC", currX, currY);
-  display.setFont(&FreeMono18pt7b);
-  display.setCursor(currX, currY);
-  display.print(" (");
-  currX += getWidthOfText(" (");
-  currX += printTemperature(daily.temp_min[0],
-                            strcmp(units, "imperial") == 0 ? "oF" : "oC", currX,
-                            currY);
-  display.setFont(&FreeMono18pt7b);
-  display.setCursor(currX, currY);
-  display.print("-");
-  currX += getWidthOfText("-") + 2;
-  currX += printTemperature(daily.temp_max[0],
-                            strcmp(units, "imperial") == 0 ? "oF" : "oC", currX,
-                            currY);
-  display.setFont(&FreeMono18pt7b);
-  display.setCursor(currX, currY);
-  display.print(")");
-  currX += getWidthOfText(")");
-
-  currX = 2;
-  display.setFont(&FreeMono12pt7b);
-  display.setCursor(currX, 114);
-  display.print("Humidity: ");
-  display.print(current.humidity);
-  display.print("%");
-
-  const char* batt = battState == BATTERY_CHARGING
-                         ? "Charging"
-                         : (battState == BATTERY_LOW ? "Battery low" : "");
-  const uint16_t width = getWidthOfText(batt) + getWidthOfText("#");
-  Serial.println("Battery text: ");
-  Serial.println(batt);
-  currX = display.width() - width - 2;
-  Serial.println(currX);
-  display.setFont(&FreeMono12pt7b);
-  display.setCursor(currX, 114);
-  display.print(batt);
-
-  // display.setCursor(currX, 136);
-  // display.print("Wind: ");
-  // display.print(round(current.wind_speed), 0);
-  // if (strcmp(units, "imperial") == 0) {
-  //   display.print(" mph ");
-  // } else {
-  //   display.print(" m/s ");
-  // }
-  // uint16_t windAngle = (current.wind_deg + 22.5) / 45;
-  // if (windAngle > 7) {
-  //   windAngle = 0;
-  // }
-  // const char* windText[] = {"N", "NE", "E", "SE", "S", "SW", "W", "NW"};
-  // display.print(windText[windAngle]);
-
-  // display.setCursor(currX, 158);
-  // display.print("UV index: ");
-  // display.print(round(current.uvi), 0);
-  // // https://www.epa.gov/sunsafety/uv-index-scale-0
-  // if (current.uvi >= 11) {
-  //   display.print(" (extreme)");
-  // } else if (current.uvi >= 8) {
-  //   display.print(" (very high)");
-  // } else if (current.uvi >= 6) {
-  //   display.print(" (high)");
-  // } else if (current.uvi >= 3) {
-  //   display.print(" (moderate)");
-  // } else {
-  //   display.print(" (low)");
-  // }
-
-  display.setFont(&FreeMono12pt7b);
-
-  const uint8_t charWidth = getWidthOfText("-");
-  uint16_t x = 2;
-  uint16_t y = 128;
-  const uint16_t itemWidth = getWidthOfText(" Sun  ") + charWidth * 0.75 + 2;
+// Answers SCREEN_GRAB_COMMAND lines on the serial port for window ms
+void serveScreenGrab(uint32_t window) {
+  char line[16];
+  uint8_t length = 0;
+  const uint32_t start = millis();
+  while (millis() - start < window) {
+    const int c = Serial.read();
+    if (c < 0) {
+      delay(1);
+    } else if (c == '\n') {
+      line[length] = '\0';
+      length = 0;
+      if (strcmp(line, SCREEN_GRAB_COMMAND) == 0) {
+        sendScreenGrab();
+        // The host repeats the command until it gets an answer
+        while (Serial.read() >= 0) {
+        }
+      }
+    } else if (c != '\r' && length < sizeof(line) - 1) {
+      line[length++] = c;
+    }
+  }
+}
 
-  for (uint8_t i = 0; i < MAX_HOURS; i++) {
+static_assert(WEATHER_HOURS == MAX_HOURS && WEATHER_DAYS == MAX_DAYS - 1,
+              "the weather screen shows every hour and day after today");
+
+// What the weather screen shows of the last fetch, in local time
+WeatherView weatherView() {
+  WeatherView view;
+  view.name = georev.name;
+  view.state = georev.state;
+  view.country = georev.country;
+  view.imperial = strcmp(units, "imperial") == 0;
+  view.main = current.main.c_str();
+  view.icon = getMeteoconIcon(
+      current.id, isNight(dayNight, current.dt + ow.timezoneOffset));
+  view.temp = current.temp;
+  view.tempMin = daily.temp_min[0];
+  view.tempMax = daily.temp_max[0];
+  view.humidity = current.humidity;
+  view.battery = battState;
+  // Only alerts that haven't ended by the time of the fetch
+  view.alert =
+      current.alert_end > current.dt ? current.alert_event.c_str() : "";
+  for (uint8_t i = 0; i < WEATHER_HOURS; i++) {
     const uint32_t d = hourly.dt[i] + ow.timezoneOffset;
-    Serial.print("Forecast for ");
-    char timeBuf[6];
-    snprintf(timeBuf, 6, "%02d:%02d", hour(d), minute(d));
-    timeBuf[5] = 0;
-    Serial.print(strTime(d));
-    Serial.print("(");
-    Serial.print(timeBuf);
-    Serial.println(")");
-    Serial.print("Temp: ");
-    Serial.println(hourly.temp[i]);
-    display.setCursor(x, y + 14);
-    display.print(timeBuf);
-    const int16_t temp = hourly.temp[i];
-    char tempBuf[6];
-    memset(tempBuf, 0, 6);
-    snprintf(tempBuf, 6, "%d", temp);
-    display.setCursor(x + charWidth * 3 - getWidthOfText(tempBuf) / 2, y + 36);
-    display.print(tempBuf);
-    drawBitmapFromSpiffs(
-        String("/icon50/" +
-               String(getMeteoconIcon(hourly.id[i], isDuringNight(d))) + ".bmp")
-            .c_str(),
-        x + charWidth, y + 34);
-    x += itemWidth;
-  }
-
-  x = 2;
-  y = 212;
-  for (uint8_t i = 1; i < MAX_DAYS; i++) {
-    const uint32_t d = daily.dt[i] + ow.timezoneOffset;
-    Serial.print("Forecast for ");
-    Serial.println(daysOfTheWeek[weekday(d)]);
-    Serial.print("Min: ");
-    Serial.println(round(daily.temp_min[i]), 0);
-    Serial.print("Max: ");
-    Serial.println(round(daily.temp_max[i]), 0);
-    display.setCursor(x, y + 14);
-    if (i != 0) {
-      display.print(" ");
-      display.print(daysOfTheWeek[weekday(d)]);
-      display.print(" ");
-    } else {
-      display.print("Today");
-    }
-    display.setCursor(x, y + 36);
-    const int16_t tempMin = round(daily.temp_min[i]);
-    if (tempMin >= 0 && tempMin <= 9) {
-      display.print(" ");
-    }
-    display.print(tempMin, 0);
-    display.print(" ");
-    const int16_t tempMax = round(daily.temp_max[i]);
-    if (tempMax >= 0 && tempMin <= 9) {
-      display.print(" ");
-    }
-    display.print(tempMax, 0);
-    drawBitmapFromSpiffs(
-        String("/icon50/" +
-               String(getMeteoconIcon(daily.id[i], (d < daily.sunrise[i] ||
-                                                    d > daily.sunset[i]))) +
-               ".bmp")
-            .c_str(),
-        x + charWidth, y + 34);
-    x += itemWidth;
+    WeatherHour& forecast = view.hours[i];
+    forecast.hour = hour(d);
+    forecast.minute = minute(d);
+    forecast.temp = hourly.temp[i];
+    forecast.icon = getMeteoconIcon(hourly.id[i], isNight(dayNight, d));
   }
+  for (uint8_t i = 0; i < WEATHER_DAYS; i++) {
+    const uint32_t d = daily.dt[i + 1] + ow.timezoneOffset;
+    WeatherDay& forecast = view.days[i];
+    forecast.weekday = weekday(d);
+    forecast.tempMin = daily.temp_min[i + 1];
+    forecast.tempMax = daily.temp_max[i + 1];
+    forecast.icon = getMeteoconIcon(daily.id[i + 1], isNight(dayNight, d));
+  }
+  return view;
+}
 
-  display.display();
+void displayWeather() {
+  Serial.println("Displaying weather");
+  const WeatherView view = weatherView();
+  const uint32_t fingerprint = weatherFingerprint(view);
+  const bool unchanged =
+      panelRetained && tileState.valid && fingerprint == shownFingerprint;
+  recordDisplay(unchanged);
+  if (unchanged) {
+    Serial.println("Display model unchanged, skipping render and refresh");
+    return;
+  }
+  shownFingerprint = fingerprint;
 
   Serial.print("Heap: ");
   Serial.print(ESP.getFreeHeap() / 1024);
   Serial.println(" KiB");
+  const uint32_t renderStart = millis();
+  drawWeather(view);
+
+  typedef DisplayTraits<Display> Traits;
+  const bool paged = Traits::PAGE_HEIGHT != Traits::HEIGHT;
+  const FrameHash frameHash = renderScreen();
+  Serial.print(paged ? "Rendered and refreshed in " : "Rendered in ");
+  Serial.print(millis() - renderStart);
+  Serial.print(" ms, ");
+  Serial.print(screen.count);
+  Serial.print(" draw ops, ");
+  Serial.print(paged ? (Traits::HEIGHT + Traits::PAGE_HEIGHT - 1) /
+                           Traits::PAGE_HEIGHT
+                     : 1);
+  Serial.println(" pages");
+  Serial.print("Frame hash: 0x");
+  Serial.println(frameHash.black, HEX);
+  if (Traits::COLOR) {
+    Serial.print("Color plane hash: 0x");
+    Serial.println(frameHash.color, HEX);
+  }
+#ifdef GOLDEN_FRAME_HASH
+  Serial.println(frameHash.black == GOLDEN_FRAME_HASH
+                     ? "Frame matches the golden frame"
+                     : "Frame differs from the golden frame");
+#endif
+#ifdef GOLDEN_COLOR_HASH
+  Serial.println(frameHash.color == GOLDEN_COLOR_HASH
+                     ? "Color plane matches the golden frame"
+                     : "Color plane differs from the golden frame");
+#endif
+#ifndef USE_ICON_ATLAS
+  Serial.print("Icon cache: ");
+  Serial.print(iconCache.hits);
+  Serial.print(" hits, ");
+  Serial.print(iconCache.misses);
+  Serial.print(" misses, ");
+  Serial.print(iconCache.evictions);
+  Serial.print(" evictions, ");
+  Serial.print(iconCache.used);
+  Serial.println(" bytes");
+#endif
+#ifdef USE_GLYPH_CACHE
+  Serial.print("Glyph cache: ");
+  Serial.print(glyphCache.hits);
+  Serial.print(" hits, ");
+  Serial.print(glyphCache.misses);
+  Serial.print(" misses, ");
+  Serial.print(glyphCache.used);
+  Serial.println(" bytes");
+#endif
+  // Lowest free heap since boot. The heap is the DRAM left after the static
+  // frame buffer, draw list and glyph cache, so it shows what each costs.
+  Serial.print("Min free heap: ");
+  Serial.print(ESP.getMinFreeHeap() / 1024);
+  Serial.println(" KiB");
+  if (paged) {
+    // Tiles can't be compared without the whole frame, the panel got a full
+    // refresh from renderScreen() and shows this frame now
+    tileState.valid = true;
+    tileState.partialRefreshes = 0;
+  } else {
+    refreshChangedTiles();
+    saveFrameSnapshot(frameHash.black);
+  }
+
+  Serial.print("Heap: ");
+  Serial.print(ESP.getFreeHeap() / 1024);
+  Serial.print(" KiB, lowest since boot ");
+  Serial.print(ESP.getMinFreeHeap() / 1024);
+  Serial.print(" KiB, frame buffer ");
+  Serial.print(sizeof(Traits::Buffer));
+  Serial.println(" bytes");
 }
 
 void setup() {
@@ -1130,13 +1639,32 @@ void setup() {
   if (!SPIFFS.begin()) {
     Serial.println("SPIFFS failed");
   }
+#ifndef USE_ICON_ATLAS
+  iconCache.budget = ICON_CACHE_BUDGET;
+#endif
+
+  // Without an initial refresh GxEPD2 keeps what the controller shows, which
+  // is only the last weather frame after a successful timer wake
+  panelRetained = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER &&
+                  lastUpdateSuccess && tileState.valid;
+  display.init(SERIAL_SPEED, !panelRetained, 2, false);
+  canvas.begin(DisplayTraits<Display>::WIDTH, DisplayTraits<Display>::HEIGHT,
+               DisplayTraits<Display>::PAGE_HEIGHT, frameBlack,
+               DisplayTraits<Display>::COLOR ? frameColor : nullptr);
+  canvas.setRotation(0);
+  canvas.setFont(FONT_9PT);
+  canvas.setTextColor(GxEPD_BLACK);
+  canvas.fillScreen(GxEPD_WHITE);
+  if (panelRetained) {
+    restoreFrameSnapshot();
+  }
 
-  display.init(SERIAL_SPEED, true, 2, false);
-  display.setRotation(0);
-  display.setFont(&FreeMono9pt7b);
-  display.setTextColor(GxEPD_BLACK);
-  display.setFullWindow();
-  display.fillScreen(GxEPD_WHITE);
+#ifdef BENCHMARK_BITMAPS
+  benchmarkBitmaps();
+#endif
+#ifdef BENCHMARK_TEXT
+  benchmarkText();
+#endif
 
   bool showBootup = true;
 
@@ -1148,7 +1676,7 @@ void setup() {
 
   if (showBootup) {
     Serial.println("Showing bootup text");
-    display.display();
+    showScreen();
   } else {
     Serial.println("Not showing bootup text");
   }
@@ -1160,50 +1688,91 @@ void setup() {
 
   esp_sleep_enable_ext0_wakeup(USER_BTN_RTC_PIN, 0);
 
-  connectToWiFi(showBootup);
+  uint8_t failStage = OW_FAIL_NONE;
+  recordAttempt(retryState);
+  printRetryState();
+
+  if (!connectToWiFi(showBootup)) {
+    failStage = FAIL_STAGE_WIFI;
+    goto somethingFailed;
+  }
   if (strlen(georev.name) == 0) {
     Serial.println("Determined name from coordinates empty, calling reverse "
                    "geocoding API");
     updateGeocodingReverse();
   }
-  updateWeather(showBootup);
-  updateTime();
+  if (!updateWeather(showBootup)) {
+    failStage = ow.failStage;
+    disconnectFromWiFi();
+    goto somethingFailed;
+  }
+  if (updateTime() &&
+      esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER) {
+    // millis() counts from this wake, so this is when the timer fired
+    recordWake(wakeState, time(nullptr) - millis() / 1000);
+  } else {
+    skipAlignment(wakeState);
+  }
   printWeather();
   disconnectFromWiFi();
   updateBattery();
   displayWeather();
+  recordBootLatency(wakeState, millis());
 
-  const uint32_t cycleEnd = millis();
-  const uint32_t cycleTime = cycleEnd - cycleStart;
+  {
+    const uint32_t cycleEnd = millis();
+    const uint32_t cycleTime = cycleEnd - cycleStart;
 
-  Serial.print("Cycle took ");
-  Serial.print(cycleTime / 1000.0);
-  Serial.println(" seconds");
+    Serial.print("Cycle took ");
+    Serial.print(cycleTime / 1000.0);
+    Serial.println(" seconds");
+  }
 
   lastUpdateSuccess = true;
-  Serial.print("Updating again in ");
-  Serial.print(UPDATE_TIME);
-  Serial.println(" minute...");
-  delay(1000);
-  Serial.print("Deep sleeping for ");
-  Serial.print(UPDATE_TIME);
-  Serial.println(" minutes");
-  ESP.deepSleep(UPDATE_TIME * 60 * 1000000);
+  recordSuccess(retryState);
+  serveScreenGrab(1000);
+  {
+    const uint64_t sleepTime = nextSleep(wakeState, time(nullptr),
+                                         ow.timezoneOffset, UPDATE_TIME * 60,
+                                         MIN_SLEEP);
+    Serial.print("Updating again in ");
+    Serial.print((uint32_t)(sleepTime / 1000000));
+    Serial.println(" seconds...");
+    Serial.print("RTC drift: ");
+    Serial.print(wakeState.driftPpm);
+    Serial.print(" ppm, boot to display: ");
+    Serial.print(wakeState.bootLatency);
+    Serial.println(" ms");
+    Serial.print("Deep sleeping for ");
+    Serial.print((uint32_t)(sleepTime / 1000));
+    Serial.println(" ms");
+    ESP.deepSleep(sleepTime);
+  }
 
 somethingFailed:
   lastUpdateSuccess = false;
+  tileState.valid = false;
+  frameSnapshot.valid = false;
+  skipAlignment(wakeState);
+  const uint32_t backoff =
+      recordFailure(retryState, retryPolicy, failStage, esp_random());
+  printRetryState();
   Serial.print("Trying again in ");
-  Serial.print(FAIL_RETRY_TIME);
-  Serial.println(" minute...");
-  display.print("Trying again in ");
-  display.print(FAIL_RETRY_TIME);
-  display.println(" minute...");
-  display.display();
-  delay(1000);
+  Serial.print(backoff);
+  Serial.println(" seconds...");
+  screen.setTextColor(ACCENT_COLOR);
+  screen.print("Trying again in ");
+  screen.print((backoff + 30) / 60);
+  screen.print(" minutes (failure ");
+  screen.print(retryState.consecutiveFailures);
+  screen.println(")");
+  screen.setTextColor(GxEPD_BLACK);
+  showScreen();
+  serveScreenGrab(1000);
   Serial.print("Deep sleeping for ");
-  Serial.print(FAIL_RETRY_TIME);
-  Serial.println(" minutes");
-  ESP.deepSleep(FAIL_RETRY_TIME * 60 * 1000000);
+  Serial.print(backoff);
+  Serial.println(" seconds");
+  ESP.deepSleep((uint64_t)backoff * 1000000);
 }
 
 void loop() {}
@@ -0,0 +1,7 @@
+#ifndef Adafruit_SPIDevice_h
+#define Adafruit_SPIDevice_h
+
+// Adafruit_GFX.h includes the Adafruit BusIO headers, the host build has no
+// bus and ignores that library
+
+#endif
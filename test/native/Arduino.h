@@ -0,0 +1,63 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <Print.h>
+#include <WString.h>
+#include <chrono>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// Host stand-in for the parts of the Arduino core that Adafruit_GFX.cpp, the
+// screen drawing in src/ and the OpenWeather library use, so the screens
+// render and the responses parse on the host
+
+#define PROGMEM
+
+typedef bool boolean;
+
+// Time skipped by delay() in us. delay() returns at once and moves the clock
+// on instead, so the fetch deadlines of a replayed response run out without
+// the test waiting for them.
+inline unsigned long& skippedMicros() {
+  static unsigned long skipped = 0;
+  return skipped;
+}
+
+inline unsigned long micros() {
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+             .count() +
+         skippedMicros();
+}
+
+inline unsigned long millis() { return micros() / 1000; }
+
+inline void delay(unsigned long ms) { skippedMicros() += ms * 1000; }
+
+inline void yield() {}
+
+// The host has no heap to report, the fetch heap figures stay 0
+class EspClass {
+public:
+  EspClass() {}
+  uint32_t getFreeHeap() { return 0; }
+};
+static EspClass ESP;
+
+// Serial output is dropped, the tests report through Unity
+class HardwareSerial : public Print {
+public:
+  size_t write(uint8_t c) override {
+    (void)c;
+    return 1;
+  }
+  using Print::write;
+};
+static HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef client_h
+#define client_h
+
+#include <Print.h>
+
+// Host stand-in for the Client interface of the Arduino core, the part the
+// OpenWeather library reads responses through
+class Client : public Print {
+public:
+  virtual int connect(const char* host, uint16_t port) = 0;
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int read(uint8_t* buffer, size_t size) = 0;
+  virtual void flush() = 0;
+  virtual void stop() = 0;
+  virtual uint8_t connected() = 0;
+  using Print::write;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef FS_H
+#define FS_H
+
+#include <memory>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+// Host stand-in for the file system API of the ESP32 core, files of a
+// folder on the host through stdio
+namespace fs {
+
+class File {
+public:
+  File(FILE* file = nullptr) : file(file, [](FILE* f) {
+    if (f != nullptr) {
+      fclose(f);
+    }
+  }) {}
+
+  size_t read(uint8_t* buffer, size_t size) {
+    return file ? fread(buffer, 1, size, file.get()) : 0;
+  }
+  size_t write(const uint8_t* buffer, size_t size) {
+    return file ? fwrite(buffer, 1, size, file.get()) : 0;
+  }
+  bool seek(uint32_t position) {
+    return file && fseek(file.get(), position, SEEK_SET) == 0;
+  }
+  size_t size() {
+    if (!file) {
+      return 0;
+    }
+    const long position = ftell(file.get());
+    fseek(file.get(), 0, SEEK_END);
+    const long end = ftell(file.get());
+    fseek(file.get(), position, SEEK_SET);
+    return end;
+  }
+  void close() { file.reset(); }
+  explicit operator bool() const { return file != nullptr; }
+
+private:
+  std::shared_ptr<FILE> file;
+};
+
+class FS {
+public:
+  explicit FS(const char* root) : root(root) {}
+
+  File open(const char* path, const char* mode = "r") {
+    const std::string binary = std::string(mode) + "b";
+    return File(fopen((root + path).c_str(), binary.c_str()));
+  }
+  bool exists(const char* path) { return (bool)open(path); }
+
+private:
+  std::string root;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef _GxEPD2_H_
+#define _GxEPD2_H_
+
+// Host stand-in for the colors of GxEPD2.h
+
+#define GxEPD_BLACK 0x0000
+#define GxEPD_DARKGREY 0x7BEF
+#define GxEPD_LIGHTGREY 0xC618
+#define GxEPD_WHITE 0xFFFF
+#define GxEPD_RED 0xF800
+#define GxEPD_YELLOW 0xFFE0
+#define GxEPD_COLORED GxEPD_RED
+
+#endif
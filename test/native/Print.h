@@ -0,0 +1,121 @@
+#ifndef Print_h
+#define Print_h
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <WString.h>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// Host stand-in for the Arduino core Print class, number formatting follows
+// the ESP32 core so text printed on the host gives the same characters
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+      n += write(*buffer++);
+    }
+    return n;
+  }
+  size_t write(const char* str) {
+    return str == nullptr ? 0 : write((const uint8_t*)str, strlen(str));
+  }
+  size_t write(const char* buffer, size_t size) {
+    return write((const uint8_t*)buffer, size);
+  }
+
+  size_t print(const char* str) { return write(str); }
+  size_t print(const __FlashStringHelper* str) {
+    return write(reinterpret_cast<const char*>(str));
+  }
+  size_t print(const String& str) { return write(str.c_str(), str.length()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char n, int base = DEC) {
+    return print((unsigned long)n, base);
+  }
+  size_t print(int n, int base = DEC) { return print((long)n, base); }
+  size_t print(unsigned int n, int base = DEC) {
+    return print((unsigned long)n, base);
+  }
+  size_t print(long n, int base = DEC) {
+    size_t t = 0;
+    if (base == 10 && n < 0) {
+      t = print('-');
+      n = -n;
+    }
+    return printNumber((unsigned long)n, base) + t;
+  }
+  size_t print(unsigned long n, int base = DEC) {
+    return base == 0 ? write((uint8_t)n) : printNumber(n, base);
+  }
+  size_t print(double n, int digits = 2) { return printFloat(n, digits); }
+
+  size_t println() { return print("\r\n"); }
+  template <typename T> size_t println(T value) {
+    return print(value) + println();
+  }
+  template <typename T> size_t println(T value, int format) {
+    return print(value, format) + println();
+  }
+
+private:
+  size_t printNumber(unsigned long n, uint8_t base) {
+    char buf[8 * sizeof(n) + 1];
+    char* str = &buf[sizeof(buf) - 1];
+    *str = '\0';
+    if (base < 2) {
+      base = 10;
+    }
+    do {
+      const char c = n % base;
+      n /= base;
+      *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while (n);
+    return write(str);
+  }
+
+  size_t printFloat(double number, uint8_t digits) {
+    if (isnan(number)) {
+      return print("nan");
+    }
+    if (isinf(number)) {
+      return print("inf");
+    }
+    if (number > 4294967040.0 || number < -4294967040.0) {
+      return print("ovf");
+    }
+    size_t n = 0;
+    if (number < 0.0) {
+      n += print('-');
+      number = -number;
+    }
+    double rounding = 0.5;
+    for (uint8_t i = 0; i < digits; ++i) {
+      rounding /= 10.0;
+    }
+    number += rounding;
+    unsigned long intPart = (unsigned long)number;
+    double remainder = number - (double)intPart;
+    n += print(intPart);
+    if (digits > 0) {
+      n += print('.');
+    }
+    while (digits-- > 0) {
+      remainder *= 10.0;
+      const int toPrint = int(remainder);
+      n += print(toPrint);
+      remainder -= toPrint;
+    }
+    return n;
+  }
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef _SPIFFS_H_
+#define _SPIFFS_H_
+
+#include <FS.h>
+
+// The SPIFFS image is built from data/, which the tests read in place. They
+// run from the project folder.
+#ifndef SPIFFS_ROOT
+#define SPIFFS_ROOT "data"
+#endif
+
+namespace fs {
+
+class SPIFFSFS : public FS {
+public:
+  SPIFFSFS() : FS(SPIFFS_ROOT) {}
+  bool begin() { return true; }
+};
+
+} // namespace fs
+
+static fs::SPIFFSFS SPIFFS;
+
+#endif
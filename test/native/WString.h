@@ -0,0 +1,123 @@
+#ifndef String_class_h
+#define String_class_h
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// Host stand-in for the String class of the Arduino core, with the
+// conversions and operators the screens and the OpenWeather library use
+
+class __FlashStringHelper;
+#define F(string_literal)                                                      \
+  (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+// dtostrf() of the ESP32 core, which pads to width and rounds halves away
+// from zero, so String(-0.4, 0) is "-0" there and here
+inline char* dtostrf(double number, signed char width, unsigned char prec,
+                     char* s) {
+  if (isnan(number)) {
+    strcpy(s, "nan");
+    return s;
+  }
+  if (isinf(number)) {
+    strcpy(s, "inf");
+    return s;
+  }
+  char* out = s;
+  int fillme = width;
+  if (prec > 0) {
+    fillme -= prec + 1;
+  }
+  const bool negative = number < 0.0;
+  if (negative) {
+    fillme--;
+    number = -number;
+  }
+  double rounding = 2.0;
+  for (uint8_t i = 0; i < prec; ++i) {
+    rounding *= 10.0;
+  }
+  number += 1.0 / rounding;
+  double tenpow = 1.0;
+  int digitcount = 1;
+  while (number >= 10.0 * tenpow) {
+    tenpow *= 10.0;
+    digitcount++;
+  }
+  number /= tenpow;
+  fillme -= digitcount;
+  while (fillme-- > 0) {
+    *out++ = ' ';
+  }
+  if (negative) {
+    *out++ = '-';
+  }
+  digitcount += prec;
+  while (digitcount-- > 0) {
+    int digit = (int)number;
+    if (digit > 9) {
+      digit = 9;
+    }
+    *out++ = '0' + digit;
+    if (digitcount == prec && prec > 0) {
+      *out++ = '.';
+    }
+    number = (number - digit) * 10.0;
+  }
+  *out = '\0';
+  return s;
+}
+
+class String {
+public:
+  String(const char* text = "") : text(text == nullptr ? "" : text) {}
+  explicit String(char c) : text(1, c) {}
+  String(int value) : text(std::to_string(value)) {}
+  String(unsigned int value) : text(std::to_string(value)) {}
+  String(long value) : text(std::to_string(value)) {}
+  String(unsigned long value) : text(std::to_string(value)) {}
+  String(float value, unsigned int decimalPlaces = 2) {
+    char buffer[48];
+    text = dtostrf(value, decimalPlaces + 2, decimalPlaces, buffer);
+  }
+  String(double value, unsigned int decimalPlaces = 2) {
+    char buffer[48];
+    text = dtostrf(value, decimalPlaces + 2, decimalPlaces, buffer);
+  }
+
+  const char* c_str() const { return text.c_str(); }
+  unsigned int length() const { return text.size(); }
+  long toInt() const { return atol(text.c_str()); }
+  float toFloat() const { return atof(text.c_str()); }
+
+  bool operator==(const String& other) const { return text == other.text; }
+  bool operator==(const char* other) const { return text == other; }
+  bool operator!=(const String& other) const { return text != other.text; }
+  bool operator!=(const char* other) const { return text != other; }
+
+  String& operator+=(const String& other) {
+    text += other.text;
+    return *this;
+  }
+  String& operator+=(const char* other) {
+    text += other;
+    return *this;
+  }
+  String& operator+=(char c) {
+    text += c;
+    return *this;
+  }
+
+private:
+  std::string text;
+};
+
+inline String operator+(String left, const String& right) {
+  return left += right;
+}
+
+#endif
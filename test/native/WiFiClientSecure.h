@@ -0,0 +1,12 @@
+#ifndef WiFiClientSecure_h
+#define WiFiClientSecure_h
+
+#include <WiFi.h>
+
+// Host stand-in for WiFiClientSecure of the ESP32 core, see WiFi.h
+class WiFiClientSecure : public WiFiClient {
+public:
+  void setInsecure() {}
+};
+
+#endif
@@ -0,0 +1,117 @@
+#include <Screen.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unity.h>
+
+// The same icon at every depth drawBitmapFromSpiffs() handles, written by
+// tools/make_bench_bitmaps.py. bench1.bmp takes the 1bpp fast path, the
+// others the generic decoder, and each has to draw the same pixels.
+const uint16_t WIDTH = 400;
+const uint16_t HEIGHT = 300;
+const uint32_t PLANE_SIZE = WIDTH / 8 * HEIGHT;
+const uint8_t DRAW_RUNS = 20;
+
+// SPIFFS reads from data/, the bitmaps are written next to it so they don't
+// end up in the filesystem image
+const char* const BITMAP_DIR = ".pio/bitmaps";
+const char* const BITMAP_PATH = "/../.pio/bitmaps/";
+
+// The 1bpp fast path first
+static const char* const bitmaps[] = {
+    "bench1.bmp",      "bench4.bmp",  "bench8.bmp", "bench16.bmp",
+    "bench16_565.bmp", "bench24.bmp", "bench32.bmp"};
+const uint8_t BITMAP_COUNT = sizeof(bitmaps) / sizeof(bitmaps[0]);
+
+static uint8_t black[PLANE_SIZE];
+static uint8_t color[PLANE_SIZE];
+static uint8_t expected[PLANE_SIZE];
+
+static std::string path(const char* name) {
+  return BITMAP_PATH + std::string(name);
+}
+
+static void beginCanvas(bool threeColor) {
+  canvas.begin(WIDTH, HEIGHT, HEIGHT, black, threeColor ? color : nullptr);
+  canvas.setRotation(0);
+  canvas.fillScreen(GxEPD_WHITE);
+}
+
+// Draws the bitmap into a white frame at x, y
+static void draw(const char* name, int16_t x, int16_t y) {
+  canvas.fillScreen(GxEPD_WHITE);
+  drawBitmapFromSpiffs(path(name).c_str(), x, y);
+}
+
+// Every depth against the 1bpp fast path, placed inside the frame and cut
+// off at its right and bottom edge
+static void checkDepths(bool threeColor) {
+  static uint8_t uncolored[PLANE_SIZE];
+  beginCanvas(threeColor);
+  memset(uncolored, threeColor ? 0xFF : 0x00, PLANE_SIZE);
+  const int16_t positions[][2] = {{3, 5}, {WIDTH - 37, HEIGHT - 41}};
+  for (const auto& position : positions) {
+    draw(bitmaps[0], position[0], position[1]);
+    memcpy(expected, black, PLANE_SIZE);
+    for (uint8_t i = 1; i < BITMAP_COUNT; i++) {
+      const char* name = bitmaps[i];
+      draw(name, position[0], position[1]);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expected, black, PLANE_SIZE,
+                                            name);
+      if (threeColor) {
+        // Black and white pixels leave the color plane uncolored
+        TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(uncolored, color, PLANE_SIZE,
+                                              name);
+      }
+    }
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_bitmaps_are_written() {
+  const std::string command =
+      std::string("python3 tools/make_bench_bitmaps.py --output ") +
+      BITMAP_DIR;
+  TEST_ASSERT_EQUAL_MESSAGE(0, system(command.c_str()), command.c_str());
+  beginCanvas(false);
+  draw(bitmaps[0], 0, 0);
+  uint32_t drawn = 0;
+  for (uint32_t i = 0; i < PLANE_SIZE; i++) {
+    drawn += __builtin_popcount((uint8_t)~black[i]);
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(0, drawn);
+}
+
+void test_depths_match_the_1bpp_fast_path() { checkDepths(false); }
+
+void test_depths_match_the_1bpp_fast_path_in_3_colors() { checkDepths(true); }
+
+void test_benchmark_depths() {
+  beginCanvas(false);
+  char message[64];
+  for (const char* name : bitmaps) {
+    const std::string file = path(name);
+    const auto start = std::chrono::steady_clock::now();
+    for (uint8_t run = 0; run < DRAW_RUNS; run++) {
+      drawBitmapFromSpiffs(file.c_str(), 3, 5);
+    }
+    const std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    snprintf(message, sizeof(message), "%s: %.1f us per draw", name,
+             elapsed.count() / DRAW_RUNS);
+    TEST_MESSAGE(message);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_bitmaps_are_written);
+  RUN_TEST(test_depths_match_the_1bpp_fast_path);
+  RUN_TEST(test_depths_match_the_1bpp_fast_path_in_3_colors);
+  RUN_TEST(test_benchmark_depths);
+  return UNITY_END();
+}
@@ -0,0 +1,210 @@
+#include <DayNight.h>
+#include <chrono>
+#include <stdio.h>
+#include <unity.h>
+
+const uint32_t DAY = 86400;
+const uint32_t MIDNIGHT = 1792281600; // 2026-10-18 00:00 local
+const uint8_t DAYS = 6;               // MAX_DAYS of User_Setup.h
+
+static uint32_t sunrise[DAYS];
+static uint32_t sunset[DAYS];
+
+// Month and day of month of t, what TimeLib's month() and day() return
+static void civilDate(uint32_t t, uint8_t& month, uint8_t& day) {
+  // See http://howardhinnant.github.io/date_algorithms.html
+  const int32_t z = t / DAY + 719468;
+  const int32_t era = z / 146097;
+  const uint32_t doe = z - era * 146097;
+  const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const uint32_t mp = (5 * doy + 2) / 153;
+  day = doy - (153 * mp + 2) / 5 + 1;
+  month = mp < 10 ? mp + 3 : mp - 9;
+}
+
+// isDuringNight() from main.cpp before the table: the interval of the
+// calendar day t falls on decides, days without one are day
+static bool isDuringNightBefore(uint32_t t, int32_t offset) {
+  uint8_t month, day;
+  civilDate(t, month, day);
+  for (uint8_t i = 0; i < DAYS; i++) {
+    const uint32_t rise = sunrise[i] + offset;
+    const uint32_t set = sunset[i] + offset;
+    uint8_t riseMonth, riseDay;
+    civilDate(rise, riseMonth, riseDay);
+    if (riseDay == day && riseMonth == month) {
+      return t < rise || t > set;
+    }
+  }
+  return false;
+}
+
+// Sunrise and sunset in UTC for local times of day, like the API sends them
+static void setDays(int32_t offset, uint32_t rise, uint32_t set) {
+  for (uint8_t i = 0; i < DAYS; i++) {
+    sunrise[i] = MIDNIGHT + i * DAY + rise - offset;
+    sunset[i] = MIDNIGHT + i * DAY + set - offset;
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_matches_old_lookup_on_ordinary_days() {
+  const int32_t offset = -4 * 3600;
+  setDays(offset, 7 * 3600 + 12 * 60, 18 * 3600 + 9 * 60);
+  DayNightTable table;
+  buildDayNightTable(table, sunrise, sunset, DAYS, offset);
+  TEST_ASSERT_EQUAL_UINT8(DAYS, table.count);
+  for (uint32_t t = MIDNIGHT; t < MIDNIGHT + DAYS * DAY; t += 60) {
+    TEST_ASSERT_EQUAL(isDuringNightBefore(t, offset), isNight(table, t));
+  }
+}
+
+void test_boundaries_are_day() {
+  setDays(0, 6 * 3600, 18 * 3600);
+  DayNightTable table;
+  buildDayNightTable(table, sunrise, sunset, DAYS, 0);
+  TEST_ASSERT_TRUE(isNight(table, MIDNIGHT + 6 * 3600 - 1));
+  TEST_ASSERT_FALSE(isNight(table, MIDNIGHT + 6 * 3600));
+  TEST_ASSERT_FALSE(isNight(table, MIDNIGHT + 18 * 3600));
+  TEST_ASSERT_TRUE(isNight(table, MIDNIGHT + 18 * 3600 + 1));
+}
+
+void test_daylight_spanning_midnight() {
+  // Near the arctic circle in summer the sun sets after local midnight
+  const int32_t offset = 2 * 3600;
+  setDays(offset, 2 * 3600 + 50 * 60, DAY + 25 * 60);
+  DayNightTable table;
+  buildDayNightTable(table, sunrise, sunset, DAYS, offset);
+  const uint32_t afterMidnight = MIDNIGHT + DAY + 10 * 60;
+  TEST_ASSERT_FALSE(isNight(table, afterMidnight));
+  // The calendar day lookup took the next sunrise for it
+  TEST_ASSERT_TRUE(isDuringNightBefore(afterMidnight, offset));
+  TEST_ASSERT_TRUE(isNight(table, MIDNIGHT + DAY + 2 * 3600));
+  TEST_ASSERT_FALSE(isNight(table, MIDNIGHT + DAY + 12 * 3600));
+}
+
+void test_utc_offset_moves_day_boundary() {
+  // Sunset after UTC midnight but before local midnight
+  const int32_t offset = -7 * 3600;
+  setDays(offset, 6 * 3600 + 40 * 60, 19 * 3600);
+  DayNightTable table;
+  buildDayNightTable(table, sunrise, sunset, DAYS, offset);
+  TEST_ASSERT_FALSE(isNight(table, MIDNIGHT + 18 * 3600 + 59 * 60));
+  TEST_ASSERT_TRUE(isNight(table, MIDNIGHT + 23 * 3600));
+}
+
+void test_polar_day_or_night_shows_day() {
+  // The API leaves sunrise and sunset out for polar day and polar night
+  for (uint8_t i = 0; i < DAYS; i++) {
+    sunrise[i] = 0;
+    sunset[i] = 0;
+  }
+  DayNightTable table;
+  buildDayNightTable(table, sunrise, sunset, DAYS, 3600);
+  TEST_ASSERT_EQUAL_UINT8(0, table.count);
+  for (uint32_t t = MIDNIGHT; t < MIDNIGHT + DAYS * DAY; t += 3600) {
+    TEST_ASSERT_FALSE(isNight(table, t));
+  }
+}
+
+void test_polar_days_are_skipped() {
+  setDays(0, 10 * 3600, 14 * 3600);
+  sunrise[2] = 0;
+  sunset[2] = 0;
+  sunrise[3] = 0;
+  sunset[3] = 0;
+  DayNightTable table;
+  buildDayNightTable(table, sunrise, sunset, DAYS, 0);
+  TEST_ASSERT_EQUAL_UINT8(DAYS - 2, table.count);
+  TEST_ASSERT_FALSE(isNight(table, MIDNIGHT + DAY + 12 * 3600));
+  TEST_ASSERT_FALSE(isNight(table, MIDNIGHT + 4 * DAY + 12 * 3600));
+  TEST_ASSERT_TRUE(isNight(table, MIDNIGHT + 4 * DAY + 9 * 3600));
+}
+
+void test_unsorted_days_are_sorted() {
+  setDays(0, 8 * 3600, 17 * 3600);
+  uint32_t rise[3] = {sunrise[2], sunrise[0], sunrise[1]};
+  uint32_t set[3] = {sunset[2], sunset[0], sunset[1]};
+  DayNightTable table;
+  buildDayNightTable(table, rise, set, 3, 0);
+  for (uint8_t i = 1; i < table.count; i++) {
+    TEST_ASSERT_LESS_THAN_UINT32(table.sunrise[i], table.sunrise[i - 1]);
+  }
+  TEST_ASSERT_FALSE(isNight(table, MIDNIGHT + DAY + 12 * 3600));
+}
+
+void test_outside_the_table() {
+  setDays(0, 6 * 3600, 18 * 3600);
+  DayNightTable table;
+  buildDayNightTable(table, sunrise, sunset, DAYS, 0);
+  // Before the first sunrise and after the last sunset it is night, where
+  // the calendar day lookup found no interval and showed day
+  const uint32_t before = MIDNIGHT - 2 * 3600;
+  const uint32_t after = MIDNIGHT + DAYS * DAY + 3 * 3600;
+  TEST_ASSERT_TRUE(isNight(table, before));
+  TEST_ASSERT_TRUE(isNight(table, after));
+  TEST_ASSERT_FALSE(isDuringNightBefore(before, 0));
+  TEST_ASSERT_FALSE(isDuringNightBefore(after, 0));
+  TEST_ASSERT_TRUE(isNight(table, 0));
+  TEST_ASSERT_TRUE(isNight(table, 0xFFFFFFFF));
+}
+
+void test_more_days_than_table_size() {
+  uint32_t rise[MAX_DAYLIGHT_INTERVALS + 2];
+  uint32_t set[MAX_DAYLIGHT_INTERVALS + 2];
+  for (uint8_t i = 0; i < MAX_DAYLIGHT_INTERVALS + 2; i++) {
+    rise[i] = MIDNIGHT + i * DAY + 6 * 3600;
+    set[i] = MIDNIGHT + i * DAY + 18 * 3600;
+  }
+  DayNightTable table;
+  buildDayNightTable(table, rise, set, MAX_DAYLIGHT_INTERVALS + 2, 0);
+  TEST_ASSERT_EQUAL_UINT8(MAX_DAYLIGHT_INTERVALS, table.count);
+}
+
+void test_benchmark_against_calendar_day_lookup() {
+  const int32_t offset = -4 * 3600;
+  setDays(offset, 7 * 3600, 18 * 3600);
+  DayNightTable table;
+  buildDayNightTable(table, sunrise, sunset, DAYS, offset);
+  // One lookup per minute of the forecast, many times over
+  const uint32_t runs = 20;
+  const uint32_t lookups = runs * DAYS * DAY / 60;
+  uint32_t nights[2] = {0, 0};
+  double ns[2];
+  for (int method = 0; method < 2; method++) {
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t run = 0; run < runs; run++) {
+      for (uint32_t t = MIDNIGHT; t < MIDNIGHT + DAYS * DAY; t += 60) {
+        nights[method] += method == 0 ? isDuringNightBefore(t, offset)
+                                      : isNight(table, t);
+      }
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    ns[method] = elapsed.count() / lookups;
+  }
+  TEST_ASSERT_EQUAL_UINT32(nights[0], nights[1]);
+  char message[96];
+  snprintf(message, sizeof(message),
+           "isDuringNight() %.1f ns, isNight() %.1f ns per lookup", ns[0],
+           ns[1]);
+  TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_matches_old_lookup_on_ordinary_days);
+  RUN_TEST(test_boundaries_are_day);
+  RUN_TEST(test_daylight_spanning_midnight);
+  RUN_TEST(test_utc_offset_moves_day_boundary);
+  RUN_TEST(test_polar_day_or_night_shows_day);
+  RUN_TEST(test_polar_days_are_skipped);
+  RUN_TEST(test_unsorted_days_are_sorted);
+  RUN_TEST(test_outside_the_table);
+  RUN_TEST(test_more_days_than_table_size);
+  RUN_TEST(test_benchmark_against_calendar_day_lookup);
+  return UNITY_END();
+}
@@ -0,0 +1,153 @@
+#include <FrameBlit.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+// A panel small enough to try every position, with a width that is a
+// multiple of 8 like all GxEPD2 panels
+const uint16_t WIDTH = 48;
+const uint16_t HEIGHT = 32;
+const uint16_t BYTES = WIDTH / 8 * HEIGHT;
+
+static uint8_t expected[BYTES];
+static uint8_t actual[BYTES];
+static uint8_t bits[64 * 8];
+
+// Adafruit_GFX::drawBitmap() going through drawPixel()
+static void drawBitmap(const FrameTarget& target, int16_t x, int16_t y,
+                       const uint8_t* bitmap, int16_t w, int16_t h,
+                       bool white) {
+  const int16_t byteWidth = (w + 7) / 8;
+  uint8_t b = 0;
+  for (int16_t j = 0; j < h; j++, y++) {
+    for (int16_t i = 0; i < w; i++) {
+      if (i & 7) {
+        b <<= 1;
+      } else {
+        b = bitmap[j * byteWidth + i / 8];
+      }
+      if (b & 0x80) {
+        setFramePixel(target, x + i, y, white);
+      }
+    }
+  }
+}
+
+static void randomBits(uint16_t w, uint16_t h) {
+  for (uint16_t i = 0; i < (w + 7) / 8 * h; i++) {
+    bits[i] = rand();
+  }
+}
+
+// Both ways from the same random frame, erase turns set bits white
+static void compare(const FrameTarget& target, int16_t x, int16_t y,
+                    uint16_t w, uint16_t h, bool erase) {
+  const uint32_t length = target.rows * (WIDTH / 8);
+  for (uint32_t i = 0; i < length; i++) {
+    expected[i] = rand();
+  }
+  memcpy(actual, expected, length);
+  FrameTarget reference = target;
+  reference.buffer = expected;
+  FrameTarget blitted = target;
+  blitted.buffer = actual;
+  drawBitmap(reference, x, y, bits, w, h, erase);
+  if (erase) {
+    eraseBitmap(blitted, x, y, bits, w, h);
+  } else {
+    blitBitmap(blitted, x, y, bits, w, h);
+  }
+  char message[64];
+  snprintf(message, sizeof(message), "rotation %d top %d at %d, %d %dx%d",
+           target.rotation, target.top, x, y, w, h);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expected, actual, length, message);
+}
+
+// Every position around and on the panel in all rotations
+static void compareAll(uint16_t top, uint16_t rows, bool erase) {
+  const uint16_t sizes[][2] = {{8, 8}, {13, 5}, {1, 1}, {24, 17}, {61, 3}};
+  for (uint8_t rotation = 0; rotation < 4; rotation++) {
+    const FrameTarget target = {nullptr, WIDTH, HEIGHT, rotation, top, rows};
+    const int16_t width = rotation & 1 ? HEIGHT : WIDTH;
+    const int16_t height = rotation & 1 ? WIDTH : HEIGHT;
+    for (const auto& size : sizes) {
+      randomBits(size[0], size[1]);
+      for (int16_t y = -size[1] - 1; y <= height + 1; y += 3) {
+        for (int16_t x = -size[0] - 1; x <= width + 1; x++) {
+          compare(target, x, y, size[0], size[1], erase);
+        }
+      }
+    }
+  }
+}
+
+void setUp() { srand(42); }
+void tearDown() {}
+
+void test_full_frame_all_rotations() { compareAll(0, HEIGHT, false); }
+
+void test_pages_all_rotations() {
+  // Pages of 10 rows, the last one short, like GxEPD2 with a page height
+  for (uint16_t top = 0; top < HEIGHT; top += 10) {
+    compareAll(top, HEIGHT - top < 10 ? HEIGHT - top : 10, false);
+  }
+}
+
+void test_erase_all_rotations() {
+  compareAll(0, HEIGHT, true);
+  compareAll(20, 12, true);
+}
+
+void test_aligned_rows_are_whole_bytes() {
+  // An icon on a byte boundary replaces the bytes it covers
+  const FrameTarget target = {actual, WIDTH, HEIGHT, 0, 0, HEIGHT};
+  memset(actual, 0xFF, sizeof(actual));
+  memset(bits, 0xFF, 2 * 4);
+  blitBitmap(target, 16, 8, bits, 16, 4);
+  for (uint16_t row = 0; row < HEIGHT; row++) {
+    for (uint16_t col = 0; col < WIDTH / 8; col++) {
+      const bool covered = row >= 8 && row < 12 && col >= 2 && col < 4;
+      TEST_ASSERT_EQUAL_HEX8(covered ? 0x00 : 0xFF,
+                             actual[row * (WIDTH / 8) + col]);
+    }
+  }
+}
+
+void test_pixel_rotations() {
+  // The panel corner each rotation puts the origin on
+  const uint16_t corners[4][2] = {
+      {0, 0}, {WIDTH - 1, 0}, {WIDTH - 1, HEIGHT - 1}, {0, HEIGHT - 1}};
+  for (uint8_t rotation = 0; rotation < 4; rotation++) {
+    const FrameTarget target = {actual, WIDTH, HEIGHT, rotation, 0, HEIGHT};
+    memset(actual, 0xFF, sizeof(actual));
+    setFramePixel(target, 0, 0, false);
+    const uint16_t X = corners[rotation][0];
+    const uint16_t Y = corners[rotation][1];
+    TEST_ASSERT_EQUAL_HEX8(0xFF & ~(0x80 >> (X % 8)),
+                           actual[Y * (WIDTH / 8) + X / 8]);
+  }
+}
+
+void test_pixel_outside_page_is_dropped() {
+  const FrameTarget target = {actual, WIDTH, HEIGHT, 0, 10, 10};
+  memset(actual, 0xFF, sizeof(actual));
+  setFramePixel(target, 5, 9, false);
+  setFramePixel(target, 5, 20, false);
+  setFramePixel(target, WIDTH, 12, false);
+  for (uint16_t i = 0; i < 10 * (WIDTH / 8); i++) {
+    TEST_ASSERT_EQUAL_HEX8(0xFF, actual[i]);
+  }
+  setFramePixel(target, 5, 10, false);
+  TEST_ASSERT_EQUAL_HEX8(0xFB, actual[0]);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_full_frame_all_rotations);
+  RUN_TEST(test_pages_all_rotations);
+  RUN_TEST(test_erase_all_rotations);
+  RUN_TEST(test_aligned_rows_are_whole_bytes);
+  RUN_TEST(test_pixel_rotations);
+  RUN_TEST(test_pixel_outside_page_is_dropped);
+  return UNITY_END();
+}
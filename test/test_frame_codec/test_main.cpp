@@ -0,0 +1,194 @@
+#include <FrameCodec.h>
+#include <Screen.h>
+#include <WeatherScreen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+#include <vector>
+
+#include "../weather_frames/WeatherFrames.h"
+
+// GxEPD2_420, the frames are coded a plane at a time like the snapshot and
+// the screen grab of main.cpp do
+const uint16_t WIDTH = 400;
+const uint16_t HEIGHT = 300;
+const uint16_t ROW_BYTES = WIDTH / 8;
+const uint32_t PLANE_SIZE = ROW_BYTES * HEIGHT;
+
+static uint8_t black[PLANE_SIZE];
+static uint8_t color[PLANE_SIZE];
+static uint8_t decoded[PLANE_SIZE];
+static std::vector<uint8_t> encoded(maxEncodedFrameSize(PLANE_SIZE));
+
+// Renders the view the way displayWeather() does, on a black and white panel
+// or a three color one with its color plane
+static void renderFrame(const WeatherView& view, bool threeColor) {
+  canvas.begin(WIDTH, HEIGHT, HEIGHT, black, threeColor ? color : nullptr);
+  canvas.setRotation(0);
+  canvas.setFont(FONT_9PT);
+  canvas.setTextColor(GxEPD_BLACK);
+  canvas.fillScreen(GxEPD_WHITE);
+  drawWeather(view);
+  replayScreen();
+}
+
+static uint32_t encode(const uint8_t* plane, uint32_t length) {
+  return encodeFrame(plane, length, ROW_BYTES, encoded.data(),
+                     encoded.size());
+}
+
+// Encodes the plane, checks it decodes to the same bytes and returns the
+// encoded size
+static uint32_t roundTrip(const uint8_t* plane, uint32_t length,
+                          const char* name) {
+  const uint32_t size = encode(plane, length);
+  TEST_ASSERT_GREATER_THAN_UINT32_MESSAGE(0, size, name);
+  TEST_ASSERT_TRUE_MESSAGE(size <= maxEncodedFrameSize(length), name);
+  memset(decoded, 0x55, sizeof(decoded));
+  TEST_ASSERT_TRUE_MESSAGE(
+      decodeFrame(encoded.data(), size, decoded, length, ROW_BYTES), name);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(plane, decoded, length, name);
+  return size;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_rendered_frames_round_trip() {
+  char message[128];
+  for (const Frame& frame : frames) {
+    for (bool threeColor : {false, true}) {
+      renderFrame(frame.view, threeColor);
+      const uint32_t size = roundTrip(black, PLANE_SIZE, frame.name);
+      if (threeColor) {
+        const uint32_t colorSize = roundTrip(color, PLANE_SIZE, frame.name);
+        snprintf(message, sizeof(message),
+                 "%s (3C): black %u bytes (%.1f:1), color %u bytes (%.1f:1) "
+                 "of %u",
+                 frame.name, (unsigned)size, (double)PLANE_SIZE / size,
+                 (unsigned)colorSize, (double)PLANE_SIZE / colorSize,
+                 (unsigned)PLANE_SIZE);
+      } else {
+        snprintf(message, sizeof(message), "%s: %u bytes (%.1f:1) of %u",
+                 frame.name, (unsigned)size, (double)PLANE_SIZE / size,
+                 (unsigned)PLANE_SIZE);
+      }
+      TEST_MESSAGE(message);
+    }
+  }
+}
+
+// Runs around FRAME_MAX_RUN and FRAME_MIN_ZERO_RUN, and a frame of noise that
+// only fits in maxEncodedFrameSize()
+void test_edge_cases_round_trip() {
+  static uint8_t plane[PLANE_SIZE];
+  memset(plane, 0xFF, sizeof(plane));
+  TEST_ASSERT_EQUAL_UINT32((PLANE_SIZE + FRAME_MAX_RUN - 1) / FRAME_MAX_RUN,
+                           roundTrip(plane, PLANE_SIZE, "white"));
+  for (uint32_t zeros : {1u, 2u, 3u, 127u, 128u, 129u, 256u}) {
+    // A stroke in the first row, then zeros of delta up to the last byte
+    memset(plane, 0xFF, sizeof(plane));
+    const uint32_t length = ROW_BYTES + zeros;
+    for (uint32_t i = 0; i < ROW_BYTES; i += 3) {
+      plane[i] = 0x0F;
+      plane[i + ROW_BYTES] = 0x0F;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%u zeros", (unsigned)zeros);
+    roundTrip(plane, length, name);
+  }
+  srand(1);
+  for (uint32_t i = 0; i < PLANE_SIZE; i++) {
+    plane[i] = rand();
+  }
+  TEST_ASSERT_TRUE(roundTrip(plane, PLANE_SIZE, "noise") > PLANE_SIZE);
+}
+
+void test_small_capacity_fails() {
+  renderFrame(frames[0].view, false);
+  const uint32_t size = encode(black, PLANE_SIZE);
+  std::vector<uint8_t> out(size);
+  TEST_ASSERT_EQUAL_UINT32(
+      size, encodeFrame(black, PLANE_SIZE, ROW_BYTES, out.data(), size));
+  for (uint32_t capacity : {0u, 1u, size / 2, size - 1}) {
+    TEST_ASSERT_EQUAL_UINT32(0, encodeFrame(black, PLANE_SIZE, ROW_BYTES,
+                                            out.data(), capacity));
+  }
+}
+
+// Every prefix of the encoding is missing bytes of the frame or of a literal
+void test_truncated_input_fails() {
+  renderFrame(frames[2].view, false);
+  const uint32_t size = encode(black, PLANE_SIZE);
+  for (uint32_t cut = 0; cut < size; cut++) {
+    if (decodeFrame(encoded.data(), cut, decoded, PLANE_SIZE, ROW_BYTES)) {
+      char message[48];
+      snprintf(message, sizeof(message), "decoded %u of %u bytes",
+               (unsigned)cut, (unsigned)size);
+      TEST_FAIL_MESSAGE(message);
+    }
+  }
+}
+
+// Control bytes that run past the frame, bytes after its end and a frame
+// length that doesn't match are rejected. A changed literal still decodes,
+// the codec has no checksum: the screen grab hashes each plane for that.
+void test_corrupt_input_fails() {
+  renderFrame(frames[2].view, false);
+  const uint32_t size = encode(black, PLANE_SIZE);
+  std::vector<uint8_t> corrupt(encoded.begin(), encoded.begin() + size);
+
+  corrupt.push_back(FRAME_RUN_ZERO);
+  TEST_ASSERT_FALSE(decodeFrame(corrupt.data(), corrupt.size(), decoded,
+                                PLANE_SIZE, ROW_BYTES));
+  corrupt.pop_back();
+
+  // Nothing is written past the frame, the last byte here
+  decoded[PLANE_SIZE - 1] = 0x55;
+  TEST_ASSERT_FALSE(decodeFrame(corrupt.data(), size, decoded, PLANE_SIZE - 1,
+                                ROW_BYTES));
+  TEST_ASSERT_EQUAL_HEX8(0x55, decoded[PLANE_SIZE - 1]);
+  TEST_ASSERT_FALSE(decodeFrame(corrupt.data(), size, decoded, PLANE_SIZE + 1,
+                                ROW_BYTES));
+
+  // A zero run one byte longer runs past the end of the frame
+  uint32_t zeros = size;
+  for (uint32_t i = 0; i < size;) {
+    const uint8_t control = corrupt[i];
+    if (control & FRAME_RUN_ZERO) {
+      zeros = control == (FRAME_RUN_ZERO | (FRAME_MAX_RUN - 1)) ? zeros : i;
+      i++;
+    } else {
+      i += control + 2;
+    }
+  }
+  TEST_ASSERT_TRUE(zeros < size);
+  corrupt[zeros]++;
+  TEST_ASSERT_FALSE(decodeFrame(corrupt.data(), corrupt.size(), decoded,
+                                PLANE_SIZE, ROW_BYTES));
+  corrupt[zeros]--;
+
+  // A flipped literal byte decodes to a different frame
+  uint32_t literal = 0;
+  while (corrupt[literal] & FRAME_RUN_ZERO) {
+    literal++;
+  }
+  corrupt[literal + 1] ^= 0x10;
+  TEST_ASSERT_TRUE(decodeFrame(corrupt.data(), corrupt.size(), decoded,
+                               PLANE_SIZE, ROW_BYTES));
+  TEST_ASSERT_NOT_EQUAL(0, memcmp(decoded, black, PLANE_SIZE));
+
+  TEST_ASSERT_FALSE(decodeFrame(nullptr, 0, decoded, PLANE_SIZE, ROW_BYTES));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_rendered_frames_round_trip);
+  RUN_TEST(test_edge_cases_round_trip);
+  RUN_TEST(test_small_capacity_fails);
+  RUN_TEST(test_truncated_input_fails);
+  RUN_TEST(test_corrupt_input_fails);
+  return UNITY_END();
+}
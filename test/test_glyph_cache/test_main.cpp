@@ -0,0 +1,143 @@
+#include <GlyphCache.h>
+#include <Screen.h>
+#include <WeatherScreen.h>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include "../weather_frames/WeatherFrames.h"
+
+// Built with -D USE_GLYPH_CACHE by pio test -e native_glyph_cache, so
+// drawText() blits the glyphs from the glyph cache. A budget of 0 prints
+// through canvas.write() like the default build, which gives the uncached
+// frame to compare with.
+#ifndef USE_GLYPH_CACHE
+#error "test_glyph_cache needs the glyph cache build"
+#endif
+
+const uint16_t WIDTH = 400;
+const uint16_t HEIGHT = 300;
+const uint32_t PLANE_SIZE = WIDTH / 8 * HEIGHT;
+const uint8_t RENDER_RUNS = 20;
+
+static uint8_t black[PLANE_SIZE];
+static uint8_t color[PLANE_SIZE];
+
+// A black and white panel, or a three color one with its color plane
+static void beginCanvas(bool threeColor) {
+  canvas.begin(WIDTH, HEIGHT, HEIGHT, black, threeColor ? color : nullptr);
+  canvas.setRotation(0);
+  canvas.setFont(FONT_9PT);
+  canvas.setTextColor(GxEPD_BLACK);
+  canvas.fillScreen(GxEPD_WHITE);
+}
+
+// Starts a wake: the cache is empty, with all of its rows or none
+static void resetCache(uint16_t budget) {
+  clearGlyphCache(glyphCache);
+  glyphCache.budget = budget;
+  glyphCache.hits = 0;
+  glyphCache.misses = 0;
+}
+
+// Renders the view the way displayWeather() does and returns the
+// microseconds it took
+static double render(const WeatherView& view) {
+  const auto start = std::chrono::steady_clock::now();
+  drawWeather(view);
+  replayScreen();
+  const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+void setUp() {
+  beginCanvas(false);
+  resetCache(GLYPH_CACHE_SIZE);
+}
+
+void tearDown() { resetCache(GLYPH_CACHE_SIZE); }
+
+void test_cached_frames_match_the_uncached_ones() {
+  static uint8_t uncachedBlack[PLANE_SIZE];
+  static uint8_t uncachedColor[PLANE_SIZE];
+  for (const Frame& frame : frames) {
+    for (bool threeColor : {false, true}) {
+      beginCanvas(threeColor);
+      resetCache(0);
+      render(frame.view);
+      TEST_ASSERT_EQUAL_UINT32(0, glyphCache.misses);
+      memcpy(uncachedBlack, black, PLANE_SIZE);
+      memcpy(uncachedColor, color, PLANE_SIZE);
+      resetCache(GLYPH_CACHE_SIZE);
+      render(frame.view);
+      TEST_ASSERT_GREATER_THAN_UINT32(0, glyphCache.misses);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(uncachedBlack, black, PLANE_SIZE,
+                                            frame.name);
+      if (threeColor) {
+        TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(uncachedColor, color,
+                                              PLANE_SIZE, frame.name);
+      }
+    }
+  }
+}
+
+// Glyphs that don't fit fall back to drawChar(), which draws the same pixels
+void test_full_cache_falls_back_to_draw_char() {
+  static uint8_t uncached[PLANE_SIZE];
+  const Frame& frame = frames[2];
+  resetCache(0);
+  render(frame.view);
+  memcpy(uncached, black, PLANE_SIZE);
+  resetCache(GLYPH_CACHE_SIZE / 8);
+  render(frame.view);
+  TEST_ASSERT_TRUE(glyphCache.used <= GLYPH_CACHE_SIZE / 8);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(uncached, black, PLANE_SIZE);
+}
+
+void test_glyphs_are_unpacked_once() {
+  const Frame& frame = frames[0];
+  render(frame.view);
+  const uint32_t misses = glyphCache.misses;
+  const uint16_t used = glyphCache.used;
+  TEST_ASSERT_GREATER_THAN_UINT32(0, glyphCache.hits);
+  // A second render in the same wake unpacks nothing
+  render(frame.view);
+  TEST_ASSERT_EQUAL_UINT32(misses, glyphCache.misses);
+  TEST_ASSERT_EQUAL_UINT16(used, glyphCache.used);
+}
+
+// One wake renders the frame once with an empty cache, so the first render is
+// timed on its own. Without the cache every character goes through
+// drawChar().
+void test_benchmark_with_and_without_the_cache() {
+  for (const Frame& frame : frames) {
+    double first[2] = {0, 0};
+    double total[2] = {0, 0};
+    for (uint8_t run = 0; run < RENDER_RUNS; run++) {
+      for (uint8_t cached = 0; cached < 2; cached++) {
+        resetCache(cached ? GLYPH_CACHE_SIZE : 0);
+        first[cached] += render(frame.view);
+        total[cached] += render(frame.view);
+      }
+    }
+    char message[160];
+    snprintf(message, sizeof(message),
+             "%s: first render %.1f us cached, %.1f us uncached; repeated "
+             "%.1f us cached, %.1f us uncached; %u bytes, %u glyphs cached",
+             frame.name, first[1] / RENDER_RUNS, first[0] / RENDER_RUNS,
+             total[1] / RENDER_RUNS, total[0] / RENDER_RUNS,
+             (unsigned)glyphCache.used, (unsigned)glyphCache.misses);
+    TEST_MESSAGE(message);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_cached_frames_match_the_uncached_ones);
+  RUN_TEST(test_full_cache_falls_back_to_draw_char);
+  RUN_TEST(test_glyphs_are_unpacked_once);
+  RUN_TEST(test_benchmark_with_and_without_the_cache);
+  return UNITY_END();
+}
@@ -0,0 +1,178 @@
+#include <HttpSpans.h>
+#include <string.h>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+static const char RESPONSE[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Date: Sun, 18 Oct 2026 10:04:16 GMT\r\n"
+    "Content-Type: application/json; charset=utf-8\r\n"
+    "X-Forecast-API-Calls: 17\r\n"
+    "\r\n"
+    "{\"current\":{\"temp\":-0.4,\"weather\":[{\"main\":\"Snow\"}]}}";
+
+static const char* const LINES[] = {
+    "HTTP/1.1 200 OK",
+    "Date: Sun, 18 Oct 2026 10:04:16 GMT",
+    "Content-Type: application/json; charset=utf-8",
+    "X-Forecast-API-Calls: 17",
+};
+
+struct Received {
+  std::vector<std::string> lines;
+  std::string body;
+  const uint8_t* spanStart;
+  const uint8_t* spanEnd;
+  bool bodyInPlace = true;
+};
+
+static const HttpSink SINK = {
+    [](void* context, const char* line, size_t length) {
+      Received* received = static_cast<Received*>(context);
+      received->lines.push_back(std::string(line, length));
+    },
+    [](void* context, const uint8_t* data, size_t length) {
+      Received* received = static_cast<Received*>(context);
+      received->body.append(reinterpret_cast<const char*>(data), length);
+      received->bodyInPlace &= data >= received->spanStart &&
+                               data + length <= received->spanEnd;
+    },
+    nullptr};
+
+// Feeds text in spans of the given sizes, the last one repeated, each span
+// from its own buffer so nothing can be read across a span boundary
+static uint32_t feed(Received& received, const char* text, size_t length,
+                     const std::vector<size_t>& sizes) {
+  HttpSink sink = SINK;
+  sink.context = &received;
+  HttpReader reader;
+  size_t offset = 0;
+  size_t next = 0;
+  while (offset < length) {
+    size_t size = sizes[next < sizes.size() - 1 ? next++ : next];
+    if (size > length - offset) {
+      size = length - offset;
+    }
+    std::vector<uint8_t> span(text + offset, text + offset + size);
+    received.spanStart = span.data();
+    received.spanEnd = span.data() + size;
+    feedSpan(reader, span.data(), size, sink);
+    offset += size;
+  }
+  TEST_ASSERT_TRUE(reader.headerEnd);
+  return reader.copied;
+}
+
+static void checkReceived(const Received& received) {
+  TEST_ASSERT_EQUAL(4, received.lines.size());
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_EQUAL_STRING(LINES[i], received.lines[i].c_str());
+  }
+  TEST_ASSERT_EQUAL_STRING(strstr(RESPONSE, "\r\n\r\n") + 4,
+                           received.body.c_str());
+  TEST_ASSERT_TRUE(received.bodyInPlace);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_single_span_copies_nothing() {
+  Received received;
+  const uint32_t copied =
+      feed(received, RESPONSE, strlen(RESPONSE), {strlen(RESPONSE)});
+  checkReceived(received);
+  TEST_ASSERT_EQUAL_UINT32(0, copied);
+}
+
+void test_every_split_into_two_spans() {
+  const size_t length = strlen(RESPONSE);
+  const size_t header = strstr(RESPONSE, "\r\n\r\n") + 4 - RESPONSE;
+  for (size_t split = 1; split < length; split++) {
+    Received received;
+    const uint32_t copied = feed(received, RESPONSE, length, {split, length});
+    checkReceived(received);
+    // Only the one header line the split falls into is copied
+    if (split >= header) {
+      TEST_ASSERT_EQUAL_UINT32(0, copied);
+    } else {
+      TEST_ASSERT_LESS_OR_EQUAL_UINT32(48, copied);
+    }
+  }
+}
+
+void test_one_byte_spans() {
+  const size_t length = strlen(RESPONSE);
+  Received received;
+  const uint32_t copied = feed(received, RESPONSE, length, {1});
+  checkReceived(received);
+  // Every header byte but the line feeds goes through the line buffer
+  const size_t header = strstr(RESPONSE, "\r\n\r\n") + 4 - RESPONSE;
+  TEST_ASSERT_EQUAL_UINT32(header - 5, copied);
+}
+
+void test_segment_sized_spans() {
+  const size_t length = strlen(RESPONSE);
+  for (size_t size = 2; size < 64; size++) {
+    Received received;
+    feed(received, RESPONSE, length, {size});
+    checkReceived(received);
+  }
+}
+
+void test_split_body_tokens_arrive_in_order() {
+  // A number and a key split over three spans reach the body in order
+  const char* text = "HTTP/1.1 200 OK\r\n\r\n{\"temp\":-12.75}";
+  const size_t start = strchr(text, '{') - text;
+  Received received;
+  feed(received, text, strlen(text), {start + 4, 6, 3, 100});
+  TEST_ASSERT_EQUAL_STRING("{\"temp\":-12.75}", received.body.c_str());
+  TEST_ASSERT_TRUE(received.bodyInPlace);
+}
+
+void test_long_split_header_line_is_cut() {
+  std::string text = "HTTP/1.1 200 OK\r\nSet-Cookie: ";
+  text += std::string(200, 'x');
+  text += "\r\nDate: Sun, 18 Oct 2026 10:04:16 GMT\r\n\r\n{}";
+  Received received;
+  feed(received, text.c_str(), text.size(), {20});
+  TEST_ASSERT_EQUAL(3, received.lines.size());
+  TEST_ASSERT_EQUAL(HTTP_LINE_SIZE, received.lines[1].size());
+  TEST_ASSERT_EQUAL_STRING(LINES[1], received.lines[2].c_str());
+  TEST_ASSERT_EQUAL_STRING("{}", received.body.c_str());
+}
+
+void test_line_feed_only_line_ends() {
+  const char* text = "HTTP/1.1 200 OK\nDate: x\n\n[1]";
+  Received received;
+  feed(received, text, strlen(text), {7});
+  TEST_ASSERT_EQUAL(2, received.lines.size());
+  TEST_ASSERT_EQUAL_STRING("Date: x", received.lines[1].c_str());
+  TEST_ASSERT_EQUAL_STRING("[1]", received.body.c_str());
+}
+
+void test_no_body_before_header_end() {
+  const char* text = "HTTP/1.1 200 OK\r\nDate: x\r\n";
+  HttpSink sink = SINK;
+  Received received;
+  sink.context = &received;
+  received.spanStart = reinterpret_cast<const uint8_t*>(text);
+  received.spanEnd = received.spanStart + strlen(text);
+  HttpReader reader;
+  TEST_ASSERT_FALSE(feedSpan(reader, received.spanStart, strlen(text), sink));
+  TEST_ASSERT_EQUAL(2, received.lines.size());
+  TEST_ASSERT_TRUE(received.body.empty());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_span_copies_nothing);
+  RUN_TEST(test_every_split_into_two_spans);
+  RUN_TEST(test_one_byte_spans);
+  RUN_TEST(test_segment_sized_spans);
+  RUN_TEST(test_split_body_tokens_arrive_in_order);
+  RUN_TEST(test_long_split_header_line_is_cut);
+  RUN_TEST(test_line_feed_only_line_ends);
+  RUN_TEST(test_no_body_before_header_end);
+  return UNITY_END();
+}
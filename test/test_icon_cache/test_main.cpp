@@ -0,0 +1,109 @@
+#include <IconCache.h>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+static IconCache cache;
+
+// A 16 x 16 icon takes 32 bytes
+static IconCacheEntry* insert(const char* key, uint16_t size = 16) {
+  return insertIcon(cache, key, size, size);
+}
+
+void setUp() {
+  clearIconCache(cache);
+  cache = IconCache();
+  cache.budget = 8 * 1024;
+}
+
+void tearDown() { clearIconCache(cache); }
+
+void test_miss_then_hit() {
+  TEST_ASSERT_NULL(findIcon(cache, "/icon/01d.bmp"));
+  IconCacheEntry* entry = insert("/icon/01d.bmp");
+  TEST_ASSERT_NOT_NULL(entry);
+  TEST_ASSERT_EQUAL_UINT32(32, entry->size);
+  TEST_ASSERT_EQUAL_PTR(entry, findIcon(cache, "/icon/01d.bmp"));
+  TEST_ASSERT_NULL(findIcon(cache, "/icon/02d.bmp"));
+  TEST_ASSERT_EQUAL_UINT32(1, cache.hits);
+  TEST_ASSERT_EQUAL_UINT32(2, cache.misses);
+  TEST_ASSERT_EQUAL_UINT32(32, cache.used);
+}
+
+void test_full_cache_evicts_the_least_recently_used() {
+  char key[16];
+  for (uint8_t i = 0; i < ICON_CACHE_SLOTS; i++) {
+    snprintf(key, sizeof(key), "/icon/%02u.bmp", i);
+    TEST_ASSERT_NOT_NULL(insert(key));
+  }
+  // The first icon is used again, so the second is now the oldest
+  TEST_ASSERT_NOT_NULL(findIcon(cache, "/icon/00.bmp"));
+  TEST_ASSERT_NOT_NULL(insert("/icon/new.bmp"));
+  TEST_ASSERT_EQUAL_UINT32(1, cache.evictions);
+  TEST_ASSERT_NULL(findIcon(cache, "/icon/01.bmp"));
+  TEST_ASSERT_NOT_NULL(findIcon(cache, "/icon/00.bmp"));
+  TEST_ASSERT_NOT_NULL(findIcon(cache, "/icon/02.bmp"));
+  TEST_ASSERT_NOT_NULL(findIcon(cache, "/icon/new.bmp"));
+  TEST_ASSERT_EQUAL_UINT32(ICON_CACHE_SLOTS * 32, cache.used);
+}
+
+void test_budget_evicts_until_the_icon_fits() {
+  cache.budget = 100;
+  TEST_ASSERT_NOT_NULL(insert("/a.bmp"));
+  TEST_ASSERT_NOT_NULL(insert("/b.bmp"));
+  TEST_ASSERT_NOT_NULL(insert("/c.bmp"));
+  TEST_ASSERT_EQUAL_UINT32(96, cache.used);
+  // 72 bytes only fit once all three are gone
+  TEST_ASSERT_NOT_NULL(insert("/big.bmp", 24));
+  TEST_ASSERT_EQUAL_UINT32(3, cache.evictions);
+  TEST_ASSERT_EQUAL_UINT32(72, cache.used);
+  TEST_ASSERT_NULL(findIcon(cache, "/a.bmp"));
+  TEST_ASSERT_NOT_NULL(findIcon(cache, "/big.bmp"));
+}
+
+void test_icons_over_the_budget_are_not_cached() {
+  cache.budget = 100;
+  TEST_ASSERT_NOT_NULL(insert("/a.bmp"));
+  TEST_ASSERT_NULL(insert("/huge.bmp", 64));
+  // Nothing was evicted for it
+  TEST_ASSERT_NOT_NULL(findIcon(cache, "/a.bmp"));
+  TEST_ASSERT_EQUAL_UINT32(0, cache.evictions);
+
+  cache.budget = 0;
+  TEST_ASSERT_NULL(insert("/b.bmp"));
+  TEST_ASSERT_NULL(insertIcon(cache, "/empty.bmp", 0, 16));
+}
+
+void test_keys_must_fit_the_entry() {
+  char key[ICON_CACHE_KEY_LENGTH + 1];
+  memset(key, 'k', sizeof(key) - 1);
+  key[ICON_CACHE_KEY_LENGTH] = '\0';
+  TEST_ASSERT_NULL(insert(key));
+  key[ICON_CACHE_KEY_LENGTH - 1] = '\0';
+  TEST_ASSERT_NOT_NULL(insert(key));
+  TEST_ASSERT_NOT_NULL(findIcon(cache, key));
+}
+
+void test_remove_and_clear_give_the_bytes_back() {
+  TEST_ASSERT_NOT_NULL(insert("/a.bmp"));
+  TEST_ASSERT_NOT_NULL(insert("/b.bmp", 24));
+  removeIcon(cache, "/a.bmp");
+  TEST_ASSERT_EQUAL_UINT32(72, cache.used);
+  TEST_ASSERT_NULL(findIcon(cache, "/a.bmp"));
+  clearIconCache(cache);
+  TEST_ASSERT_EQUAL_UINT32(0, cache.used);
+  TEST_ASSERT_NULL(findIcon(cache, "/b.bmp"));
+  // Eviction is not counted for either
+  TEST_ASSERT_EQUAL_UINT32(0, cache.evictions);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_miss_then_hit);
+  RUN_TEST(test_full_cache_evicts_the_least_recently_used);
+  RUN_TEST(test_budget_evicts_until_the_icon_fits);
+  RUN_TEST(test_icons_over_the_budget_are_not_cached);
+  RUN_TEST(test_keys_must_fit_the_entry);
+  RUN_TEST(test_remove_and_clear_give_the_bytes_back);
+  return UNITY_END();
+}
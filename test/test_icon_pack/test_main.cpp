@@ -0,0 +1,205 @@
+#include <IconPack.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+// Icons written as BMP fixtures, packed by tools/pack_icons.py --rle --all and
+// read back through IconPack. Pixels are drawBitmap() bits, set = black.
+struct Fixture {
+  const char* name;
+  uint16_t width;
+  uint16_t height;
+  bool whiteFirst; // palette entry 0 is white, data/ has black first
+  bool topDown;    // negative height, rows stored top to bottom
+  std::vector<uint8_t> bits;
+};
+
+static std::vector<Fixture> fixtures;
+static std::string directory;
+static std::vector<uint8_t> pack;
+
+static void put16(std::vector<uint8_t>& out, uint16_t value) {
+  out.push_back(value);
+  out.push_back(value >> 8);
+}
+
+static void put32(std::vector<uint8_t>& out, uint32_t value) {
+  put16(out, value);
+  put16(out, value >> 16);
+}
+
+// A 1bpp BMP with a BITMAPINFOHEADER and a two entry palette
+static void writeBmp(const Fixture& fixture, const char* path) {
+  const uint32_t rowSize = (fixture.width + 31) / 32 * 4;
+  const uint16_t bytes = (fixture.width + 7) / 8;
+  const uint32_t offset = 14 + 40 + 8;
+  std::vector<uint8_t> out = {'B', 'M'};
+  put32(out, offset + rowSize * fixture.height);
+  put32(out, 0);
+  put32(out, offset);
+  put32(out, 40);
+  put32(out, fixture.width);
+  put32(out, fixture.topDown ? -fixture.height : fixture.height);
+  put16(out, 1);
+  put16(out, 1);
+  put32(out, 0);
+  put32(out, rowSize * fixture.height);
+  put32(out, 2835);
+  put32(out, 2835);
+  put32(out, 2);
+  put32(out, 0);
+  const uint32_t white = 0x00FFFFFF;
+  put32(out, fixture.whiteFirst ? white : 0);
+  put32(out, fixture.whiteFirst ? 0 : white);
+  for (uint16_t r = 0; r < fixture.height; r++) {
+    const uint16_t row = fixture.topDown ? r : fixture.height - 1 - r;
+    for (uint32_t i = 0; i < rowSize; i++) {
+      // A set bit is the whitish entry, which drawBitmapFromSpiffs() draws
+      // in black
+      uint8_t b = i < bytes ? fixture.bits[row * bytes + i] : 0;
+      out.push_back(fixture.whiteFirst ? ~b : b);
+    }
+  }
+  FILE* file = fopen(path, "wb");
+  TEST_ASSERT_NOT_NULL(file);
+  fwrite(out.data(), 1, out.size(), file);
+  fclose(file);
+}
+
+static Fixture makeFixture(const char* name, uint16_t width, uint16_t height,
+                           bool whiteFirst, bool topDown, bool noisy) {
+  Fixture fixture = {name, width, height, whiteFirst, topDown, {}};
+  const uint16_t bytes = (width + 7) / 8;
+  const uint8_t lastMask = 0xFF << ((8 - width % 8) % 8);
+  for (uint16_t r = 0; r < height; r++) {
+    for (uint16_t i = 0; i < bytes; i++) {
+      // A filled circle has the long runs of an icon, noise has none
+      uint8_t b = 0;
+      for (uint8_t bit = 0; bit < 8; bit++) {
+        const int32_t dx = i * 8 + bit - width / 2;
+        const int32_t dy = r - height / 2;
+        const bool set = noisy ? rand() & 1
+                               : dx * dx + dy * dy < width * height / 8;
+        b |= set << (7 - bit);
+      }
+      fixture.bits.push_back(i == bytes - 1 ? b & lastMask : b);
+    }
+  }
+  return fixture;
+}
+
+static const IconPackEntry* findFixture(const Fixture& fixture) {
+  IconPackHeader header;
+  memcpy(&header, pack.data(), sizeof(header));
+  const IconPackEntry* index =
+      reinterpret_cast<const IconPackEntry*>(pack.data() + sizeof(header));
+  const std::string path = std::string("/icon/") + fixture.name;
+  return findPackEntry(index, header.count, iconPackHash(path.c_str()));
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_pack_is_written() {
+  srand(7);
+  fixtures.push_back(makeFixture("circle.bmp", 100, 100, false, false, false));
+  fixtures.push_back(makeFixture("small.bmp", 50, 50, false, false, false));
+  fixtures.push_back(makeFixture("odd.bmp", 13, 21, false, false, false));
+  fixtures.push_back(makeFixture("inverted.bmp", 40, 30, true, false, false));
+  fixtures.push_back(makeFixture("topdown.bmp", 24, 16, false, true, false));
+  fixtures.push_back(makeFixture("noise.bmp", 64, 32, false, false, true));
+  char folder[] = "/tmp/icon_pack_XXXXXX";
+  TEST_ASSERT_NOT_NULL(mkdtemp(folder));
+  directory = folder;
+  TEST_ASSERT_EQUAL(0, system(("mkdir " + directory + "/icon").c_str()));
+  for (const Fixture& fixture : fixtures) {
+    writeBmp(fixture, (directory + "/icon/" + fixture.name).c_str());
+  }
+  const std::string output = directory + "/icons.pack";
+  const std::string command = "python3 tools/pack_icons.py --rle --all "
+                              "--data " +
+                              directory + " --output " + output;
+  TEST_ASSERT_EQUAL_MESSAGE(0, system(command.c_str()), command.c_str());
+  FILE* file = fopen(output.c_str(), "rb");
+  TEST_ASSERT_NOT_NULL(file);
+  uint8_t buffer[4096];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    pack.insert(pack.end(), buffer, buffer + read);
+  }
+  fclose(file);
+  IconPackHeader header;
+  TEST_ASSERT_GREATER_OR_EQUAL(sizeof(header), pack.size());
+  memcpy(&header, pack.data(), sizeof(header));
+  TEST_ASSERT_EQUAL_HEX32(ICON_PACK_MAGIC, header.magic);
+  TEST_ASSERT_EQUAL_UINT8(ICON_PACK_VERSION, header.version);
+  TEST_ASSERT_EQUAL_UINT16(fixtures.size(), header.count);
+}
+
+void test_every_icon_reads_back() {
+  TEST_ASSERT_FALSE(pack.empty());
+  uint8_t encodings = 0;
+  for (const Fixture& fixture : fixtures) {
+    const IconPackEntry* entry = findFixture(fixture);
+    TEST_ASSERT_NOT_NULL_MESSAGE(entry, fixture.name);
+    TEST_ASSERT_EQUAL_UINT16(fixture.width, entry->width);
+    TEST_ASSERT_EQUAL_UINT16(fixture.height, entry->height);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(pack.size(), entry->offset + entry->size);
+    std::vector<uint8_t> bits(fixture.bits.size());
+    const uint8_t* payload = pack.data() + entry->offset;
+    if (entry->encoding == ICON_PACK_RLE) {
+      TEST_ASSERT_TRUE_MESSAGE(
+          unpackRle(payload, entry->size, bits.data(), bits.size()),
+          fixture.name);
+    } else {
+      TEST_ASSERT_EQUAL_UINT8(ICON_PACK_RAW, entry->encoding);
+      TEST_ASSERT_EQUAL_UINT32(bits.size(), entry->size);
+      memcpy(bits.data(), payload, bits.size());
+    }
+    TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(fixture.bits.data(), bits.data(),
+                                          bits.size(), fixture.name);
+    encodings |= 1 << entry->encoding;
+  }
+  // Icons are run length encoded, the noise doesn't get smaller that way
+  TEST_ASSERT_EQUAL_HEX8(1 << ICON_PACK_RAW | 1 << ICON_PACK_RLE, encodings);
+}
+
+void test_index_is_sorted() {
+  IconPackHeader header;
+  memcpy(&header, pack.data(), sizeof(header));
+  const IconPackEntry* index =
+      reinterpret_cast<const IconPackEntry*>(pack.data() + sizeof(header));
+  for (uint16_t i = 1; i < header.count; i++) {
+    TEST_ASSERT_LESS_THAN_UINT32(index[i].hash, index[i - 1].hash);
+  }
+  TEST_ASSERT_NULL(
+      findPackEntry(index, header.count, iconPackHash("/icon/missing.bmp")));
+}
+
+void test_truncated_rle_is_rejected() {
+  for (const Fixture& fixture : fixtures) {
+    const IconPackEntry* entry = findFixture(fixture);
+    if (entry == nullptr || entry->encoding != ICON_PACK_RLE) {
+      continue;
+    }
+    std::vector<uint8_t> bits(fixture.bits.size());
+    const uint8_t* payload = pack.data() + entry->offset;
+    TEST_ASSERT_FALSE(
+        unpackRle(payload, entry->size - 1, bits.data(), bits.size()));
+    TEST_ASSERT_FALSE(
+        unpackRle(payload, entry->size, bits.data(), bits.size() - 1));
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_pack_is_written);
+  RUN_TEST(test_every_icon_reads_back);
+  RUN_TEST(test_index_is_sorted);
+  RUN_TEST(test_truncated_rle_is_rejected);
+  system(("rm -r " + directory).c_str());
+  return UNITY_END();
+}
@@ -0,0 +1,534 @@
+#include <Arduino.h>
+#include <DayNight.h>
+#include <OpenWeather.h>
+#include <RetryPolicy.h>
+#include <stdio.h>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+// Replays the payloads tools/mock_openweather.py serves through the real
+// OW_Weather request and parse code, under the same network scenarios. Time
+// passes on the host clock of test/native/Arduino.h, a 10 s stall takes no
+// 10 s to test. Payloads are replayed whole, where the mock cuts Open-Meteo
+// ones to the hours and days requested.
+const char* const PAYLOAD_DIR = "tools/payloads/";
+
+// Date header of the replayed responses and its unix time
+const char* const SERVER_DATE = "Sun, 13 Oct 2024 18:05:12 GMT";
+const uint32_t SERVER_TIME = 1728842712;
+
+// CONNECT_TIMEOUT, HEADER_TIMEOUT, BODY_TIMEOUT and STALL_TIMEOUT of main.cpp
+const uint32_t TIMEOUTS[] = {5000, 5000, 8000, 3000};
+
+const uint8_t SCENARIO_RUNS = 5;
+
+// SCENARIOS of tools/mock_openweather.py, times in ms
+struct Scenario {
+  const char* name;
+  uint32_t latency;   // Before the first byte
+  uint32_t bandwidth; // Bytes per second, 0 for no limit
+  uint32_t drip;      // After every header line
+  float truncate;     // Body fraction sent before the server closes
+  float reset;        // Body fraction sent before the server resets
+  bool stall;         // STALL_TIME of silence halfway through the body
+};
+
+const uint32_t STALL_TIME = 10000;
+
+static const Scenario scenarios[] = {
+    {"normal", 0, 0, 0, 0.0f, 0.0f, false},
+    {"latency", 1500, 0, 0, 0.0f, 0.0f, false},
+    {"slow-link", 200, 2000, 0, 0.0f, 0.0f, false},
+    {"slow-headers", 0, 0, 1500, 0.0f, 0.0f, false},
+    {"stall", 0, 0, 0, 0.0f, 0.0f, true},
+    {"stall-reset", 0, 0, 0, 0.0f, 0.5f, true},
+    {"truncate", 0, 0, 0, 0.5f, 0.0f, false},
+    {"reset", 0, 0, 0, 0.0f, 0.5f, false},
+};
+
+static std::string readPayload(const char* name) {
+  std::string data;
+  FILE* file = fopen((std::string(PAYLOAD_DIR) + name).c_str(), "rb");
+  if (file == nullptr) {
+    return data;
+  }
+  char buffer[1024];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.append(buffer, count);
+  }
+  fclose(file);
+  return data;
+}
+
+// Sends one response the way the mock server's Handler does: the latency,
+// every header line followed by the drip, then the body in chunks paced by
+// the bandwidth. Bytes become readable once the host clock reaches them. lwIP
+// keeps what arrived before a reset readable, so a reset ends the response
+// like a close.
+class ReplayClient : public Client {
+public:
+  ReplayClient(const Scenario& scenario, const std::string& body) {
+    uint32_t t = scenario.latency;
+    const std::string lines[] = {
+        "HTTP/1.1 200 OK",
+        "Content-Type: application/json; charset=utf-8",
+        "Content-Length: " + std::to_string(body.size()),
+        std::string("Date: ") + SERVER_DATE, "Connection: close"};
+    for (const std::string& line : lines) {
+      send(line + "\r\n", t);
+      t += scenario.drip;
+    }
+    send("\r\n", t);
+
+    size_t limit = body.size();
+    if (scenario.truncate > 0) {
+      limit = body.size() * scenario.truncate;
+    }
+    if (scenario.reset > 0) {
+      limit = body.size() * scenario.reset;
+    }
+    const size_t chunk =
+        scenario.bandwidth ? std::max<size_t>(64, scenario.bandwidth / 20)
+                           : 1460;
+    bool stalled = false;
+    for (size_t sent = 0; sent < limit;) {
+      const size_t part = std::min(chunk, limit - sent);
+      send(body.substr(sent, part), t);
+      sent += part;
+      if (scenario.bandwidth) {
+        t += part * 1000 / scenario.bandwidth;
+      }
+      if (scenario.stall && !stalled && sent >= body.size() / 2) {
+        t += STALL_TIME;
+        stalled = true;
+      }
+    }
+    closeTime = t;
+  }
+
+  std::string request;
+
+  int connect(const char* host, uint16_t port) override {
+    (void)host;
+    (void)port;
+    start = millis();
+    position = 0;
+    stopped = false;
+    return 1;
+  }
+
+  size_t write(uint8_t c) override {
+    request += (char)c;
+    return 1;
+  }
+
+  int available() override {
+    const uint32_t now = millis() - start;
+    const size_t count = ready(now) - position;
+    if (count == 0 && now < closeTime) {
+      delay(1); // Nothing arrived yet, let the clock move on
+    }
+    return count;
+  }
+
+  int read() override {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+  }
+
+  int read(uint8_t* buffer, size_t size) override {
+    const int count = std::min<int>(available(), size);
+    if (count <= 0) {
+      return -1;
+    }
+    memcpy(buffer, data.data() + position, count);
+    position += count;
+    return count;
+  }
+
+  void flush() override {}
+  void stop() override { stopped = true; }
+  // Like the ESP32 WiFiClient, still connected while bytes are left to read
+  uint8_t connected() override {
+    const uint32_t now = millis() - start;
+    return now < closeTime || ready(now) > position;
+  }
+  using Print::write;
+
+private:
+  // Bytes up to end are sent at time ms after the connect
+  struct Step {
+    uint32_t time;
+    size_t end;
+  };
+
+  // End of the bytes received by now
+  size_t ready(uint32_t now) const {
+    if (stopped) {
+      return position;
+    }
+    size_t end = 0;
+    for (const Step& step : steps) {
+      if (step.time <= now) {
+        end = step.end;
+      }
+    }
+    return end;
+  }
+
+  void send(const std::string& bytes, uint32_t time) {
+    data += bytes;
+    steps.push_back({time, data.size()});
+  }
+
+  std::string data;
+  std::vector<Step> steps;
+  uint32_t closeTime = 0;
+  uint32_t start = 0;
+  size_t position = 0;
+  bool stopped = false;
+};
+
+static const Scenario& scenario(const char* name) {
+  for (const Scenario& scenario : scenarios) {
+    if (strcmp(scenario.name, name) == 0) {
+      return scenario;
+    }
+  }
+  TEST_FAIL_MESSAGE(name);
+  return scenarios[0];
+}
+
+static OW_Weather ow;
+static OW_current current;
+static OW_hourly hourly;
+static OW_daily daily;
+
+// Like updateWeather() in main.cpp, alerts only come with the forecast
+static bool fetchOneCall(ReplayClient& client, bool full = true) {
+  ow.setClient(&client);
+  ow.setTimeouts(TIMEOUTS[0], TIMEOUTS[1], TIMEOUTS[2], TIMEOUTS[3]);
+  const bool ok =
+      ow.getForecast(&current, full ? &hourly : nullptr,
+                     full ? &daily : nullptr, "key", "40.7128", "-74.0060",
+                     "imperial", "en", false, full);
+  ow.setClient(nullptr);
+  return ok;
+}
+
+static bool fetchOpenMeteo(ReplayClient& client) {
+  ow.setClient(&client);
+  ow.setTimeouts(TIMEOUTS[0], TIMEOUTS[1], TIMEOUTS[2], TIMEOUTS[3]);
+  const bool ok = ow.getOpenMeteoForecast(&current, &hourly, &daily,
+                                          "40.7128", "-74.0060", "imperial",
+                                          false);
+  ow.setClient(nullptr);
+  return ok;
+}
+
+void setUp() {
+  current = OW_current();
+  hourly = OW_hourly();
+  daily = OW_daily();
+}
+
+void tearDown() {}
+
+void test_payloads_are_committed() {
+  TEST_ASSERT_FALSE(readPayload("onecall.json").empty());
+  TEST_ASSERT_FALSE(readPayload("openmeteo.json").empty());
+}
+
+void test_onecall_payload_fills_the_structures() {
+  ReplayClient client(scenario("normal"), readPayload("onecall.json"));
+  TEST_ASSERT_TRUE(fetchOneCall(client));
+  TEST_ASSERT_EQUAL_UINT8(OW_FAIL_NONE, ow.failStage);
+  const char* const request = "GET https://api.openweathermap.org/data/2.5/"
+                              "onecall?lat=40.7128&lon=-74.0060&exclude="
+                              "minutely&units=imperial";
+  TEST_ASSERT_EQUAL_UINT32(0, client.request.find(request));
+  TEST_ASSERT_EQUAL_UINT32(SERVER_TIME, ow.serverTime);
+  TEST_ASSERT_EQUAL_INT32(-14400, ow.timezoneOffset);
+
+  TEST_ASSERT_EQUAL_UINT32(1728842700, current.dt);
+  TEST_ASSERT_EQUAL_FLOAT(57.31f, current.temp);
+  TEST_ASSERT_EQUAL_UINT8(64, current.humidity);
+  TEST_ASSERT_EQUAL_UINT16(803, current.id);
+  TEST_ASSERT_EQUAL_STRING("Clouds", current.main.c_str());
+
+  const float hourlyTemp[] = {57.9f, 58.6f, 59.0f, 57.2f, 54.8f};
+  const uint16_t hourlyId[] = {803, 801, 801, 500, 501};
+  for (uint8_t i = 0; i < MAX_HOURS; i++) {
+    TEST_ASSERT_EQUAL_UINT32(1728842400 + 3600 * i, hourly.dt[i]);
+    TEST_ASSERT_EQUAL_FLOAT(hourlyTemp[i], hourly.temp[i]);
+    TEST_ASSERT_EQUAL_UINT16(hourlyId[i], hourly.id[i]);
+  }
+
+  const float dailyMin[] = {49.6f, 48.2f, 45.0f, 41.7f, 44.9f, 50.1f};
+  const float dailyMax[] = {61.2f, 60.1f, 55.4f, 52.3f, 58.8f, 63.5f};
+  const uint16_t dailyId[] = {803, 501, 804, 800, 801, 300};
+  for (uint8_t i = 0; i < MAX_DAYS; i++) {
+    TEST_ASSERT_EQUAL_FLOAT(dailyMin[i], daily.temp_min[i]);
+    TEST_ASSERT_EQUAL_FLOAT(dailyMax[i], daily.temp_max[i]);
+    TEST_ASSERT_EQUAL_UINT16(dailyId[i], daily.id[i]);
+  }
+}
+
+// The payload still holds hourly and daily, as from a server ignoring exclude
+void test_current_only_fetch_excludes_the_forecast() {
+  ReplayClient client(scenario("normal"), readPayload("onecall.json"));
+  TEST_ASSERT_TRUE(fetchOneCall(client, false));
+  TEST_ASSERT_NOT_NULL(
+      strstr(client.request.c_str(), "exclude=minutely,alerts,hourly,daily&"));
+  TEST_ASSERT_EQUAL_FLOAT(57.31f, current.temp);
+  TEST_ASSERT_EQUAL_UINT32(0, hourly.dt[0]);
+  TEST_ASSERT_EQUAL_UINT32(0, daily.dt[0]);
+}
+
+// The onecall payload with an alerts block, which is only sent while there
+// are alerts
+static std::string alertPayload() {
+  std::string payload = readPayload("onecall.json");
+  const size_t end = payload.rfind('}');
+  TEST_ASSERT_TRUE(end != std::string::npos);
+  payload.insert(end, ",\"alerts\":[{\"sender_name\":\"NWS\",\"event\":"
+                      "\"Wind Advisory\",\"start\":1728838800,\"end\":"
+                      "1728882000,\"description\":\"Gusts up to 50 mph.\"},"
+                      "{\"event\":\"Flood Watch\",\"start\":1728838800,"
+                      "\"end\":1728900000}]");
+  return payload;
+}
+
+// The first alert comes with the full fetch, a current only fetch leaves the
+// alerts out and keeps the last one, even when the server sends them anyway
+void test_alerts_come_with_the_forecast() {
+  ReplayClient full(scenario("normal"), alertPayload());
+  TEST_ASSERT_TRUE(fetchOneCall(full));
+  TEST_ASSERT_NOT_NULL(strstr(full.request.c_str(), "exclude=minutely&"));
+  TEST_ASSERT_EQUAL_STRING("Wind Advisory", current.alert_event.c_str());
+  TEST_ASSERT_EQUAL_UINT32(1728838800, current.alert_start);
+  TEST_ASSERT_EQUAL_UINT32(1728882000, current.alert_end);
+
+  current.alert_event = "Heat Advisory";
+  ReplayClient currentOnly(scenario("normal"), alertPayload());
+  TEST_ASSERT_TRUE(fetchOneCall(currentOnly, false));
+  TEST_ASSERT_EQUAL_STRING("Heat Advisory", current.alert_event.c_str());
+  TEST_ASSERT_EQUAL_UINT32(1728882000, current.alert_end);
+
+  // A full fetch without the block clears the alert
+  ReplayClient ended(scenario("normal"), readPayload("onecall.json"));
+  TEST_ASSERT_TRUE(fetchOneCall(ended));
+  TEST_ASSERT_EQUAL_STRING("", current.alert_event.c_str());
+  TEST_ASSERT_EQUAL_UINT32(0, current.alert_end);
+}
+
+
+// main.cpp only counts fetches with a response as API calls
+void test_failed_connect_receives_nothing() {
+  // Without a client of its own the library connects with the WiFiClient
+  // stand-in, which never connects
+  TEST_ASSERT_FALSE(ow.getForecast(&current, nullptr, nullptr, "key",
+                                   "40.7128", "-74.0060", "imperial", "en",
+                                   false));
+  TEST_ASSERT_EQUAL_UINT8(OW_FAIL_CONNECT, ow.failStage);
+  TEST_ASSERT_EQUAL_UINT32(0, ow.bytesReceived);
+
+  ReplayClient client(scenario("stall"), readPayload("onecall.json"));
+  TEST_ASSERT_FALSE(fetchOneCall(client));
+  TEST_ASSERT_GREATER_THAN_UINT32(0, ow.bytesReceived);
+}
+
+void test_open_meteo_payload_fills_the_structures() {
+  ReplayClient client(scenario("normal"), readPayload("openmeteo.json"));
+  TEST_ASSERT_TRUE(fetchOpenMeteo(client));
+  TEST_ASSERT_NOT_NULL(strstr(client.request.c_str(), "forecast_hours=5"));
+  TEST_ASSERT_NOT_NULL(strstr(client.request.c_str(), "forecast_days=6"));
+  TEST_ASSERT_EQUAL_INT32(-14400, ow.timezoneOffset);
+
+  TEST_ASSERT_EQUAL_FLOAT(57.3f, current.temp);
+  TEST_ASSERT_EQUAL_UINT8(64, current.humidity);
+  TEST_ASSERT_EQUAL_UINT16(804, current.id);
+
+  const uint16_t hourlyId[] = {804, 801, 801, 500, 501};
+  for (uint8_t i = 0; i < MAX_HOURS; i++) {
+    TEST_ASSERT_EQUAL_UINT32(1728842400 + 3600 * i, hourly.dt[i]);
+    TEST_ASSERT_EQUAL_UINT16(hourlyId[i], hourly.id[i]);
+  }
+
+  const float dailyMax[] = {61.2f, 60.1f, 55.4f, 52.3f, 58.8f, 63.5f};
+  const uint16_t dailyId[] = {804, 501, 804, 800, 801, 300};
+  for (uint8_t i = 0; i < MAX_DAYS; i++) {
+    TEST_ASSERT_EQUAL_FLOAT(dailyMax[i], daily.temp_max[i]);
+    TEST_ASSERT_EQUAL_UINT16(dailyId[i], daily.id[i]);
+  }
+}
+
+// main.cpp picks the daily icons with isNight() of the daily dt
+void test_open_meteo_days_are_not_night() {
+  ReplayClient client(scenario("normal"), readPayload("openmeteo.json"));
+  TEST_ASSERT_TRUE(fetchOpenMeteo(client));
+  DayNightTable dayNight;
+  buildDayNightTable(dayNight, daily.sunrise, daily.sunset, MAX_DAYS,
+                     ow.timezoneOffset);
+  for (uint8_t i = 0; i < MAX_DAYS; i++) {
+    // Local noon of 13 October 2024 onwards
+    TEST_ASSERT_EQUAL_UINT32(1728835200 + 86400 * i, daily.dt[i]);
+    TEST_ASSERT_FALSE(isNight(dayNight, daily.dt[i] + ow.timezoneOffset));
+  }
+}
+
+// Host time the library takes to parse each payload, the share of the fetch
+// that does not depend on the network
+void test_parse_time_per_payload() {
+  const char* const names[] = {"onecall.json", "openmeteo.json"};
+  char line[64];
+  TEST_MESSAGE("payload          bytes  parse us");
+  for (const char* name : names) {
+    const std::string body = readPayload(name);
+    uint32_t elapsed = 0;
+    for (uint8_t run = 0; run < SCENARIO_RUNS; run++) {
+      ReplayClient client(scenario("normal"), body);
+      const uint32_t start = micros();
+      const bool ok = strcmp(name, "onecall.json") == 0
+                          ? fetchOneCall(client)
+                          : fetchOpenMeteo(client);
+      elapsed += micros() - start;
+      TEST_ASSERT_TRUE(ok);
+    }
+    snprintf(line, sizeof(line), "%-14s %7u %9u", name,
+             (unsigned)body.size(), (unsigned)(elapsed / SCENARIO_RUNS));
+    TEST_MESSAGE(line);
+  }
+}
+
+void test_cut_off_body_does_not_parse() {
+  ReplayClient client(scenario("truncate"), readPayload("onecall.json"));
+  TEST_ASSERT_FALSE(fetchOneCall(client));
+  TEST_ASSERT_EQUAL_UINT8(OW_FAIL_PARSE, ow.failStage);
+}
+
+// What the mock's "delivered" column cannot tell: how many responses the
+// firmware parsed under each scenario
+void test_success_rate_per_scenario() {
+  const std::string onecall = readPayload("onecall.json");
+  const std::string openMeteo = readPayload("openmeteo.json");
+  char line[96];
+  TEST_MESSAGE("scenario      onecall  open-meteo  ms/fetch");
+  for (const Scenario& scenario : scenarios) {
+    uint8_t parsed[2] = {0, 0};
+    uint32_t elapsed = 0;
+    for (uint8_t run = 0; run < SCENARIO_RUNS; run++) {
+      ReplayClient oneCallClient(scenario, onecall);
+      uint32_t start = millis();
+      parsed[0] += fetchOneCall(oneCallClient);
+      ReplayClient openMeteoClient(scenario, openMeteo);
+      parsed[1] += fetchOpenMeteo(openMeteoClient);
+      elapsed += millis() - start;
+    }
+    snprintf(line, sizeof(line), "%-12s %7d%% %10d%% %9u", scenario.name,
+             100 * parsed[0] / SCENARIO_RUNS, 100 * parsed[1] / SCENARIO_RUNS,
+             (unsigned)(elapsed / (2 * SCENARIO_RUNS)));
+    TEST_MESSAGE(line);
+
+    const std::string name = scenario.name;
+    if (name == "normal" || name == "latency") {
+      TEST_ASSERT_EQUAL_UINT8(SCENARIO_RUNS, parsed[0]);
+      TEST_ASSERT_EQUAL_UINT8(SCENARIO_RUNS, parsed[1]);
+    }
+    if (name == "stall" || name == "stall-reset" || name == "truncate" ||
+        name == "reset") {
+      TEST_ASSERT_EQUAL_UINT8(0, parsed[0]);
+      TEST_ASSERT_EQUAL_UINT8(0, parsed[1]);
+    }
+  }
+}
+
+// Fetches the onecall payload under the scenario, returns the ms it took
+static uint32_t fetchUnder(const char* name) {
+  ReplayClient client(scenario(name), readPayload("onecall.json"));
+  const uint32_t start = millis();
+  fetchOneCall(client);
+  return millis() - start;
+}
+
+// Each stage gives up on its own deadline, not on the next one or never
+void test_stalls_and_deadlines_abort_in_their_stage() {
+  uint32_t elapsed = fetchUnder("slow-headers");
+  TEST_ASSERT_EQUAL_UINT8(OW_FAIL_HEADER, ow.failStage);
+  TEST_ASSERT_UINT32_WITHIN(50, TIMEOUTS[1], elapsed);
+
+  // 2000 B/s gets the header through but not the 18 KB body
+  elapsed = fetchUnder("slow-link");
+  TEST_ASSERT_EQUAL_UINT8(OW_FAIL_BODY, ow.failStage);
+  TEST_ASSERT_UINT32_WITHIN(50, 200 + TIMEOUTS[2], elapsed);
+
+  elapsed = fetchUnder("stall");
+  TEST_ASSERT_EQUAL_UINT8(OW_FAIL_STALL, ow.failStage);
+  TEST_ASSERT_UINT32_WITHIN(50, TIMEOUTS[3], elapsed);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, ow.bytesReceived);
+
+  // The stall check fires before the reset of the silent server arrives
+  elapsed = fetchUnder("stall-reset");
+  TEST_ASSERT_EQUAL_UINT8(OW_FAIL_STALL, ow.failStage);
+  TEST_ASSERT_UINT32_WITHIN(50, TIMEOUTS[3], elapsed);
+
+  // A reset mid-body ends the fetch at once with what arrived unparsed
+  elapsed = fetchUnder("reset");
+  TEST_ASSERT_EQUAL_UINT8(OW_FAIL_PARSE, ow.failStage);
+  TEST_ASSERT_LESS_THAN_UINT32(50, elapsed);
+
+  elapsed = fetchUnder("latency");
+  TEST_ASSERT_EQUAL_UINT8(OW_FAIL_NONE, ow.failStage);
+}
+
+// The retry decisions setup() in main.cpp takes from each fetch result
+void test_failed_fetches_back_off_until_one_succeeds() {
+  // FAIL_RETRY_TIME and FAIL_RETRY_MAX_TIME of main.cpp in seconds
+  const RetryPolicy policy = {5 * 60, 60 * 60};
+  RetryState state;
+  const char* const failing[] = {"stall", "stall-reset", "slow-headers",
+                                 "reset"};
+  const uint8_t stages[] = {OW_FAIL_STALL, OW_FAIL_STALL, OW_FAIL_HEADER,
+                            OW_FAIL_PARSE};
+  uint32_t window = policy.baseDelay;
+  for (uint8_t i = 0; i < 4; i++) {
+    recordAttempt(state);
+    ReplayClient client(scenario(failing[i]), readPayload("onecall.json"));
+    TEST_ASSERT_FALSE(fetchOneCall(client));
+    const uint32_t backoff =
+        recordFailure(state, policy, ow.failStage, 0xFFFFFFFF);
+    TEST_ASSERT_EQUAL_UINT8(stages[i], state.lastFailStage);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(window, backoff);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(window / 2, backoff);
+    window = std::min(window * 2, policy.maxDelay);
+  }
+  TEST_ASSERT_EQUAL_UINT16(4, state.consecutiveFailures);
+
+  recordAttempt(state);
+  ReplayClient client(scenario("normal"), readPayload("onecall.json"));
+  TEST_ASSERT_TRUE(fetchOneCall(client));
+  recordSuccess(state);
+  TEST_ASSERT_EQUAL_UINT16(0, state.consecutiveFailures);
+  TEST_ASSERT_EQUAL_UINT32(0, state.lastBackoff);
+  TEST_ASSERT_EQUAL_UINT32(5, state.totalAttempts);
+  TEST_ASSERT_EQUAL_UINT32(4, state.totalFailures);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_payloads_are_committed);
+  RUN_TEST(test_onecall_payload_fills_the_structures);
+  RUN_TEST(test_current_only_fetch_excludes_the_forecast);
+  RUN_TEST(test_alerts_come_with_the_forecast);
+  RUN_TEST(test_failed_connect_receives_nothing);
+  RUN_TEST(test_open_meteo_payload_fills_the_structures);
+  RUN_TEST(test_open_meteo_days_are_not_night);
+  RUN_TEST(test_parse_time_per_payload);
+  RUN_TEST(test_cut_off_body_does_not_parse);
+  RUN_TEST(test_success_rate_per_scenario);
+  RUN_TEST(test_stalls_and_deadlines_abort_in_their_stage);
+  RUN_TEST(test_failed_fetches_back_off_until_one_succeeds);
+  return UNITY_END();
+}
@@ -0,0 +1,109 @@
+#include <RetryPolicy.h>
+#include <unity.h>
+
+// A one minute base window and FAIL_RETRY_MAX_TIME of main.cpp, in seconds
+const RetryPolicy policy = {60, 60 * 60};
+
+void setUp() {}
+void tearDown() {}
+
+void test_first_failure_sleeps_in_upper_half_of_base() {
+  RetryState state;
+  TEST_ASSERT_EQUAL_UINT32(30, recordFailure(state, policy, 1, 0));
+  state = RetryState();
+  TEST_ASSERT_EQUAL_UINT32(60, recordFailure(state, policy, 1, 30));
+  state = RetryState();
+  // Wraps around instead of leaving the window
+  TEST_ASSERT_EQUAL_UINT32(30, recordFailure(state, policy, 1, 31));
+}
+
+void test_window_doubles_per_consecutive_failure() {
+  RetryState state;
+  uint32_t window = policy.baseDelay;
+  for (int i = 0; i < 6; i++) {
+    const uint32_t low = recordFailure(state, policy, 2, 0);
+    TEST_ASSERT_EQUAL_UINT32(window / 2, low);
+    state.consecutiveFailures--;
+    const uint32_t high = recordFailure(state, policy, 2, 0xFFFFFFFF);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(window, high);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(window / 2, high);
+    window *= 2;
+  }
+  TEST_ASSERT_EQUAL_UINT32(12, state.totalFailures);
+  TEST_ASSERT_EQUAL_UINT16(6, state.consecutiveFailures);
+}
+
+void test_window_is_capped_at_max_delay() {
+  RetryState state;
+  state.consecutiveFailures = 1000;
+  TEST_ASSERT_EQUAL_UINT32(policy.maxDelay / 2,
+                           recordFailure(state, policy, 3, 0));
+  const uint32_t half = policy.maxDelay / 2;
+  TEST_ASSERT_EQUAL_UINT32(policy.maxDelay,
+                           recordFailure(state, policy, 3, half));
+  // A counter at its limit must not overflow the window either
+  state.consecutiveFailures = 0xFFFE;
+  TEST_ASSERT_EQUAL_UINT32(policy.maxDelay / 2,
+                           recordFailure(state, policy, 3, 0));
+}
+
+void test_cap_below_doubled_window() {
+  const RetryPolicy odd = {60, 100};
+  RetryState state;
+  state.consecutiveFailures = 1;
+  TEST_ASSERT_EQUAL_UINT32(50, recordFailure(state, odd, 4, 0));
+  TEST_ASSERT_EQUAL_UINT32(100, recordFailure(state, odd, 4, 50));
+}
+
+void test_backoff_spreads_over_the_window() {
+  RetryState state;
+  bool seen[121] = {};
+  for (uint32_t r = 0; r < 1000; r++) {
+    // Third failure in a row, a window of 240 s
+    state.consecutiveFailures = 2;
+    const uint32_t backoff = recordFailure(state, policy, 4, r * 2654435761u);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(120, backoff);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(240, backoff);
+    seen[backoff - 120] = true;
+  }
+  int distinct = 0;
+  for (bool s : seen) {
+    distinct += s;
+  }
+  TEST_ASSERT_GREATER_THAN(100, distinct);
+}
+
+void test_zero_base_delay_never_sleeps() {
+  const RetryPolicy none = {0, 0};
+  RetryState state;
+  TEST_ASSERT_EQUAL_UINT32(0, recordFailure(state, none, 1, 12345));
+}
+
+void test_success_resets_backoff_but_keeps_totals() {
+  RetryState state;
+  recordAttempt(state);
+  recordFailure(state, policy, 1, 7);
+  recordAttempt(state);
+  recordFailure(state, policy, 5, 7);
+  recordAttempt(state);
+  recordSuccess(state);
+  TEST_ASSERT_EQUAL_UINT16(0, state.consecutiveFailures);
+  TEST_ASSERT_EQUAL_UINT32(0, state.lastBackoff);
+  TEST_ASSERT_EQUAL_UINT32(2, state.totalFailures);
+  TEST_ASSERT_EQUAL_UINT32(3, state.totalAttempts);
+  TEST_ASSERT_EQUAL_UINT8(5, state.lastFailStage);
+  // The next failure starts from the base window again
+  TEST_ASSERT_EQUAL_UINT32(30, recordFailure(state, policy, 1, 0));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_failure_sleeps_in_upper_half_of_base);
+  RUN_TEST(test_window_doubles_per_consecutive_failure);
+  RUN_TEST(test_window_is_capped_at_max_delay);
+  RUN_TEST(test_cap_below_doubled_window);
+  RUN_TEST(test_backoff_spreads_over_the_window);
+  RUN_TEST(test_zero_base_delay_never_sleeps);
+  RUN_TEST(test_success_resets_backoff_but_keeps_totals);
+  return UNITY_END();
+}
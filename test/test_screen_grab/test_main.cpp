@@ -0,0 +1,191 @@
+#include <Fingerprint.h>
+#include <FrameCodec.h>
+#include <Screen.h>
+#include <ScreenGrab.h>
+#include <WeatherScreen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+#include "../weather_frames/WeatherFrames.h"
+
+// Grabs written the way sendScreenGrab() in main.cpp sends them, decoded by
+// tools/screen_grab.py --input into a PBM, where the black and the colored
+// pixels are both set
+const uint16_t WIDTH = 400;
+const uint16_t HEIGHT = 300;
+const uint32_t PLANE_SIZE = WIDTH / 8 * HEIGHT;
+
+static uint8_t black[PLANE_SIZE];
+static uint8_t color[PLANE_SIZE];
+static std::string directory;
+
+static void beginCanvas(bool threeColor, uint8_t rotation) {
+  canvas.begin(WIDTH, HEIGHT, HEIGHT, black, threeColor ? color : nullptr);
+  canvas.setRotation(rotation);
+  canvas.setFont(FONT_9PT);
+  canvas.setTextColor(GxEPD_BLACK);
+  canvas.fillScreen(GxEPD_WHITE);
+}
+
+// The header, then a ScreenGrabPlane and the coded bytes of each plane
+static std::vector<uint8_t> grab() {
+  const uint8_t* planes[] = {canvas.black, canvas.color};
+  ScreenGrabHeader header = {};
+  header.magic = SCREEN_GRAB_MAGIC;
+  header.version = SCREEN_GRAB_VERSION;
+  header.rotation = canvas.getRotation();
+  header.width = WIDTH;
+  header.height = HEIGHT;
+  header.planes = canvas.color != nullptr ? 2 : 1;
+  std::vector<uint8_t> out((const uint8_t*)&header,
+                           (const uint8_t*)&header + sizeof(header));
+  std::vector<uint8_t> encoded(maxEncodedFrameSize(PLANE_SIZE));
+  for (uint8_t i = 0; i < header.planes; i++) {
+    ScreenGrabPlane plane;
+    plane.size = encodeFrame(planes[i], PLANE_SIZE, WIDTH / 8, encoded.data(),
+                             encoded.size());
+    TEST_ASSERT_GREATER_THAN_UINT32(0, plane.size);
+    Fingerprint frame;
+    addBytes(frame, planes[i], PLANE_SIZE);
+    plane.hash = frame.hash;
+    out.insert(out.end(), (const uint8_t*)&plane,
+               (const uint8_t*)&plane + sizeof(plane));
+    out.insert(out.end(), encoded.begin(), encoded.begin() + plane.size);
+  }
+  return out;
+}
+
+// Runs the tool on the grab, returns its exit status and the PBM it wrote
+static int decode(const std::vector<uint8_t>& data, std::string& pbm) {
+  const std::string input = directory + "/grab.bin";
+  const std::string output = directory + "/grab.pbm";
+  FILE* file = fopen(input.c_str(), "wb");
+  TEST_ASSERT_NOT_NULL(file);
+  fwrite(data.data(), 1, data.size(), file);
+  fclose(file);
+  remove(output.c_str());
+  const std::string command = "python3 tools/screen_grab.py --input " + input +
+                              " --output " + output + " > /dev/null 2>&1";
+  const int status = system(command.c_str());
+  pbm.clear();
+  file = fopen(output.c_str(), "rb");
+  if (file != nullptr) {
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      pbm.append(buffer, read);
+    }
+    fclose(file);
+  }
+  return status;
+}
+
+// The pixels of a PBM the tool wrote at width x height
+static const uint8_t* pbmPixels(const std::string& pbm, uint16_t width,
+                                uint16_t height) {
+  char header[32];
+  snprintf(header, sizeof(header), "P4\n%u %u\n", width, height);
+  TEST_ASSERT_EQUAL_UINT32(strlen(header) + (width + 7) / 8 * height,
+                           pbm.size());
+  TEST_ASSERT_EQUAL_MEMORY(header, pbm.data(), strlen(header));
+  return (const uint8_t*)pbm.data() + strlen(header);
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+// Both panels: the PBM has a pixel set where either plane is cleared
+void test_grabs_decode_to_the_frame() {
+  for (bool threeColor : {false, true}) {
+    beginCanvas(threeColor, 0);
+    drawWeather(frames[2].view);
+    replayScreen();
+    std::string pbm;
+    TEST_ASSERT_EQUAL(0, decode(grab(), pbm));
+    const uint8_t* pixels = pbmPixels(pbm, WIDTH, HEIGHT);
+    uint32_t colored = 0;
+    for (uint32_t i = 0; i < PLANE_SIZE; i++) {
+      const uint8_t shown = threeColor ? black[i] & color[i] : black[i];
+      TEST_ASSERT_EQUAL_HEX8((uint8_t)~shown, pixels[i]);
+      colored += threeColor ? __builtin_popcount((uint8_t)~color[i]) : 0;
+    }
+    // The alert of the thunderstorm frame is in the accent color
+    TEST_ASSERT_EQUAL(threeColor, colored > 0);
+  }
+}
+
+// Pixels drawn at each rotation are where the tool shows them
+void test_rotation_matches_the_canvas() {
+  const int16_t points[][2] = {{0, 0}, {1, 2}, {37, 5}, {120, 250}};
+  for (uint8_t rotation = 0; rotation < 4; rotation++) {
+    beginCanvas(false, rotation);
+    for (const auto& point : points) {
+      canvas.drawPixel(point[0], point[1], GxEPD_BLACK);
+    }
+    const uint16_t width = canvas.width();
+    const uint16_t height = canvas.height();
+    std::string pbm;
+    TEST_ASSERT_EQUAL(0, decode(grab(), pbm));
+    const uint8_t* pixels = pbmPixels(pbm, width, height);
+    const uint32_t bytes = (width + 7) / 8 * height;
+    uint32_t set = 0;
+    for (uint32_t i = 0; i < bytes; i++) {
+      set += __builtin_popcount(pixels[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(sizeof(points) / sizeof(points[0]), set);
+    for (const auto& point : points) {
+      const uint32_t i = point[1] * ((width + 7) / 8) + point[0] / 8;
+      TEST_ASSERT_TRUE(pixels[i] & (0x80 >> (point[0] % 8)));
+    }
+  }
+}
+
+// Every plane is checked against its size and hash, and the version against
+// SCREEN_GRAB_VERSION
+void test_bad_grabs_are_rejected() {
+  beginCanvas(true, 0);
+  drawWeather(frames[2].view);
+  replayScreen();
+  const std::vector<uint8_t> good = grab();
+  const uint32_t colorPlane =
+      sizeof(ScreenGrabHeader) + sizeof(ScreenGrabPlane) +
+      ((const ScreenGrabPlane*)(good.data() + sizeof(ScreenGrabHeader)))->size;
+  std::string pbm;
+
+  std::vector<uint8_t> bad = good;
+  ((ScreenGrabPlane*)(bad.data() + colorPlane))->hash ^= 1;
+  TEST_ASSERT_NOT_EQUAL(0, decode(bad, pbm));
+  TEST_ASSERT_TRUE(pbm.empty());
+
+  bad = good;
+  ((ScreenGrabHeader*)bad.data())->version = 1;
+  TEST_ASSERT_NOT_EQUAL(0, decode(bad, pbm));
+
+  bad.assign(good.begin(), good.end() - 1);
+  TEST_ASSERT_NOT_EQUAL(0, decode(bad, pbm));
+
+  // A black plane size one byte short moves the color plane
+  bad = good;
+  ((ScreenGrabPlane*)(bad.data() + sizeof(ScreenGrabHeader)))->size--;
+  TEST_ASSERT_NOT_EQUAL(0, decode(bad, pbm));
+  TEST_ASSERT_TRUE(pbm.empty());
+}
+
+int main() {
+  char folder[] = "/tmp/screen_grab_XXXXXX";
+  if (mkdtemp(folder) == nullptr) {
+    return 1;
+  }
+  directory = folder;
+  UNITY_BEGIN();
+  RUN_TEST(test_grabs_decode_to_the_frame);
+  RUN_TEST(test_rotation_matches_the_canvas);
+  RUN_TEST(test_bad_grabs_are_rejected);
+  system(("rm -r " + directory).c_str());
+  return UNITY_END();
+}
@@ -0,0 +1,220 @@
+#include <IconPack.h>
+#include <Screen.h>
+#include <WeatherScreen.h>
+#include <chrono>
+#include <set>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include <vector>
+
+#include "../weather_frames/WeatherFrames.h"
+
+// Built with -D USE_SPIFFS_ICONS by pio test -e native_spiffs_icons, so the
+// icons come from data/ through the icon pack and the icon cache instead of
+// the flash atlas. tools/pack_icons.py writes data/icons.pack before the
+// build.
+#ifdef USE_ICON_ATLAS
+#error "test_spiffs_icons needs the SPIFFS icon build"
+#endif
+
+const uint16_t WIDTH = 400;
+const uint16_t HEIGHT = 300;
+const uint32_t PLANE_SIZE = WIDTH / 8 * HEIGHT;
+const uint8_t RENDER_RUNS = 20;
+const char* const PACK_FILE = "data/icons.pack";
+
+static uint8_t black[PLANE_SIZE];
+
+// The clouds frame: 11 icons, 7 of them different
+static const WeatherView& view = frames[0].view;
+const uint32_t VIEW_ICONS = 11;
+const uint32_t VIEW_DIFFERENT_ICONS = 7;
+
+// The icons drawWeather() draws for the view, the current one at full size
+static std::vector<IconAsset> viewIcons() {
+  std::vector<IconAsset> icons = {view.icon};
+  for (const WeatherHour& hour : view.hours) {
+    icons.push_back((IconAsset)(hour.icon + ICON_FOLDER_SIZE));
+  }
+  for (const WeatherDay& day : view.days) {
+    icons.push_back((IconAsset)(day.icon + ICON_FOLDER_SIZE));
+  }
+  return icons;
+}
+
+// Renders the view the way displayWeather() does and returns the
+// microseconds it took
+static double render() {
+  const auto start = std::chrono::steady_clock::now();
+  drawWeather(view);
+  replayScreen();
+  const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+// Starts a wake: the cache is empty, with the budget of main.cpp or none
+static void resetCache(uint32_t budget) {
+  clearIconCache(iconCache);
+  iconCache = IconCache();
+  iconCache.budget = budget;
+}
+
+void setUp() {
+  canvas.begin(WIDTH, HEIGHT, HEIGHT, black, nullptr);
+  canvas.setRotation(0);
+  canvas.setFont(FONT_9PT);
+  canvas.setTextColor(GxEPD_BLACK);
+  canvas.fillScreen(GxEPD_WHITE);
+  resetCache(ICON_CACHE_BUDGET);
+}
+
+void tearDown() { clearIconCache(iconCache); }
+
+void test_packed_icons_match_the_atlas() {
+  static uint8_t atlas[PLANE_SIZE];
+  for (uint8_t i = 0; i < ICON_ASSET_COUNT; i++) {
+    const IconBitmap& icon = ICON_ATLAS[i];
+    canvas.fillScreen(GxEPD_WHITE);
+    drawBits(3, 5, icon.bits, icon.width, icon.height);
+    memcpy(atlas, black, PLANE_SIZE);
+    canvas.fillScreen(GxEPD_WHITE);
+    TEST_ASSERT_EQUAL_UINT16(icon.height, drawIcon((IconAsset)i, 3, 5));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(atlas, black, PLANE_SIZE,
+                                          ICON_ASSET_PATHS[i]);
+  }
+}
+
+void test_pack_holds_the_icons_that_are_drawn() {
+  FILE* file = fopen(PACK_FILE, "rb");
+  TEST_ASSERT_NOT_NULL_MESSAGE(file, PACK_FILE);
+  std::vector<uint8_t> pack;
+  uint8_t buffer[4096];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    pack.insert(pack.end(), buffer, buffer + read);
+  }
+  fclose(file);
+  IconPackHeader header;
+  TEST_ASSERT_GREATER_OR_EQUAL(sizeof(header), pack.size());
+  memcpy(&header, pack.data(), sizeof(header));
+  const IconPackEntry* index =
+      reinterpret_cast<const IconPackEntry*>(pack.data() + sizeof(header));
+  // Every condition code by day and night, at both sizes
+  std::set<uint8_t> drawn;
+  for (uint16_t id = 0; id < 1000; id++) {
+    for (bool night : {false, true}) {
+      const IconAsset icon = getMeteoconIcon(id, night);
+      drawn.insert(icon);
+      drawn.insert(icon + ICON_FOLDER_SIZE);
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT16(drawn.size(), header.count);
+  for (uint8_t i = 0; i < ICON_ASSET_COUNT; i++) {
+    const IconPackEntry* entry = findPackEntry(
+        index, header.count, iconPackHash(ICON_ASSET_PATHS[i]));
+    if (drawn.count(i)) {
+      TEST_ASSERT_NOT_NULL_MESSAGE(entry, ICON_ASSET_PATHS[i]);
+    } else {
+      TEST_ASSERT_NULL_MESSAGE(entry, ICON_ASSET_PATHS[i]);
+    }
+  }
+}
+
+void test_repeated_icons_are_decoded_once() {
+  render();
+  TEST_ASSERT_EQUAL_UINT32(VIEW_DIFFERENT_ICONS, iconCache.misses);
+  TEST_ASSERT_EQUAL_UINT32(VIEW_ICONS - VIEW_DIFFERENT_ICONS, iconCache.hits);
+  TEST_ASSERT_EQUAL_UINT32(0, iconCache.evictions);
+  TEST_ASSERT_TRUE(iconCache.used <= ICON_CACHE_BUDGET);
+  // A second render in the same wake decodes nothing
+  render();
+  TEST_ASSERT_EQUAL_UINT32(VIEW_DIFFERENT_ICONS, iconCache.misses);
+  TEST_ASSERT_EQUAL_UINT32(2 * VIEW_ICONS - VIEW_DIFFERENT_ICONS,
+                           iconCache.hits);
+}
+
+void test_cached_frame_matches_the_uncached_one() {
+  static uint8_t uncached[PLANE_SIZE];
+  resetCache(0);
+  render();
+  TEST_ASSERT_EQUAL_UINT32(0, iconCache.used);
+  memcpy(uncached, black, PLANE_SIZE);
+  resetCache(ICON_CACHE_BUDGET);
+  render();
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(uncached, black, PLANE_SIZE);
+}
+
+// One wake renders the frame once with an empty cache, so the first render is
+// timed on its own. Without the cache every icon is read from its BMP.
+void test_benchmark_with_and_without_the_cache() {
+  double first[2] = {0, 0};
+  double total[2] = {0, 0};
+  for (uint8_t run = 0; run < RENDER_RUNS; run++) {
+    for (uint8_t cached = 0; cached < 2; cached++) {
+      resetCache(cached ? ICON_CACHE_BUDGET : 0);
+      first[cached] += render();
+      total[cached] += render();
+    }
+  }
+  char message[128];
+  snprintf(message, sizeof(message),
+           "first render %.1f us cached, %.1f us uncached; repeated %.1f us "
+           "cached, %.1f us uncached; %u bytes cached",
+           first[1] / RENDER_RUNS, first[0] / RENDER_RUNS,
+           total[1] / RENDER_RUNS, total[0] / RENDER_RUNS,
+           (unsigned)iconCache.used);
+  TEST_MESSAGE(message);
+}
+
+// The icons of the view alone: blitted from the atlas like the default build,
+// decoded from the pack into an empty cache, drawn from the cache and read
+// from their BMPs without a cache
+void test_benchmark_icons_against_the_atlas() {
+  const std::vector<IconAsset> icons = viewIcons();
+  double atlas = 0;
+  double packed = 0;
+  double cached = 0;
+  double bitmaps = 0;
+  for (uint8_t run = 0; run < RENDER_RUNS; run++) {
+    auto start = std::chrono::steady_clock::now();
+    for (IconAsset icon : icons) {
+      const IconBitmap& bitmap = ICON_ATLAS[icon];
+      drawBits(3, 5, bitmap.bits, bitmap.width, bitmap.height);
+    }
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    atlas += elapsed.count();
+    for (uint32_t budget : {ICON_CACHE_BUDGET, (uint32_t)0}) {
+      resetCache(budget);
+      for (uint8_t pass = 0; pass < (budget ? 2 : 1); pass++) {
+        start = std::chrono::steady_clock::now();
+        for (IconAsset icon : icons) {
+          drawIcon(icon, 3, 5);
+        }
+        elapsed = std::chrono::steady_clock::now() - start;
+        (budget == 0 ? bitmaps : pass == 0 ? packed : cached) +=
+            elapsed.count();
+      }
+    }
+  }
+  char message[160];
+  snprintf(message, sizeof(message),
+           "%u icons: atlas %.1f us, pack %.1f us, cached %.1f us, bitmaps "
+           "%.1f us",
+           (unsigned)icons.size(), atlas / RENDER_RUNS, packed / RENDER_RUNS,
+           cached / RENDER_RUNS, bitmaps / RENDER_RUNS);
+  TEST_MESSAGE(message);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_packed_icons_match_the_atlas);
+  RUN_TEST(test_pack_holds_the_icons_that_are_drawn);
+  RUN_TEST(test_repeated_icons_are_decoded_once);
+  RUN_TEST(test_cached_frame_matches_the_uncached_one);
+  RUN_TEST(test_benchmark_with_and_without_the_cache);
+  RUN_TEST(test_benchmark_icons_against_the_atlas);
+  return UNITY_END();
+}
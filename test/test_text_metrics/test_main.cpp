@@ -0,0 +1,111 @@
+#include <FontMetrics.h>
+#include <Screen.h>
+#include <string.h>
+#include <unity.h>
+
+const uint16_t WIDTH = 400;
+const uint16_t HEIGHT = 300;
+
+static uint8_t black[WIDTH / 8 * HEIGHT];
+
+struct Measured {
+  const GFXfont* const* font;
+  const FontMetrics* metrics;
+  const char* text;
+};
+
+// What drawWeather() measures or prints, in each font it uses
+static const Measured measured[] = {
+    {&FONT_24PT, &FreeMono24pt7bMetrics, "Clouds"},
+    {&FONT_24PT, &FreeMono24pt7bMetrics, "Snow"},
+    {&FONT_18PT, &FreeMono18pt7bMetrics, "Thunderstorm"},
+    {&FONT_18PT, &FreeMono18pt7bMetrics, " ("},
+    {&FONT_18PT, &FreeMono18pt7bMetrics, "-"},
+    {&FONT_18PT, &FreeMono18pt7bMetrics, ")"},
+    {&FONT_18PT, &FreeMono18pt7bMetrics, "57"},
+    {&FONT_18PT, &FreeMono18pt7bMetrics, "-4"},
+    {&FONT_18PT, &FreeMono18pt7bMetrics, "100"},
+    {&FONT_12PT, &FreeMono12pt7bMetrics, "#"},
+    {&FONT_12PT, &FreeMono12pt7bMetrics, "Humidity: 100% "},
+    {&FONT_12PT, &FreeMono12pt7bMetrics, "Charging"},
+    {&FONT_12PT, &FreeMono12pt7bMetrics, "Battery low"},
+    {&FONT_12PT, &FreeMono12pt7bMetrics, "Severe Thunderstorm Warning"},
+    {&FONT_12PT, &FreeMono12pt7bMetrics, " Sun  "},
+    {&FONT_12PT, &FreeMono12pt7bMetrics, "14:00"},
+    {&FONT_12PT, &FreeMono12pt7bMetrics, "-10"},
+    {&FONT_12PT, &FreeMono12pt7bMetrics, "Wed"},
+    {&FONT_9PT, &FreeMono9pt7bMetrics, "Severe Thunderstorm Warning"},
+    {&FONT_9PT, &FreeMono9pt7bMetrics, "Severe Thunderstorm"},
+    {&FONT_9PT, &FreeMono9pt7bMetrics, "oF"},
+    {&FONT_9PT, &FreeMono9pt7bMetrics, "57"},
+    {&FONT_9PT, &FreeMono9pt7bMetrics, "New York, New York, US"},
+};
+
+static void bounds(const char* text, uint16_t& w, uint16_t& h) {
+  int16_t x, y;
+  canvas.getTextBounds(text, 0, 0, &x, &y, &w, &h);
+}
+
+void setUp() {
+  canvas.begin(WIDTH, HEIGHT, HEIGHT, black, nullptr);
+  canvas.setRotation(0);
+  canvas.setTextSize(1);
+  canvas.setTextWrap(true);
+  setFont(FONT_9PT);
+}
+
+void tearDown() {}
+
+void test_metrics_match_get_text_bounds() {
+  for (const Measured& m : measured) {
+    setFont(*m.font);
+    uint16_t w, h;
+    bounds(m.text, w, h);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(w, textWidth(*m.metrics, m.text),
+                                     m.text);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(h, textHeight(*m.metrics, m.text),
+                                     m.text);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(w, getWidthOfText(m.text), m.text);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(h, getHeightOfText(m.text), m.text);
+  }
+}
+
+// Multi-line text isn't covered by the metrics and goes through the
+// getTextBounds() cache. Both pairs have the same FNV-1a hash.
+void test_cache_tells_colliding_text_apart() {
+  const char* const pairs[][2] = {{"costarring\n", "liquid\n"},
+                                  {"declinate\nx", "macallums\nx"}};
+  setFont(FONT_12PT);
+  for (const auto& pair : pairs) {
+    for (uint8_t run = 0; run < 2; run++) {
+      for (const char* text : pair) {
+        uint16_t w, h;
+        bounds(text, w, h);
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(w, getWidthOfText(text), text);
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(h, getHeightOfText(text), text);
+      }
+    }
+  }
+}
+
+void test_long_text_is_measured_every_time() {
+  const char* const texts[] = {
+      "A multi-line text that is too long to be cached\nA",
+      "A multi-line text that is too long to be cached\nABCDEF"};
+  setFont(FONT_9PT);
+  for (uint8_t run = 0; run < 2; run++) {
+    for (const char* text : texts) {
+      uint16_t w, h;
+      bounds(text, w, h);
+      TEST_ASSERT_EQUAL_UINT16_MESSAGE(w, getWidthOfText(text), text);
+    }
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_metrics_match_get_text_bounds);
+  RUN_TEST(test_cache_tells_colliding_text_apart);
+  RUN_TEST(test_long_text_is_measured_every_time);
+  return UNITY_END();
+}
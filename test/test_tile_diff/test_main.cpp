@@ -0,0 +1,181 @@
+#include <TileDiff.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+// 6 x 6 tiles, the last column 8 pixels wide and the last row 10 high
+const uint16_t WIDTH = 208;
+const uint16_t HEIGHT = 160;
+const uint16_t BYTES = WIDTH / 8 * HEIGHT;
+
+static uint8_t frame[BYTES];
+static TileState state;
+static TileRect rects[MAX_REFRESH_RECTS];
+
+static void setPixel(int16_t x, int16_t y) {
+  frame[y * (WIDTH / 8) + x / 8] ^= 0x80 >> (x % 8);
+}
+
+static bool covered(int16_t x, int16_t y, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++) {
+    if (x >= rects[i].x && x < rects[i].x + rects[i].w && y >= rects[i].y &&
+        y < rects[i].y + rects[i].h) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Pixels covered by the rectangles, counted one by one
+static uint32_t coveredPixels(uint8_t count) {
+  uint32_t pixels = 0;
+  for (int16_t y = 0; y < HEIGHT; y++) {
+    for (int16_t x = 0; x < WIDTH; x++) {
+      pixels += covered(x, y, count);
+    }
+  }
+  return pixels;
+}
+
+static uint8_t diff(uint32_t& area) {
+  return diffTiles(state, frame, WIDTH, HEIGHT, rects, area);
+}
+
+void setUp() {
+  state = TileState();
+  memset(frame, 0xFF, BYTES);
+  uint32_t area;
+  diff(area);
+}
+
+void tearDown() {}
+
+void test_first_frame_is_the_whole_panel() {
+  state = TileState();
+  uint32_t area;
+  const uint8_t count = diff(area);
+  TEST_ASSERT_TRUE(state.valid);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT8(MAX_REFRESH_RECTS, count);
+  TEST_ASSERT_EQUAL_UINT32((uint32_t)WIDTH * HEIGHT, area);
+  TEST_ASSERT_EQUAL_UINT32(area, coveredPixels(count));
+}
+
+void test_unchanged_frame_has_no_rects() {
+  uint32_t area = 1;
+  TEST_ASSERT_EQUAL_UINT8(0, diff(area));
+  TEST_ASSERT_EQUAL_UINT32(0, area);
+}
+
+void test_changed_pixel_gives_its_tile() {
+  setPixel(205, 155);
+  uint32_t area;
+  TEST_ASSERT_EQUAL_UINT8(1, diff(area));
+  // The clipped corner tile
+  TEST_ASSERT_EQUAL_INT16(200, rects[0].x);
+  TEST_ASSERT_EQUAL_INT16(150, rects[0].y);
+  TEST_ASSERT_EQUAL_INT16(8, rects[0].w);
+  TEST_ASSERT_EQUAL_INT16(10, rects[0].h);
+  TEST_ASSERT_EQUAL_UINT32(80, area);
+}
+
+void test_tiles_in_a_column_grow_into_one_rect() {
+  setPixel(45, 5);
+  setPixel(45, 35);
+  setPixel(165, 35);
+  setPixel(45, 65);
+  uint32_t area;
+  TEST_ASSERT_EQUAL_UINT8(2, diff(area));
+  TEST_ASSERT_EQUAL_INT16(40, rects[0].x);
+  TEST_ASSERT_EQUAL_INT16(0, rects[0].y);
+  TEST_ASSERT_EQUAL_INT16(40, rects[0].w);
+  TEST_ASSERT_EQUAL_INT16(90, rects[0].h);
+  TEST_ASSERT_EQUAL_UINT32(4 * TILE_WIDTH * TILE_HEIGHT, area);
+}
+
+// Eleven scattered tiles merged down to MAX_REFRESH_RECTS give bounding rects
+// that overlap by 2400 pixels
+void test_merged_rects_count_overlaps_once() {
+  const uint8_t tiles[][2] = {{0, 0}, {0, 3}, {1, 3}, {3, 5}, {5, 2}, {0, 4},
+                              {0, 2}, {3, 3}, {2, 1}, {3, 4}, {2, 4}};
+  for (const auto& tile : tiles) {
+    setPixel(tile[0] * TILE_WIDTH, tile[1] * TILE_HEIGHT);
+  }
+  uint32_t area;
+  const uint8_t count = diff(area);
+  TEST_ASSERT_EQUAL_UINT8(MAX_REFRESH_RECTS, count);
+  uint32_t sum = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    sum += (uint32_t)rects[i].w * rects[i].h;
+  }
+  TEST_ASSERT_EQUAL_UINT32(coveredPixels(count), area);
+  TEST_ASSERT_EQUAL_UINT32(16240, area);
+  TEST_ASSERT_EQUAL_UINT32(area + 2400, sum);
+  for (const auto& tile : tiles) {
+    TEST_ASSERT_TRUE(
+        covered(tile[0] * TILE_WIDTH, tile[1] * TILE_HEIGHT, count));
+  }
+}
+
+void test_random_changes_are_covered() {
+  srand(3);
+  for (uint16_t run = 0; run < 200; run++) {
+    const uint8_t changes = 1 + rand() % 12;
+    int16_t xs[12];
+    int16_t ys[12];
+    for (uint8_t i = 0; i < changes; i++) {
+      xs[i] = rand() % WIDTH;
+      ys[i] = rand() % HEIGHT;
+      setPixel(xs[i], ys[i]);
+    }
+    uint32_t area;
+    const uint8_t count = diff(area);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT8(MAX_REFRESH_RECTS, count);
+    for (uint8_t i = 0; i < changes; i++) {
+      TEST_ASSERT_TRUE(covered(xs[i], ys[i], count));
+    }
+    TEST_ASSERT_EQUAL_UINT32(coveredPixels(count), area);
+  }
+}
+
+void test_other_panel_size_is_the_whole_panel() {
+  uint32_t area;
+  const uint8_t count =
+      diffTiles(state, frame, WIDTH - 40, HEIGHT, rects, area);
+  TEST_ASSERT_EQUAL_UINT32((uint32_t)(WIDTH - 40) * HEIGHT, area);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT8(MAX_REFRESH_RECTS, count);
+}
+
+// 800 x 480 has 320 tiles, more than there are hashes for
+void test_panel_over_max_tiles_is_never_compared() {
+  struct {
+    TileState state;
+    uint32_t guard[256];
+  } guarded;
+  memset(guarded.guard, 0xA5, sizeof(guarded.guard));
+  static uint8_t large[800 / 8 * 480];
+  TEST_ASSERT_GREATER_THAN_UINT16(MAX_TILES, tileCount(800, 480));
+  for (uint8_t run = 0; run < 2; run++) {
+    uint32_t area;
+    TEST_ASSERT_EQUAL_UINT8(
+        1, diffTiles(guarded.state, large, 800, 480, rects, area));
+    TEST_ASSERT_FALSE(guarded.state.valid);
+    TEST_ASSERT_EQUAL_INT16(800, rects[0].w);
+    TEST_ASSERT_EQUAL_INT16(480, rects[0].h);
+    TEST_ASSERT_EQUAL_UINT32(800 * 480, area);
+  }
+  TEST_ASSERT_EACH_EQUAL_UINT32(0xA5A5A5A5, guarded.guard, 256);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_frame_is_the_whole_panel);
+  RUN_TEST(test_unchanged_frame_has_no_rects);
+  RUN_TEST(test_changed_pixel_gives_its_tile);
+  RUN_TEST(test_tiles_in_a_column_grow_into_one_rect);
+  RUN_TEST(test_merged_rects_count_overlaps_once);
+  RUN_TEST(test_random_changes_are_covered);
+  RUN_TEST(test_other_panel_size_is_the_whole_panel);
+  RUN_TEST(test_panel_over_max_tiles_is_never_compared);
+  return UNITY_END();
+}
@@ -0,0 +1,134 @@
+#include <WakeScheduler.h>
+#include <unity.h>
+
+const uint32_t NOW = 1792318456;   // 2026-10-18 10:14:16 UTC
+const int32_t TZ = -4 * 3600;      // local time is UTC-4
+const uint32_t INTERVAL = 15 * 60; // UPDATE_TIME of main.cpp
+const uint32_t MIN_SLEEP = 60;
+
+static uint32_t sleepSeconds(uint64_t sleep) {
+  return (uint32_t)((sleep + 500000) / 1000000);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_sleep_lands_on_local_boundary() {
+  WakeState state;
+  for (uint32_t now = NOW; now < NOW + 2 * INTERVAL; now += 37) {
+    const uint32_t sleep =
+        sleepSeconds(nextSleep(state, now, TZ, INTERVAL, MIN_SLEEP));
+    TEST_ASSERT_EQUAL_UINT32(0, (now + TZ + sleep) % INTERVAL);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(MIN_SLEEP, sleep);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(INTERVAL + MIN_SLEEP, sleep);
+    TEST_ASSERT_EQUAL_UINT32(now, state.sleepStart);
+    TEST_ASSERT_EQUAL_UINT32(now + sleep, state.expectedWake);
+  }
+}
+
+void test_half_hour_time_zone_boundary() {
+  WakeState state;
+  const int32_t tz = 5 * 3600 + 30 * 60;
+  const uint32_t sleep =
+      sleepSeconds(nextSleep(state, NOW, tz, INTERVAL, MIN_SLEEP));
+  TEST_ASSERT_EQUAL_UINT32(0, (NOW + tz + sleep) % INTERVAL);
+}
+
+void test_min_sleep_skips_to_next_boundary() {
+  WakeState state;
+  // 30 s before a boundary is too close, the one after it is taken
+  const uint32_t now = (NOW + TZ) / INTERVAL * INTERVAL + INTERVAL - 30 - TZ;
+  const uint32_t sleep =
+      sleepSeconds(nextSleep(state, now, TZ, INTERVAL, MIN_SLEEP));
+  TEST_ASSERT_EQUAL_UINT32(INTERVAL + 30, sleep);
+  // Exactly MIN_SLEEP before a boundary still lands on it
+  const uint32_t exact = sleepSeconds(
+      nextSleep(state, now - MIN_SLEEP + 30, TZ, INTERVAL, MIN_SLEEP));
+  TEST_ASSERT_EQUAL_UINT32(MIN_SLEEP, exact);
+}
+
+void test_boot_latency_wakes_early() {
+  WakeState state;
+  recordBootLatency(state, 2500);
+  const uint32_t sleep =
+      sleepSeconds(nextSleep(state, NOW, TZ, INTERVAL, MIN_SLEEP));
+  // Rounded up to whole seconds, so the display is refreshed on the boundary
+  TEST_ASSERT_EQUAL_UINT32(0, (NOW + TZ + sleep + 3) % INTERVAL);
+}
+
+void test_boot_latency_is_smoothed() {
+  WakeState state;
+  recordBootLatency(state, 8000);
+  TEST_ASSERT_EQUAL_UINT32(8000, state.bootLatency);
+  recordBootLatency(state, 4000);
+  TEST_ASSERT_EQUAL_UINT32(7000, state.bootLatency);
+}
+
+void test_drift_is_fitted_from_late_wakes() {
+  // An RTC running 3 % slow wakes 3 % late, every wake the sleep is scaled
+  // by the estimate so far and the residual error is folded in
+  const double trueDriftPpm = 30000;
+  WakeState state;
+  uint32_t now = NOW;
+  for (int wake = 0; wake < 12; wake++) {
+    const uint64_t sleep = nextSleep(state, now, TZ, INTERVAL, MIN_SLEEP);
+    const double slept = sleep / 1e6 * (1 + trueDriftPpm / 1e6);
+    const uint32_t actualWake = now + (uint32_t)slept;
+    recordWake(state, actualWake);
+    TEST_ASSERT_EQUAL_UINT32(0, state.expectedWake);
+    now = actualWake + 20;
+  }
+  // One second in a 15 minute sleep is 1111 ppm
+  TEST_ASSERT_INT32_WITHIN(1500, 30000, state.driftPpm);
+}
+
+void test_fast_clock_gives_negative_drift() {
+  WakeState state;
+  state.sleepStart = NOW;
+  state.expectedWake = NOW + 1000;
+  recordWake(state, NOW + 980);
+  // Half of the -20000 ppm measured, rounded towards zero
+  TEST_ASSERT_INT32_WITHIN(1, -10000, state.driftPpm);
+}
+
+void test_outlier_wake_is_ignored() {
+  WakeState state;
+  state.driftPpm = 1234;
+  state.sleepStart = NOW;
+  state.expectedWake = NOW + 900;
+  // Far off the expected wake, e.g. a clock jump, is no drift
+  recordWake(state, NOW + 100);
+  TEST_ASSERT_EQUAL_INT32(1234, state.driftPpm);
+  TEST_ASSERT_EQUAL_UINT32(0, state.expectedWake);
+}
+
+void test_skip_alignment_ignores_next_wake() {
+  WakeState state;
+  nextSleep(state, NOW, TZ, INTERVAL, MIN_SLEEP);
+  skipAlignment(state);
+  recordWake(state, state.sleepStart + 2 * INTERVAL);
+  TEST_ASSERT_EQUAL_INT32(0, state.driftPpm);
+}
+
+void test_unset_clock_sleeps_one_interval() {
+  WakeState state;
+  state.expectedWake = NOW;
+  TEST_ASSERT_EQUAL_UINT64((uint64_t)INTERVAL * 1000000,
+                           nextSleep(state, 1000, TZ, INTERVAL, MIN_SLEEP));
+  TEST_ASSERT_EQUAL_UINT32(0, state.expectedWake);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_sleep_lands_on_local_boundary);
+  RUN_TEST(test_half_hour_time_zone_boundary);
+  RUN_TEST(test_min_sleep_skips_to_next_boundary);
+  RUN_TEST(test_boot_latency_wakes_early);
+  RUN_TEST(test_boot_latency_is_smoothed);
+  RUN_TEST(test_drift_is_fitted_from_late_wakes);
+  RUN_TEST(test_fast_clock_gives_negative_drift);
+  RUN_TEST(test_outlier_wake_is_ignored);
+  RUN_TEST(test_skip_alignment_ignores_next_wake);
+  RUN_TEST(test_unset_clock_sleeps_one_interval);
+  return UNITY_END();
+}
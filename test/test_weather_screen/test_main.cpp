@@ -0,0 +1,350 @@
+#include <Screen.h>
+#include <WeatherScreen.h>
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <unity.h>
+#include <vector>
+
+#include "../weather_frames/WeatherFrames.h"
+
+// GxEPD2_420 of include/GxEPD2_display_selection_new_style.h, drawn into a
+// full frame like the firmware does
+const uint16_t WIDTH = 400;
+const uint16_t HEIGHT = 300;
+const uint32_t PLANE_SIZE = WIDTH / 8 * HEIGHT;
+const uint8_t RENDER_RUNS = 20;
+
+// Frames that differ from their golden one are written to OUTPUT_DIR to look
+// at. Goldens are recorded with: UPDATE_GOLDEN=1 pio test -e native -f
+// test_weather_screen
+const char* const GOLDEN_DIR = "test/test_weather_screen/golden/";
+const char* const OUTPUT_DIR = ".pio/screens/";
+
+static uint8_t black[PLANE_SIZE];
+static uint8_t color[PLANE_SIZE];
+
+// Rows of a page with PAGED_DISPLAY, see GxEPD2_display_selection_new_style.h
+const uint16_t PAGE_HEIGHT = 60;
+
+// Heap in use and its peak, counted through operator new, which the String
+// and std containers of a render allocate with
+static size_t heapUsed = 0;
+static size_t heapPeak = 0;
+
+void* operator new(size_t size) {
+  size_t* block = (size_t*)malloc(sizeof(size_t) + size);
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  *block = size;
+  heapUsed += size;
+  heapPeak = heapUsed > heapPeak ? heapUsed : heapPeak;
+  return block + 1;
+}
+
+void operator delete(void* pointer) noexcept {
+  if (pointer != nullptr) {
+    size_t* block = (size_t*)pointer - 1;
+    heapUsed -= *block;
+    free(block);
+  }
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  operator delete(pointer);
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& data) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  uint8_t buffer[4096];
+  size_t n;
+  data.clear();
+  while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.insert(data.end(), buffer, buffer + n);
+  }
+  fclose(file);
+  return true;
+}
+
+static void writeFile(const std::string& path,
+                      const std::vector<uint8_t>& data) {
+  FILE* file = fopen(path.c_str(), "wb");
+  TEST_ASSERT_NOT_NULL_MESSAGE(file, path.c_str());
+  fwrite(data.data(), 1, data.size(), file);
+  fclose(file);
+}
+
+// A binary PBM of a plane, where a set bit is black. GxEPD2 planes have the
+// bits of white (or uncolored) pixels set.
+static std::vector<uint8_t> toPbm(const uint8_t* plane) {
+  char header[32];
+  const int length = snprintf(header, sizeof(header), "P4\n%u %u\n", WIDTH,
+                              HEIGHT);
+  std::vector<uint8_t> pbm(header, header + length);
+  for (uint32_t i = 0; i < PLANE_SIZE; i++) {
+    pbm.push_back(~plane[i]);
+  }
+  return pbm;
+}
+
+// Renders the view the way displayWeather() does and returns the
+// microseconds it took
+static double render(const WeatherView& view) {
+  const auto start = std::chrono::steady_clock::now();
+  drawWeather(view);
+  replayScreen();
+  const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+// Compares the plane with the golden PBM of name, or records it with
+// UPDATE_GOLDEN set. A missing golden PBM fails like a different one, the
+// frame is written to OUTPUT_DIR either way.
+static void checkGolden(const std::string& name, const uint8_t* plane) {
+  const std::vector<uint8_t> pbm = toPbm(plane);
+  const std::string golden = GOLDEN_DIR + name + ".pbm";
+  const std::string output = OUTPUT_DIR + name + ".pbm";
+  if (getenv("UPDATE_GOLDEN") != nullptr) {
+    mkdir(GOLDEN_DIR, 0755);
+    writeFile(golden, pbm);
+    return;
+  }
+  char message[256];
+  std::vector<uint8_t> expected;
+  if (!readFile(golden, expected)) {
+    writeFile(output, pbm);
+    snprintf(message, sizeof(message),
+             "No golden %s, see %s. Record it with UPDATE_GOLDEN=1 pio test "
+             "-e native -f test_weather_screen",
+             golden.c_str(), output.c_str());
+    TEST_FAIL_MESSAGE(message);
+  }
+  if (expected == pbm) {
+    return;
+  }
+  writeFile(output, pbm);
+  uint32_t pixels = 0;
+  for (size_t i = 0; i < pbm.size() && i < expected.size(); i++) {
+    pixels += __builtin_popcount((uint8_t)(pbm[i] ^ expected[i]));
+  }
+  snprintf(message, sizeof(message), "%u pixels differ from %s, see %s",
+           (unsigned)pixels, golden.c_str(), output.c_str());
+  TEST_FAIL_MESSAGE(message);
+}
+
+// A black and white panel, or a three color one with its color plane
+static void beginCanvas(bool threeColor) {
+  canvas.begin(WIDTH, HEIGHT, HEIGHT, black, threeColor ? color : nullptr);
+  canvas.setRotation(0);
+  canvas.setFont(FONT_9PT);
+  canvas.setTextColor(GxEPD_BLACK);
+  canvas.fillScreen(GxEPD_WHITE);
+}
+
+void setUp() {
+  mkdir(".pio", 0755);
+  mkdir(OUTPUT_DIR, 0755);
+  beginCanvas(false);
+}
+
+void tearDown() {}
+
+// Checks the frame on a black and white panel against <name>.pbm and on a
+// three color panel against <name>_3c_black.pbm and <name>_3c_color.pbm
+static void checkFrame(const Frame& frame) {
+  const std::string name = frame.name;
+  for (bool threeColor : {false, true}) {
+    beginCanvas(threeColor);
+    double total = 0;
+    for (uint8_t run = 0; run < RENDER_RUNS; run++) {
+      total += render(frame.view);
+    }
+    TEST_ASSERT_FALSE(screen.overflow);
+    char message[96];
+    snprintf(message, sizeof(message), "%s%s: %.1f us per frame, %u draw ops",
+             frame.name, threeColor ? " (3C)" : "", total / RENDER_RUNS,
+             screen.count);
+    TEST_MESSAGE(message);
+    if (threeColor) {
+      checkGolden(name + "_3c_black", black);
+      checkGolden(name + "_3c_color", color);
+    } else {
+      checkGolden(name, black);
+    }
+  }
+}
+
+void test_clouds() { checkFrame(frames[0]); }
+void test_snow_night() { checkFrame(frames[1]); }
+void test_thunderstorm() { checkFrame(frames[2]); }
+
+void test_icons_from_spiffs_match_the_atlas() {
+  static uint8_t atlas[PLANE_SIZE];
+  for (uint8_t i = 0; i < ICON_ASSET_COUNT; i++) {
+    const IconBitmap& icon = ICON_ATLAS[i];
+    canvas.fillScreen(GxEPD_WHITE);
+    drawBits(3, 5, icon.bits, icon.width, icon.height);
+    memcpy(atlas, black, PLANE_SIZE);
+    canvas.fillScreen(GxEPD_WHITE);
+    drawBitmapFromSpiffs(ICON_ASSET_PATHS[i], 3, 5);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(atlas, black, PLANE_SIZE,
+                                          ICON_ASSET_PATHS[i]);
+  }
+}
+
+void test_unchanged_fingerprint_gives_the_same_frame() {
+  static uint8_t before[PLANE_SIZE];
+  WeatherView view = frames[0].view;
+  render(view);
+  memcpy(before, black, PLANE_SIZE);
+  const uint32_t fingerprint = weatherFingerprint(view);
+  // Rounds to the same printed temperatures
+  view.temp += 0.1;
+  view.hours[0].temp += 0.05;
+  view.days[0].tempMax -= 0.05;
+  TEST_ASSERT_EQUAL_HEX32(fingerprint, weatherFingerprint(view));
+  render(view);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(before, black, PLANE_SIZE);
+  view.humidity++;
+  TEST_ASSERT_TRUE(fingerprint != weatherFingerprint(view));
+}
+
+void test_color_changes_change_the_fingerprint() {
+  WeatherView view = frames[0].view;
+  view.imperial = false;
+  view.hours[0].temp = 0.4;
+  view.days[0].tempMin = 0.4;
+  const uint32_t fingerprint = weatherFingerprint(view);
+  // Still printed as 0, but freezing and drawn in ACCENT_COLOR
+  view.hours[0].temp = -0.4;
+  TEST_ASSERT_TRUE(fingerprint != weatherFingerprint(view));
+  view.hours[0].temp = 0.4;
+  view.days[0].tempMin = -0.4;
+  TEST_ASSERT_TRUE(fingerprint != weatherFingerprint(view));
+}
+
+void test_alert_is_drawn_in_the_accent_color() {
+  static uint8_t plain[PLANE_SIZE];
+  static uint8_t alerted[PLANE_SIZE];
+  WeatherView view = frames[0].view;
+  render(view);
+  memcpy(plain, black, PLANE_SIZE);
+  const uint32_t fingerprint = weatherFingerprint(view);
+  view.alert = "Heat Advisory";
+  TEST_ASSERT_TRUE(fingerprint != weatherFingerprint(view));
+  render(view);
+  memcpy(alerted, black, PLANE_SIZE);
+  // On a three color panel the pixels the alert adds in black are colored
+  // and the black plane keeps the rest of the screen
+  beginCanvas(true);
+  render(view);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(plain, black, PLANE_SIZE);
+  uint32_t colored = 0;
+  for (uint32_t i = 0; i < PLANE_SIZE; i++) {
+    TEST_ASSERT_EQUAL_HEX8((uint8_t)(~alerted[i] & plain[i]),
+                           (uint8_t)~color[i]);
+    colored += __builtin_popcount((uint8_t)~color[i]);
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(0, colored);
+}
+
+void test_worst_case_fits_the_draw_list() {
+  // Every temperature colored but the daily highs, which records a color
+  // change before and after each of them
+  WeatherView view = frames[1].view;
+  view.temp = view.tempMin = view.tempMax = -10;
+  for (WeatherHour& hour : view.hours) {
+    hour.temp = 35;
+  }
+  for (WeatherDay& day : view.days) {
+    day.tempMin = 0;
+    day.tempMax = 5;
+  }
+  render(view);
+  TEST_ASSERT_FALSE(screen.overflow);
+  char message[64];
+  snprintf(message, sizeof(message), "%u of %u draw ops", screen.count,
+           MAX_DRAW_OPS);
+  TEST_MESSAGE(message);
+}
+
+// Replays the recorded screen a page at a time into pages of PAGE_HEIGHT rows
+// like renderScreen() with PAGED_DISPLAY, and puts the pages together
+static void renderPaged(const WeatherView& view, bool threeColor,
+                        uint8_t* frameBlack, uint8_t* frameColor) {
+  static uint8_t pageBlack[WIDTH / 8 * PAGE_HEIGHT];
+  static uint8_t pageColor[WIDTH / 8 * PAGE_HEIGHT];
+  canvas.begin(WIDTH, HEIGHT, PAGE_HEIGHT, pageBlack,
+               threeColor ? pageColor : nullptr);
+  canvas.setRotation(0);
+  drawWeather(view);
+  for (canvas.top = 0; canvas.top < HEIGHT; canvas.top += PAGE_HEIGHT) {
+    replayScreen();
+    const uint32_t offset = (uint32_t)canvas.top * (WIDTH / 8);
+    const uint32_t size = canvas.target(false).rows * (WIDTH / 8);
+    memcpy(frameBlack + offset, pageBlack, size);
+    if (threeColor) {
+      memcpy(frameColor + offset, pageColor, size);
+    }
+  }
+  canvas.top = 0;
+}
+
+void test_paged_replay_gives_the_full_frame() {
+  static uint8_t pagedBlack[PLANE_SIZE];
+  static uint8_t pagedColor[PLANE_SIZE];
+  size_t peak[2] = {0, 0};
+  for (const Frame& frame : frames) {
+    for (bool threeColor : {false, true}) {
+      beginCanvas(threeColor);
+      heapPeak = heapUsed;
+      size_t start = heapUsed;
+      render(frame.view);
+      peak[0] = std::max(peak[0], heapPeak - start);
+      memset(pagedBlack, 0x55, PLANE_SIZE);
+      memset(pagedColor, 0x55, PLANE_SIZE);
+      heapPeak = heapUsed;
+      start = heapUsed;
+      renderPaged(frame.view, threeColor, pagedBlack, pagedColor);
+      peak[1] = std::max(peak[1], heapPeak - start);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(black, pagedBlack, PLANE_SIZE,
+                                            frame.name);
+      if (threeColor) {
+        TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(color, pagedColor, PLANE_SIZE,
+                                              frame.name);
+      }
+    }
+  }
+  // The planes are static, the heap only holds what the render allocates
+  char message[160];
+  snprintf(message, sizeof(message),
+           "full frame: %u bytes per plane, %u bytes peak heap; pages of %u "
+           "rows: %u bytes per plane, %u bytes peak heap",
+           (unsigned)PLANE_SIZE, (unsigned)peak[0], PAGE_HEIGHT,
+           (unsigned)(WIDTH / 8 * PAGE_HEIGHT), (unsigned)peak[1]);
+  TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_clouds);
+  RUN_TEST(test_snow_night);
+  RUN_TEST(test_thunderstorm);
+  RUN_TEST(test_icons_from_spiffs_match_the_atlas);
+  RUN_TEST(test_unchanged_fingerprint_gives_the_same_frame);
+  RUN_TEST(test_color_changes_change_the_fingerprint);
+  RUN_TEST(test_alert_is_drawn_in_the_accent_color);
+  RUN_TEST(test_worst_case_fits_the_draw_list);
+  RUN_TEST(test_paged_replay_gives_the_full_frame);
+  return UNITY_END();
+}
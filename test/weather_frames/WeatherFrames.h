@@ -0,0 +1,90 @@
+#ifndef WeatherFrames_h
+#define WeatherFrames_h
+
+#include <WeatherScreen.h>
+
+// Shared by the weather screen tests, included as
+// "../weather_frames/WeatherFrames.h". The folder has no test_ prefix, so
+// pio test doesn't build it as a test of its own.
+
+struct Frame {
+  const char* name;
+  WeatherView view;
+};
+
+// The weather of the payloads tools/mock_openweather.py serves, one frame per
+// kind of screen: plain, cold at night with the battery low, hot with a long
+// condition in the smaller font and an alert while charging
+static const Frame frames[] = {
+    {"clouds",
+     {"New York",
+      "New York",
+      "US",
+      true,
+      "Clouds",
+      ICON_CLOUDY,
+      57.3,
+      49.6,
+      61.2,
+      64,
+      BATTERY_DISCHARGING,
+      "",
+      {{14, 0, 57.9, ICON_CLOUDY},
+       {15, 0, 58.6, ICON_PARTLY_CLOUDY_DAY},
+       {16, 0, 59.0, ICON_PARTLY_CLOUDY_DAY},
+       {17, 0, 57.2, ICON_LIGHT_RAIN},
+       {18, 0, 54.8, ICON_RAIN}},
+      {{2, 48.2, 60.1, ICON_RAIN},
+       {3, 45.0, 55.4, ICON_CLOUDY},
+       {4, 41.7, 52.3, ICON_CLEAR_DAY},
+       {5, 44.9, 58.8, ICON_PARTLY_CLOUDY_DAY},
+       {6, 50.1, 63.5, ICON_DRIZZLE}}}},
+    {"snow_night",
+     {"Tromso",
+      "Troms",
+      "NO",
+      false,
+      "Snow",
+      ICON_SNOW,
+      -3.6,
+      -7.2,
+      0.4,
+      91,
+      BATTERY_LOW,
+      "",
+      {{22, 0, -3.9, ICON_SNOW},
+       {23, 0, -4.4, ICON_SNOW},
+       {0, 0, -5.1, ICON_CLOUDY},
+       {1, 0, -5.6, ICON_CLEAR_NIGHT},
+       {2, 0, -6.0, ICON_PARTLY_CLOUDY_NIGHT}},
+      {{5, -8.3, -1.2, ICON_SNOW},
+       {6, -6.5, 1.8, ICON_SLEET},
+       {7, -2.0, 3.4, ICON_RAIN},
+       {1, -9.7, -4.1, ICON_CLEAR_DAY},
+       {2, -5.5, 0.6, ICON_CLOUDY}}}},
+    {"thunderstorm",
+     {"Phoenix",
+      "Arizona",
+      "US",
+      false,
+      "Thunderstorm",
+      ICON_THUNDERSTORM,
+      34.5,
+      27.8,
+      41.3,
+      23,
+      BATTERY_CHARGING,
+      "Severe Thunderstorm Warning",
+      {{17, 30, 36.2, ICON_THUNDERSTORM},
+       {18, 30, 33.9, ICON_THUNDERSTORM},
+       {19, 30, 31.5, ICON_RAIN},
+       {20, 30, 30.2, ICON_CLOUDY},
+       {21, 30, 29.4, ICON_CLEAR_NIGHT}},
+      {{4, 28.9, 42.0, ICON_CLEAR_DAY},
+       {5, 29.3, 40.7, ICON_WIND},
+       {6, 27.1, 38.2, ICON_THUNDERSTORM},
+       {7, 25.6, 35.9, ICON_FOG},
+       {1, 26.8, 39.4, ICON_CLEAR_DAY}}}},
+};
+
+#endif
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Turn the GFXfont glyph tables of the fonts the firmware uses into constexpr
+metrics.
+
+Runs before every PlatformIO build (extra_scripts = pre:...) and writes
+include/FontMetrics.h from the Fonts/ headers of the installed Adafruit GFX
+Library, with the width, height, xAdvance and offsets of every glyph. The
+tables are for include/TextMetrics.h, which measures text like
+getTextBounds() at compile time. The output is only rewritten when it
+changes, so it doesn't trigger needless rebuilds.
+
+The native env only builds Adafruit_GFX.cpp of the library, see
+tools/native_gfx.py, so the library folder is also put on the include path
+for Adafruit_GFX.h, gfxfont.h and the fonts.
+
+Can also be run by hand with the Adafruit GFX Library Fonts directory:
+python tools/gen_font_metrics.py path/to/Adafruit_GFX/Fonts
+"""
+
+import glob
+import os
+import re
+import sys
+
+FONTS = ("FreeMono9pt7b", "FreeMono12pt7b", "FreeMono18pt7b", "FreeMono24pt7b")
+
+
+def project_dir():
+    try:
+        Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+        return env.subst("$PROJECT_DIR")  # noqa: F821
+    except NameError:
+        return os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def fonts_dir():
+    try:
+        libdeps = env.subst("$PROJECT_LIBDEPS_DIR/$PIOENV")  # noqa: F821
+    except NameError:
+        if len(sys.argv) > 1:
+            return sys.argv[1]
+        libdeps = os.path.join(project_dir(), ".pio", "libdeps")
+    pattern = os.path.join(libdeps, "**", "Fonts", FONTS[0] + ".h")
+    found = glob.glob(pattern, recursive=True)
+    if not found:
+        raise FileNotFoundError("Adafruit GFX Library fonts not found under "
+                                + libdeps)
+    return os.path.dirname(found[0])
+
+
+def parse_font(path, name):
+    """Return (first, last, yAdvance, glyphs) of a GFXfont header."""
+    with open(path) as f:
+        text = f.read()
+    table = re.search(r"GFXglyph\s+%sGlyphs\[\][^{]*\{(.*?)\};" % name,
+                      text, re.S)
+    font = re.search(r"GFXfont\s+%s\b[^{]*\{(.*?)\};" % name, text, re.S)
+    if table is None or font is None:
+        raise ValueError("no GFXfont %s in %s" % (name, path))
+    # Comments name the glyph and may contain braces, e.g. 0x7B '{'
+    body = re.sub(r"//[^\n]*", "", table.group(1))
+    glyphs = []
+    for entry in re.findall(r"\{([^{}]*)\}", body):
+        # bitmapOffset, width, height, xAdvance, xOffset, yOffset
+        values = [int(v, 0) for v in entry.split(",")]
+        glyphs.append(tuple(values[1:6]))
+    first, last, y_advance = [int(v, 0) for v in
+                              font.group(1).split(",")[-3:]]
+    if len(glyphs) != last - first + 1:
+        raise ValueError("%s has %d glyphs for 0x%02X-0x%02X"
+                         % (name, len(glyphs), first, last))
+    return first, last, y_advance, glyphs
+
+
+def monospaced_advance(glyphs):
+    """xAdvance when every glyph has it and stays inside its cell, else 0."""
+    advance = glyphs[0][2]
+    for width, height, x_advance, x_offset, y_offset in glyphs:
+        if x_advance != advance or x_offset < 0 or x_offset >= advance or \
+                x_offset + width > advance:
+            return 0
+    return advance
+
+
+def generate(directory):
+    lines = [
+        "// Generated by tools/gen_font_metrics.py from the Adafruit GFX "
+        "Library fonts, do not edit",
+        "#ifndef FontMetrics_h",
+        "#define FontMetrics_h",
+        "",
+        "#include <TextMetrics.h>",
+        "",
+    ]
+    summary = []
+    for name in FONTS:
+        first, last, y_advance, glyphs = parse_font(
+            os.path.join(directory, name + ".h"), name)
+        advance = monospaced_advance(glyphs)
+        lines.append("constexpr GlyphMetrics %sGlyphMetrics[] = {" % name)
+        for code, glyph in enumerate(glyphs, first):
+            lines.append("    {%d, %d, %d, %d, %d}, // 0x%02X" % (glyph + (code,)))
+        lines.append("};")
+        lines.append("constexpr FontMetrics %sMetrics = {0x%02X, 0x%02X, %d, %d,"
+                     % (name, first, last, y_advance, advance))
+        lines.append("    %sGlyphMetrics};" % name)
+        lines.append("")
+        summary.append("%s %s" % (name, "monospaced" if advance else
+                                  "proportional"))
+    lines += ["#endif", ""]
+    return "\n".join(lines), summary
+
+
+def add_include_path(directory):
+    try:
+        env.Append(CPPPATH=[os.path.dirname(directory)])  # noqa: F821
+    except NameError:
+        pass
+
+
+def main():
+    output = os.path.join(project_dir(), "include", "FontMetrics.h")
+    directory = fonts_dir()
+    add_include_path(directory)
+    text, summary = generate(directory)
+    try:
+        with open(output) as f:
+            if f.read() == text:
+                return
+    except FileNotFoundError:
+        pass
+    with open(output, "w") as f:
+        f.write(text)
+    print("Font metrics: " + ", ".join(summary))
+
+
+main()
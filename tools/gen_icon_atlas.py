@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""Convert the 1bpp weather icons in data/ into a flash-resident atlas.
+
+Runs before every PlatformIO build (extra_scripts = pre:...) and writes
+include/IconAtlas.h, where every BMP under data/icon and data/icon50 becomes
+a packed bitmap in the Adafruit_GFX drawBitmap() layout (rows top to bottom,
+MSB first) indexed by a generated IconAsset enum. Set bits are the pixels
+drawBitmapFromSpiffs() draws in black, which are the whitish ones in the BMP.
+Every folder has to hold the same icons, so the same icon of the next folder
+is always ICON_FOLDER_SIZE assets further on.
+The output is only rewritten when it changes, so it doesn't trigger needless
+rebuilds.
+
+Can also be run by hand: python tools/gen_icon_atlas.py
+"""
+
+import os
+import struct
+
+ATLAS_DIRS = ("icon", "icon50")
+
+
+def project_dir():
+    try:
+        Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+        return env.subst("$PROJECT_DIR")  # noqa: F821
+    except NameError:
+        return os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def decode_bmp(data):
+    """Return (width, height, packed rows) of a 1bpp BMP, set bit = drawn."""
+    if data[:2] != b"BM":
+        raise ValueError("not a bitmap")
+    offset, header_size, width, height, planes, depth, compression = \
+        struct.unpack_from("<IIiiHHI", data, 10)
+    if depth != 1 or planes != 1 or compression != 0:
+        raise ValueError("only uncompressed 1bpp bitmaps are supported")
+    # Same whitish rule as drawBitmapFromSpiffs() without color
+    drawn = []
+    for index in range(2):
+        blue, green, red = data[14 + header_size + 4 * index:][:3]
+        drawn.append(red + green + blue > 3 * 0x80)
+
+    flip = height > 0
+    height = abs(height)
+    row_size = (width + 31) // 32 * 4
+    out_size = (width + 7) // 8
+    rows = []
+    for row in range(height):
+        src = height - 1 - row if flip else row
+        line = data[offset + src * row_size:][:row_size]
+        packed = bytearray(out_size)
+        for x in range(width):
+            index = (line[x // 8] >> (7 - x % 8)) & 1
+            if drawn[index]:
+                packed[x // 8] |= 0x80 >> (x % 8)
+        rows.append(bytes(packed))
+    return width, height, rows
+
+
+def identifier(directory, name):
+    return (directory + "_" + name).upper().replace("-", "_")
+
+
+def generate(root):
+    assets = []
+    names = None
+    for directory in ATLAS_DIRS:
+        folder = os.path.join(root, "data", directory)
+        files = sorted(f for f in os.listdir(folder) if f.endswith(".bmp"))
+        if names is not None and files != names:
+            raise ValueError("data/%s doesn't have the icons of data/%s"
+                             % (directory, ATLAS_DIRS[0]))
+        names = files
+        for file in files:
+            with open(os.path.join(folder, file), "rb") as f:
+                width, height, rows = decode_bmp(f.read())
+            assets.append(("/%s/%s" % (directory, file),
+                           identifier(directory, file[:-4]), width, height, rows))
+
+    lines = [
+        "// Generated by tools/gen_icon_atlas.py from data/%s, do not edit"
+        % " and data/".join(ATLAS_DIRS),
+        "#ifndef IconAtlas_h",
+        "#define IconAtlas_h",
+        "",
+        "#include <Arduino.h>",
+        "",
+        "enum IconAsset : uint8_t {",
+    ]
+    lines += ["  %s," % asset[1] for asset in assets]
+    lines += ["  ICON_ASSET_COUNT", "};", ""]
+    lines += [
+        "// Icons in each folder, the same ones in the same order",
+        "const uint8_t ICON_FOLDER_SIZE = %d;" % len(names),
+        "",
+        "// SPIFFS paths of the source bitmaps",
+        "static const char* const ICON_ASSET_PATHS[ICON_ASSET_COUNT] = {",
+    ]
+    lines += ['    "%s",' % asset[0] for asset in assets]
+    lines += ["};", ""]
+    lines += [
+        "struct IconBitmap {",
+        "  uint16_t width;",
+        "  uint16_t height;",
+        "  const uint8_t* bits; // rows of (width + 7) / 8 bytes, set bit = drawn",
+        "};",
+        "",
+    ]
+    total = 0
+    for path, name, width, height, rows in assets:
+        data = b"".join(rows)
+        total += len(data)
+        lines.append("static const uint8_t %s_BITS[] PROGMEM = {" % name)
+        for i in range(0, len(data), 16):
+            lines.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+        lines.append("};")
+    lines.append("")
+    lines.append("static const IconBitmap ICON_ATLAS[ICON_ASSET_COUNT] = {")
+    for path, name, width, height, rows in assets:
+        lines.append("    {%d, %d, %s_BITS}," % (width, height, name))
+    lines += [
+        "};",
+        "",
+        "// Total bitmap data: %d bytes" % total,
+        "const uint32_t ICON_ATLAS_BYTES = %d;" % total,
+        "",
+        "#endif",
+        "",
+    ]
+    return "\n".join(lines), len(assets), total
+
+
+def main():
+    root = project_dir()
+    output = os.path.join(root, "include", "IconAtlas.h")
+    text, count, total = generate(root)
+    try:
+        with open(output) as f:
+            if f.read() == text:
+                return
+    except FileNotFoundError:
+        pass
+    with open(output, "w") as f:
+        f.write(text)
+    print("Icon atlas: %d icons, %d bytes of flash" % (count, total))
+
+
+main()
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Write the same icon as a BMP at every depth drawBitmapFromSpiffs() handles.
+
+The bitmaps go to .pio/bitmaps/ as bench1.bmp, bench4.bmp, ... bench32.bmp,
+with 16 bit in both 555 (bench16.bmp) and 565 (bench16_565.bmp). The
+test_bitmap_depths host test writes them, checks that every depth draws the
+pixels of the 1bpp fast path and times the draw per depth:
+
+    pio test -e native -f test_bitmap_depths
+
+    python tools/make_bench_bitmaps.py [--source data/icon/clear-day.bmp]
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+# (file name, bits per pixel, compression), compression 3 is 565 bitfields
+BITMAPS = (
+    ("bench1.bmp", 1, 0),
+    ("bench4.bmp", 4, 0),
+    ("bench8.bmp", 8, 0),
+    ("bench16.bmp", 16, 0),
+    ("bench16_565.bmp", 16, 3),
+    ("bench24.bmp", 24, 0),
+    ("bench32.bmp", 32, 0),
+)
+
+
+def read_mono(path):
+    """Return (width, height, rows of booleans, True = white) of a 1bpp BMP."""
+    with open(path, "rb") as f:
+        data = f.read()
+    offset, header_size, width, height, _, depth = \
+        struct.unpack_from("<IIiiHH", data, 10)
+    if depth != 1:
+        raise ValueError("%s is not a 1bpp bitmap" % path)
+    white = []
+    for index in range(2):
+        blue, green, red = data[14 + header_size + 4 * index:][:3]
+        white.append(red + green + blue > 3 * 0x80)
+    flip = height > 0
+    height = abs(height)
+    row_size = (width + 31) // 32 * 4
+    rows = []
+    for row in range(height):
+        src = height - 1 - row if flip else row
+        line = data[offset + src * row_size:][:row_size]
+        rows.append([white[(line[x // 8] >> (7 - x % 8)) & 1]
+                     for x in range(width)])
+    return width, height, rows
+
+
+def pack_row(pixels, depth, compression):
+    if depth <= 8:
+        out = bytearray((len(pixels) * depth + 7) // 8)
+        for x, white in enumerate(pixels):
+            if white:
+                bit = x * depth
+                out[bit // 8] |= 1 << (8 - depth - bit % 8)
+        return bytes(out)
+    if depth == 16:
+        white_value = 0xFFFF if compression == 3 else 0x7FFF
+        return b"".join(struct.pack("<H", white_value if white else 0)
+                        for white in pixels)
+    white_value = b"\xff" * (depth // 8)
+    return b"".join(white_value if white else bytes(depth // 8)
+                    for white in pixels)
+
+
+def write_bmp(path, width, height, rows, depth, compression=0):
+    # Palettes always have 1 << depth entries because the firmware finds the
+    # palette by counting back from the pixel data offset. 565 has its red,
+    # green and blue masks there instead.
+    palette = b""
+    if depth <= 8:
+        palette = b"\x00\x00\x00\x00" + b"\xff\xff\xff\x00" * ((1 << depth) - 1)
+    elif compression == 3:
+        palette = struct.pack("<III", 0xF800, 0x07E0, 0x001F)
+    row_size = (width * depth + 31) // 32 * 4
+    pixels = b"".join(pack_row(row, depth, compression).ljust(row_size, b"\0")
+                      for row in reversed(rows))
+    offset = 14 + 40 + len(palette)
+    header = struct.pack("<2sIHHI", b"BM", offset + len(pixels), 0, 0, offset)
+    info = struct.pack("<IiiHHIIiiII", 40, width, height, 1, depth,
+                       compression, len(pixels), 2835, 2835, 0, 0)
+    with open(path, "wb") as f:
+        f.write(header + info + palette + pixels)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--source",
+                        default=os.path.join(ROOT, "data", "icon", "clear-day.bmp"))
+    parser.add_argument("--output", default=os.path.join(ROOT, ".pio", "bitmaps"))
+    args = parser.parse_args()
+    width, height, rows = read_mono(args.source)
+    os.makedirs(args.output, exist_ok=True)
+    for name, depth, compression in BITMAPS:
+        path = os.path.join(args.output, name)
+        write_bmp(path, width, height, rows, depth, compression)
+        print("Wrote %s (%d bytes)" % (path, os.path.getsize(path)))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
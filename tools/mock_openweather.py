@@ -0,0 +1,325 @@
+#!/usr/bin/env python3
+"""Local mock OpenWeather server with network condition shaping.
+
+Serves recorded onecall, forecast, Open-Meteo and reverse geocoding payloads
+over plain HTTP so the firmware can be pointed at it with MOCK_SERVER_HOST
+and MOCK_SERVER_PORT in src/main.cpp. Each request is served under one
+network scenario (latency, bandwidth, slow headers, a stall, truncation,
+connection reset, a stall ended by a reset), either a fixed one or cycling
+through all of them. Responses only hold the sections the request asks
+for, and Open-Meteo ones only its forecast_hours and forecast_days.
+
+Record payloads once from the real API:
+
+    python tools/mock_openweather.py record --api-key KEY --lat 40.7128 --lon -74.0060
+
+then serve them:
+
+    python tools/mock_openweather.py serve --port 8080 --scenario cycle
+
+or compare the size and host parse time of the recorded weather payloads:
+
+    python tools/mock_openweather.py compare
+
+The parse time of the firmware's streaming decoder is reported on the host
+by test/test_open_weather, and on the device as "Done in ... ms" per request
+when pointed at this server, with USE_OPEN_METEO switching between the two
+forecast sources.
+
+Per scenario the server reports time to first byte and total send time as
+seen from the server, and how many responses were delivered completely.
+Whether the firmware parsed them is printed on its serial port. The native
+test replays the committed payloads under the same scenarios through the
+OpenWeather library and reports how many of them it parsed:
+
+    pio test -e native -f test_open_weather
+
+Served with --scenario normal the payloads always render the same weather
+frame, so the "Frame hash" the firmware logs can be put in GOLDEN_FRAME_HASH
+to check that rendering changes keep every pixel the same.
+"""
+
+import argparse
+import json
+import os
+import socket
+import socketserver
+import struct
+import sys
+import threading
+import time
+import urllib.request
+from urllib.parse import parse_qs, urlparse
+
+PAYLOAD_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "payloads")
+
+# Request path suffix -> recorded payload file
+ENDPOINTS = {
+    "/data/2.5/onecall": "onecall.json",
+    "/data/3.0/onecall": "onecall.json",
+    "/data/2.5/forecast": "forecast.json",
+    "/geo/1.0/reverse": "reverse.json",
+    "/v1/forecast": "openmeteo.json",
+}
+
+# Fields requested by OW_Weather::getOpenMeteoForecast(), recorded for the
+# longest range the library can store and cut to each request when served
+OPEN_METEO_FIELDS = (
+    "&current=temperature_2m,relative_humidity_2m,weather_code"
+    "&hourly=temperature_2m,weather_code&forecast_hours=%d"
+    "&daily=weather_code,temperature_2m_max,temperature_2m_min,sunrise,sunset"
+    "&forecast_days=%d&timeformat=unixtime&timezone=auto")
+
+# name: (latency s, bandwidth bytes/s or 0, header drip s per line,
+#        truncate fraction or 0, reset fraction or 0)
+SCENARIOS = {
+    "normal": (0.0, 0, 0.0, 0.0, 0.0),
+    "latency": (1.5, 0, 0.0, 0.0, 0.0),
+    "slow-link": (0.2, 2000, 0.0, 0.0, 0.0),
+    "slow-headers": (0.0, 0, 1.5, 0.0, 0.0),
+    "stall": (0.0, 0, 0.0, 0.0, 0.0),
+    "stall-reset": (0.0, 0, 0.0, 0.0, 0.5),
+    "truncate": (0.0, 0, 0.0, 0.5, 0.0),
+    "reset": (0.0, 0, 0.0, 0.0, 0.5),
+}
+STALL_TIME = 10.0  # seconds of silence injected halfway by "stall*"
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.rows = {}
+
+    def add(self, scenario, ttfb, total, delivered):
+        with self.lock:
+            row = self.rows.setdefault(scenario, [0, 0, 0.0, 0.0])
+            row[0] += 1
+            row[1] += 1 if delivered else 0
+            row[2] += ttfb
+            row[3] += total
+
+    def report(self):
+        print("\n%-13s %8s %9s %10s %10s" %
+              ("scenario", "requests", "delivered", "ttfb ms", "total ms"))
+        for name, (count, ok, ttfb, total) in sorted(self.rows.items()):
+            print("%-13s %8d %8.0f%% %10.0f %10.0f" %
+                  (name, count, 100.0 * ok / count, 1000 * ttfb / count,
+                   1000 * total / count))
+
+
+class Handler(socketserver.BaseRequestHandler):
+    def handle(self):
+        server = self.server
+        request = b""
+        while b"\r\n\r\n" not in request:
+            chunk = self.request.recv(1024)
+            if not chunk:
+                return
+            request += chunk
+        start = time.monotonic()
+        target = request.split(b" ", 2)[1].decode()
+        url = urlparse(target)
+        path = url.path
+        payload = load_payload(path)
+        if payload is not None and path.endswith("/v1/forecast"):
+            payload = open_meteo_payload(payload, parse_qs(url.query))
+        elif payload is not None and path.endswith("/onecall"):
+            payload = onecall_payload(payload, parse_qs(url.query))
+
+        scenario = server.next_scenario()
+        latency, bandwidth, drip, truncate, reset = SCENARIOS[scenario]
+        status = "200 OK" if payload is not None else "404 Not Found"
+        body = payload if payload is not None else b'{"cod":404}'
+        header_lines = [
+            "HTTP/1.1 " + status,
+            "Content-Type: application/json; charset=utf-8",
+            "Content-Length: %d" % len(body),
+            "Date: " + time.strftime("%a, %d %b %Y %H:%M:%S GMT", time.gmtime()),
+            "Connection: close",
+        ]
+
+        ttfb = None
+        sent = 0
+        delivered = False
+        try:
+            time.sleep(latency)
+            for line in header_lines:
+                self.request.sendall((line + "\r\n").encode())
+                if ttfb is None:
+                    ttfb = time.monotonic() - start
+                time.sleep(drip)
+            self.request.sendall(b"\r\n")
+
+            limit = len(body)
+            if truncate:
+                limit = int(len(body) * truncate)
+            if reset:
+                limit = int(len(body) * reset)
+            chunk = max(64, bandwidth // 20) if bandwidth else 1460
+            stalled = False
+            while sent < limit:
+                part = body[sent:min(sent + chunk, limit)]
+                self.request.sendall(part)
+                sent += len(part)
+                if bandwidth:
+                    time.sleep(len(part) / bandwidth)
+                if (scenario.startswith("stall") and not stalled and
+                        sent >= len(body) // 2):
+                    time.sleep(STALL_TIME)
+                    stalled = True
+            if reset:
+                # SO_LINGER with a zero timeout makes close() send a RST
+                self.request.setsockopt(socket.SOL_SOCKET, socket.SO_LINGER,
+                                        struct.pack("ii", 1, 0))
+            delivered = sent == len(body)
+        except OSError:
+            pass
+        total = time.monotonic() - start
+        server.stats.add(scenario, ttfb or total, total, delivered)
+        print("%-13s %-22s %6d/%6d bytes %6.0f ms" %
+              (scenario, path, sent, len(body), total * 1000))
+
+
+class MockServer(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+    def __init__(self, address, scenario):
+        super().__init__(address, Handler)
+        self.stats = Stats()
+        self.scenario = scenario
+        self.counter = 0
+        self.lock = threading.Lock()
+
+    def next_scenario(self):
+        if self.scenario != "cycle":
+            return self.scenario
+        with self.lock:
+            names = sorted(SCENARIOS)
+            name = names[self.counter % len(names)]
+            self.counter += 1
+            return name
+
+
+def load_payload(path):
+    for suffix, name in ENDPOINTS.items():
+        if path.endswith(suffix):
+            try:
+                with open(os.path.join(PAYLOAD_DIR, name), "rb") as f:
+                    return f.read()
+            except FileNotFoundError:
+                print("No recorded payload %s, run the record command first" % name)
+                return None
+    return None
+
+
+def onecall_payload(payload, query):
+    """Drop the sections of a recorded onecall payload the request excludes."""
+    excluded = ",".join(query.get("exclude", [])).split(",")
+    data = json.loads(payload)
+    for section in excluded:
+        data.pop(section, None)
+    return json.dumps(data, separators=(",", ":"),
+                      ensure_ascii=False).encode()
+
+
+def open_meteo_payload(payload, query):
+    """Cut a recorded Open-Meteo payload to the sections and range asked for."""
+    data = json.loads(payload)
+    for section in ("current", "hourly", "daily"):
+        if section not in query:
+            data.pop(section, None)
+            data.pop(section + "_units", None)
+    for section, count in (("hourly", "forecast_hours"),
+                           ("daily", "forecast_days")):
+        if section in data and count in query:
+            n = int(query[count][0])
+            data[section] = {key: values[:n]
+                             for key, values in data[section].items()}
+    return json.dumps(data, separators=(",", ":"),
+                      ensure_ascii=False).encode()
+
+
+def record(args):
+    os.makedirs(PAYLOAD_DIR, exist_ok=True)
+    query = "lat=%s&lon=%s&appid=%s" % (args.lat, args.lon, args.api_key)
+    urls = {
+        "onecall.json": "https://api.openweathermap.org/data/2.5/onecall?" + query +
+                        "&exclude=minutely&units=%s&lang=%s" % (args.units, args.lang),
+        "forecast.json": "https://api.openweathermap.org/data/2.5/forecast?" + query +
+                         "&units=%s&lang=%s" % (args.units, args.lang),
+        "reverse.json": "https://api.openweathermap.org/geo/1.0/reverse?" + query + "&limit=1",
+        "openmeteo.json": "https://api.open-meteo.com/v1/forecast?latitude=%s&longitude=%s" %
+                          (args.lat, args.lon) +
+                          OPEN_METEO_FIELDS % (args.forecast_hours,
+                                               args.forecast_days) +
+                          ("&temperature_unit=fahrenheit&wind_speed_unit=mph"
+                           if args.units == "imperial" else ""),
+    }
+    for name, url in urls.items():
+        try:
+            with urllib.request.urlopen(url) as response:
+                data = response.read()
+        except OSError as e:
+            print("Failed to record %s: %s" % (name, e))
+            continue
+        json.loads(data)  # Only keep valid JSON
+        with open(os.path.join(PAYLOAD_DIR, name), "wb") as f:
+            f.write(data)
+        print("Recorded %s (%d bytes)" % (name, len(data)))
+
+
+def compare(args):
+    print("%-15s %8s %14s" % ("payload", "bytes", "parse us/run"))
+    for name in ("onecall.json", "forecast.json", "openmeteo.json"):
+        try:
+            with open(os.path.join(PAYLOAD_DIR, name), "rb") as f:
+                data = f.read()
+        except FileNotFoundError:
+            continue
+        start = time.perf_counter()
+        for _ in range(args.runs):
+            json.loads(data)
+        elapsed = (time.perf_counter() - start) / args.runs
+        print("%-15s %8d %14.0f" % (name, len(data), elapsed * 1e6))
+
+
+def serve(args):
+    server = MockServer(("0.0.0.0", args.port), args.scenario)
+    print("Serving %s on port %d, scenario %s" % (PAYLOAD_DIR, args.port, args.scenario))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    server.stats.report()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = parser.add_subparsers(dest="command", required=True)
+    rec = sub.add_parser("record", help="record payloads from the real API")
+    rec.add_argument("--api-key", required=True)
+    rec.add_argument("--lat", required=True)
+    rec.add_argument("--lon", required=True)
+    rec.add_argument("--units", default="imperial")
+    rec.add_argument("--lang", default="en")
+    rec.add_argument("--forecast-hours", type=int, default=48)
+    rec.add_argument("--forecast-days", type=int, default=8)
+    srv = sub.add_parser("serve", help="serve recorded payloads")
+    srv.add_argument("--port", type=int, default=8080)
+    srv.add_argument("--scenario", default="cycle",
+                     choices=["cycle"] + sorted(SCENARIOS))
+    cmp = sub.add_parser("compare",
+                         help="compare recorded payload sizes and parse time")
+    cmp.add_argument("--runs", type=int, default=1000)
+    args = parser.parse_args()
+    if args.command == "record":
+        record(args)
+    elif args.command == "compare":
+        compare(args)
+    else:
+        serve(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
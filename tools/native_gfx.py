@@ -0,0 +1,33 @@
+#!/usr/bin/env python3
+"""Build Adafruit_GFX.cpp into the native env.
+
+The native env ignores the Adafruit GFX Library because the whole library
+pulls in Adafruit BusIO and the Arduino core. The screen drawing in src/ only
+needs the Adafruit_GFX class though, so this script compiles just
+Adafruit_GFX.cpp of the installed library, against the host stand-ins for
+Arduino.h, Print.h and BusIO in test/native. That is what lets the unit tests
+render the weather screen on the host.
+
+Only meant as an extra script of the native env (extra_scripts = pre:...),
+after tools/gen_font_metrics.py has put the library on the include path.
+"""
+
+import glob
+import os
+
+Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+
+
+def library_dir():
+    libdeps = env.subst("$PROJECT_LIBDEPS_DIR/$PIOENV")  # noqa: F821
+    pattern = os.path.join(libdeps, "**", "Adafruit_GFX.cpp")
+    found = glob.glob(pattern, recursive=True)
+    if not found:
+        raise FileNotFoundError("Adafruit GFX Library not found under "
+                                + libdeps)
+    return os.path.dirname(found[0])
+
+
+env.BuildSources(  # noqa: F821
+    os.path.join("$BUILD_DIR", "AdafruitGFX"), library_dir(),
+    "-<*> +<Adafruit_GFX.cpp>")
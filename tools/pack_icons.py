@@ -0,0 +1,246 @@
+#!/usr/bin/env python3
+"""Pack the weather icons in data/ into a single indexed icon pack.
+
+The firmware opens the pack once per wake and draws every icon from it
+instead of opening a BMP file per draw, see include/IconPack.h for the
+format. Bitmaps are stored in the drawBitmap() layout with the same whitish
+rule as drawBitmapFromSpiffs(), each one PackBits encoded when --rle is given
+and that makes it smaller. Only the icons getMeteoconIcon() in
+src/WeatherScreen.cpp can return are packed, from data/icon and data/icon50,
+unless --all is given.
+
+Runs before every PlatformIO build (extra_scripts = pre:...). Builds with
+-D USE_SPIFFS_ICONS get data/icons.pack written with --rle whenever it
+changes. The default atlas build never reads the pack, so it is removed from
+data/ there and stays out of the filesystem image.
+
+Can also be run by hand:
+
+    python tools/pack_icons.py [--rle] [--all] [--output data/icons.pack]
+                               [--data data]
+
+--verify unpacks the result again and compares every icon. --data packs the
+icon folders of another directory, with --all every bitmap in them, like the
+fixtures of test/test_icon_pack.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+# The icon folders of the atlas, the same icons at both sizes
+FOLDERS = ("icon", "icon50")
+
+MAGIC = 0x4B504349  # "ICPK"
+VERSION = 1
+RAW = 0
+RLE = 1
+HEADER = struct.Struct("<IBBH")
+ENTRY = struct.Struct("<IHHIIB3x")
+
+
+def fnv1a(path):
+    value = 2166136261
+    for byte in path.encode():
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def decode_bmp(data):
+    """Return (width, height, packed bytes) of a 1bpp BMP, set bit = drawn."""
+    offset, header_size, width, height, planes, depth, compression = \
+        struct.unpack_from("<IIiiHHI", data, 10)
+    if data[:2] != b"BM" or depth != 1 or planes != 1 or compression != 0:
+        raise ValueError("only uncompressed 1bpp bitmaps are supported")
+    palette = offset - 8
+    drawn = [sum(data[palette + 4 * i:][:3]) > 3 * 0x80 for i in range(2)]
+    flip = height > 0
+    height = abs(height)
+    row_size = (width + 31) // 32 * 4
+    out_size = (width + 7) // 8
+    last_mask = (0xFF << ((8 - width % 8) % 8)) & 0xFF
+    out = bytearray()
+    for row in range(height):
+        src = height - 1 - row if flip else row
+        line = data[offset + src * row_size:][:out_size]
+        packed = bytearray(
+            (b if drawn[1] else 0) | (~b & 0xFF if drawn[0] else 0) for b in line)
+        packed[-1] &= last_mask
+        out += packed
+    return width, height, bytes(out)
+
+
+def rle_encode(data):
+    """PackBits: n < 128 means n + 1 literals, n > 128 a run of 257 - n."""
+    out = bytearray()
+    literals = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and run < 128 and data[i + run] == data[i]:
+            run += 1
+        if run >= 3:
+            if literals:
+                out += bytes([len(literals) - 1]) + literals
+                literals = bytearray()
+            out += bytes([257 - run, data[i]])
+            i += run
+        else:
+            literals.append(data[i])
+            i += 1
+            if len(literals) == 128:
+                out += bytes([127]) + literals
+                literals = bytearray()
+    if literals:
+        out += bytes([len(literals) - 1]) + literals
+    return bytes(out)
+
+
+def rle_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        control = data[i]
+        i += 1
+        if control < 128:
+            out += data[i:i + control + 1]
+            i += control + 1
+        elif control > 128:
+            out += bytes([data[i]]) * (257 - control)
+            i += 1
+    return bytes(out)
+
+
+def drawn_icons(root):
+    """Return the bitmap names getMeteoconIcon() can return, like "fog.bmp"."""
+    with open(os.path.join(root, "src", "WeatherScreen.cpp")) as f:
+        source = f.read()
+    body = re.search(r"^IconAsset getMeteoconIcon\(.*?^}", source,
+                     re.MULTILINE | re.DOTALL)
+    if body is None:
+        raise ValueError("getMeteoconIcon() not found in src/WeatherScreen.cpp")
+    return sorted(set(name[len("ICON_"):].lower().replace("_", "-") + ".bmp"
+                      for name in re.findall(r"return (ICON_\w+);",
+                                             body.group(0))))
+
+
+def collect(data, names=None):
+    """Read the bitmaps of the icon folders, only names when it is given."""
+    icons = []
+    for folder in FOLDERS:
+        directory = os.path.join(data, folder)
+        if not os.path.isdir(directory):
+            continue
+        for name in sorted(os.listdir(directory)):
+            if name.endswith(".bmp") and (names is None or name in names):
+                with open(os.path.join(directory, name), "rb") as f:
+                    icons.append(("/%s/%s" % (folder, name),) + decode_bmp(f.read()))
+    return icons
+
+
+def pack(icons, rle):
+    entries = []
+    hashes = {}
+    for path, width, height, bits in icons:
+        value = fnv1a(path)
+        if value in hashes:
+            raise ValueError("%s and %s have the same hash" % (path, hashes[value]))
+        hashes[value] = path
+        encoding, payload = RAW, bits
+        if rle:
+            encoded = rle_encode(bits)
+            if len(encoded) < len(bits):
+                encoding, payload = RLE, encoded
+        entries.append((value, width, height, encoding, payload))
+    entries.sort()
+
+    offset = HEADER.size + ENTRY.size * len(entries)
+    index = b""
+    payloads = b""
+    for value, width, height, encoding, payload in entries:
+        index += ENTRY.pack(value, width, height, offset + len(payloads),
+                            len(payload), encoding)
+        payloads += payload
+    return HEADER.pack(MAGIC, VERSION, 0, len(entries)) + index + payloads
+
+
+def verify(data, icons):
+    magic, version, _, count = HEADER.unpack_from(data)
+    assert magic == MAGIC and version == VERSION and count == len(icons)
+    index = {}
+    for i in range(count):
+        value, width, height, offset, size, encoding = \
+            ENTRY.unpack_from(data, HEADER.size + i * ENTRY.size)
+        payload = data[offset:offset + size]
+        index[value] = (width, height,
+                        rle_decode(payload) if encoding == RLE else payload)
+    for path, width, height, bits in icons:
+        assert index[fnv1a(path)] == (width, height, bits), path
+
+
+def spiffs_icons(env):
+    """True when the build draws its icons from SPIFFS, see include/Screen.h."""
+    flags = env.ParseFlags(env.get("BUILD_FLAGS", []))
+    for define in flags.get("CPPDEFINES", []):
+        if isinstance(define, (list, tuple)):
+            define = define[0]
+        if define == "USE_SPIFFS_ICONS":
+            return True
+    return False
+
+
+def build(env):
+    root = env.subst("$PROJECT_DIR")
+    output = os.path.join(env.subst("$PROJECT_DATA_DIR"), "icons.pack")
+    if not spiffs_icons(env):
+        if os.path.exists(output):
+            os.remove(output)
+            print("Icon atlas build, removed %s from the filesystem image" %
+                  output)
+        return
+    icons = collect(env.subst("$PROJECT_DATA_DIR"), drawn_icons(root))
+    data = pack(icons, True)
+    try:
+        with open(output, "rb") as f:
+            if f.read() == data:
+                return
+    except FileNotFoundError:
+        pass
+    with open(output, "wb") as f:
+        f.write(data)
+    print("Icon pack: %d icons, %d bytes" % (len(icons), len(data)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--rle", action="store_true",
+                        help="run length encode icons where that is smaller")
+    parser.add_argument("--all", action="store_true",
+                        help="pack every bitmap of the icon folders")
+    parser.add_argument("--output", default=os.path.join(ROOT, "data", "icons.pack"))
+    parser.add_argument("--verify", action="store_true",
+                        help="unpack the written pack and compare every icon")
+    parser.add_argument("--data", default=os.path.join(ROOT, "data"),
+                        help="directory with the icon folders")
+    args = parser.parse_args()
+    icons = collect(args.data, None if args.all else drawn_icons(ROOT))
+    data = pack(icons, args.rle)
+    with open(args.output, "wb") as f:
+        f.write(data)
+    raw = sum(len(bits) for _, _, _, bits in icons)
+    print("Packed %d icons into %s: %d bytes (%d bytes of raw bitmaps)" %
+          (len(icons), args.output, len(data), raw))
+    if args.verify:
+        verify(data, icons)
+        print("Verified")
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+    build(env)  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        sys.exit(main())
@@ -0,0 +1,259 @@
+#!/usr/bin/env python3
+"""Grab the frame the e-paper shows over the serial port.
+
+The firmware answers a "grab" line in the second it waits before deep
+sleeping with its frame buffer, coded with FrameCodec (see
+include/ScreenGrab.h and include/FrameCodec.h). This sends the command until
+the next wake answers it, prints the firmware log meanwhile and writes the
+frame as PNG or PBM, picked by the output extension. The color plane of
+three color panels is drawn in red in a PNG and in black in a PBM:
+
+    python tools/screen_grab.py --port /dev/ttyUSB0 --output screen.png
+
+Opening the port leaves DTR and RTS low so the board isn't reset. --raw
+keeps the received bytes, which --input decodes again without a board. A
+raw 400x300 frame takes 1.3 s at 115200 baud, a weather screen about a
+quarter of that.
+
+test/test_screen_grab decodes grabs written like sendScreenGrab() in
+src/main.cpp with --input.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+import zlib
+
+COMMAND = b"grab\n"
+MAGIC = b"EPGB"
+VERSION = 2  # SCREEN_GRAB_VERSION of include/ScreenGrab.h
+HEADER = struct.Struct("<4sBBHHBx")
+PLANE = struct.Struct("<II")
+RUN_ZERO = 0x80
+# Seconds from the magic to the last byte of the grab, header included
+GRAB_TIMEOUT = 10
+WHITE, BLACK, COLOR = 0, 1, 2
+PALETTE = b"\xff\xff\xff" b"\x00\x00\x00" b"\xff\x00\x00"
+
+
+def fnv1a(data):
+    value = 2166136261
+    for byte in data:
+        value = ((value ^ byte) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def decode_frame(data, length, row_bytes):
+    """Same as decodeFrame() in src/FrameCodec.cpp."""
+    frame = bytearray(length)
+    i = o = 0
+    while i < len(data):
+        control = data[i]
+        i += 1
+        run = (control & ~RUN_ZERO) + 1
+        literal = not control & RUN_ZERO
+        if o + run > length or (literal and i + run > len(data)):
+            raise ValueError("corrupt frame data")
+        for _ in range(run):
+            above = frame[o - row_bytes] if o >= row_bytes else 0xFF
+            if literal:
+                above ^= data[i]
+                i += 1
+            frame[o] = above
+            o += 1
+    if o != length:
+        raise ValueError("frame data ends after %d of %d bytes" % (o, length))
+    return bytes(frame)
+
+
+def grab_size(data):
+    """Bytes of the grab data starts with, None until the plane sizes are in."""
+    if len(data) < HEADER.size:
+        return None
+    size = HEADER.size
+    for _ in range(HEADER.unpack_from(data)[5]):
+        if len(data) < size + PLANE.size:
+            return None
+        size += PLANE.size + PLANE.unpack_from(data, size)[0]
+    return size
+
+
+def parse_grab(data):
+    """Return (rotation, width, height, planes) of a received grab."""
+    magic, version, rotation, width, height, count = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a version %d screen grab" % VERSION)
+    planes = []
+    offset = HEADER.size
+    for _ in range(count):
+        if len(data) < offset + PLANE.size:
+            raise ValueError("screen grab truncated")
+        size, digest = PLANE.unpack_from(data, offset)
+        offset += PLANE.size
+        payload = data[offset:offset + size]
+        if len(payload) != size:
+            raise ValueError("screen grab truncated")
+        plane = decode_frame(payload, width // 8 * height, width // 8)
+        if fnv1a(plane) != digest:
+            raise ValueError("plane hash mismatch")
+        planes.append(plane)
+        offset += size
+    return rotation, width, height, planes
+
+
+def rotate(planes, width, height, rotation):
+    """Return (width, height, rows of WHITE, BLACK or COLOR) as shown.
+
+    Mirrors the coordinate mapping of GxEPD2_BW::drawPixel().
+    """
+    row_bytes = width // 8
+
+    def pixel(x, y):
+        i = y * row_bytes + x // 8
+        bit = 0x80 >> (x % 8)
+        if not planes[0][i] & bit:
+            return BLACK
+        if len(planes) > 1 and not planes[1][i] & bit:
+            return COLOR
+        return WHITE
+
+    if rotation == 1:
+        return height, width, [[pixel(width - 1 - y, x) for x in range(height)]
+                               for y in range(width)]
+    if rotation == 2:
+        return width, height, [[pixel(width - 1 - x, height - 1 - y)
+                                for x in range(width)] for y in range(height)]
+    if rotation == 3:
+        return height, width, [[pixel(y, height - 1 - x) for x in range(height)]
+                               for y in range(width)]
+    return width, height, [[pixel(x, y) for x in range(width)]
+                           for y in range(height)]
+
+
+def pack_rows(rows, depth, value):
+    """Rows of depth bit pixels, MSB first and padded to bytes."""
+    per_byte = 8 // depth
+    packed = []
+    for row in rows:
+        line = bytearray((len(row) + per_byte - 1) // per_byte)
+        for x, pixel in enumerate(row):
+            shift = 8 - depth - (x % per_byte) * depth
+            line[x // per_byte] |= value(pixel) << shift
+        packed.append(bytes(line))
+    return packed
+
+
+def write_pbm(path, width, height, rows):
+    with open(path, "wb") as f:
+        f.write(b"P4\n%d %d\n" % (width, height))
+        f.write(b"".join(pack_rows(rows, 1, lambda p: p != WHITE)))
+
+
+def write_png(path, width, height, rows, color):
+    def chunk(kind, data):
+        return (struct.pack(">I", len(data)) + kind + data +
+                struct.pack(">I", zlib.crc32(kind + data) & 0xFFFFFFFF))
+
+    if color:
+        # 2-bit palette of WHITE, BLACK and COLOR
+        depth, color_type, lines = 2, 3, pack_rows(rows, 2, lambda p: p)
+    else:
+        # 1-bit grayscale where 1 is white
+        depth, color_type, lines = 1, 0, pack_rows(rows, 1,
+                                                   lambda p: p == WHITE)
+    raw = b"".join(b"\0" + line for line in lines)  # filter type 0
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, depth,
+                                           color_type, 0, 0, 0)))
+        if color:
+            f.write(chunk(b"PLTE", PALETTE))
+        f.write(chunk(b"IDAT", zlib.compress(raw, 9)))
+        f.write(chunk(b"IEND", b""))
+
+
+def receive(args):
+    """Return the raw grab, header and payload, read from the board."""
+    import serial  # pyserial, installed with PlatformIO
+
+    port = serial.Serial()
+    port.port = args.port
+    port.baudrate = args.baud
+    port.timeout = 0.1
+    port.dtr = False
+    port.rts = False
+    port.open()
+    print("Waiting up to %d s for the board to wake" % args.timeout)
+    deadline = time.monotonic() + args.timeout
+    received = b""
+    last_command = 0
+    while time.monotonic() < deadline:
+        if time.monotonic() - last_command > 0.25:
+            port.write(COMMAND)
+            last_command = time.monotonic()
+        received += port.read(port.in_waiting or 1)
+        start = received.find(MAGIC)
+        if start < 0:
+            # Show the log up to the last complete line
+            end = received.rfind(b"\n") + 1
+            sys.stdout.write(received[:end].decode("utf-8", "replace"))
+            received = received[end:]
+            continue
+        sys.stdout.write(received[:start].decode("utf-8", "replace"))
+        received = received[start:]
+        began = time.monotonic()
+        while grab_size(received) is None or \
+                len(received) < grab_size(received):
+            if time.monotonic() - began > GRAB_TIMEOUT:
+                raise TimeoutError("screen grab incomplete after %d s, "
+                                   "%d bytes received"
+                                   % (GRAB_TIMEOUT, len(received)))
+            received += port.read(port.in_waiting or 1)
+        elapsed = time.monotonic() - began
+        total = grab_size(received)
+        width, height, planes = HEADER.unpack_from(received)[3:6]
+        # 10 bits per byte with the start and stop bits
+        raw_time = width // 8 * height * planes * 10 / args.baud
+        print("\nReceived %d bytes in %.2f s, a raw frame takes %.2f s"
+              % (total, elapsed, raw_time))
+        return received[:total]
+    raise TimeoutError("no screen grab within %d s" % args.timeout)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="serial port of the board")
+    source.add_argument("--input", help="decode a grab saved with --raw")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=int, default=1800,
+                        help="seconds to wait for the board to wake")
+    parser.add_argument("--output", default="screen.png",
+                        help="image to write, .png or .pbm")
+    parser.add_argument("--raw", help="also save the received bytes here")
+    args = parser.parse_args()
+
+    if args.input:
+        with open(args.input, "rb") as f:
+            data = f.read()
+    else:
+        data = receive(args)
+    if args.raw:
+        with open(args.raw, "wb") as f:
+            f.write(data)
+    rotation, width, height, planes = parse_grab(data)
+    raw = sum(len(plane) for plane in planes)
+    width, height, rows = rotate(planes, width, height, rotation)
+    if os.path.splitext(args.output)[1].lower() == ".pbm":
+        write_pbm(args.output, width, height, rows)
+    else:
+        write_png(args.output, width, height, rows, len(planes) > 1)
+    print("Wrote %s, %dx%d, %d planes, %d of %d bytes coded"
+          % (args.output, width, height, len(planes), len(data) - HEADER.size,
+             raw))
+
+
+if __name__ == "__main__":
+    sys.exit(main())